@@ -1,6 +1,13 @@
 set(ARCH_DEFINES -D_LINUX -DTARGET_POSIX -DTARGET_LINUX)
 set(SYSTEM_DEFINES -D__STDC_CONSTANT_MACROS -D_FILE_DEFINED
                    -D_LARGEFILE64_SOURCE -D_FILE_OFFSET_BITS=64)
+
+include(CheckIncludeFile)
+check_include_file(sys/inotify.h HAVE_INOTIFY)
+if(HAVE_INOTIFY)
+  list(APPEND SYSTEM_DEFINES -DHAVE_INOTIFY=1)
+endif()
+
 if(WITH_ARCH)
   set(ARCH ${WITH_ARCH})
 else()
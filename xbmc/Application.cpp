@@ -32,6 +32,7 @@
 #include "guilib/TextureManager.h"
 #include "cores/IPlayer.h"
 #include "cores/dvdplayer/DVDFileInfo.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxProbeCache.h"
 #include "cores/AudioEngine/AEFactory.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "PlayListPlayer.h"
@@ -304,6 +305,7 @@
 #include "utils/JobManager.h"
 #include "utils/SaveFileStateJob.h"
 #include "utils/AlarmClock.h"
+#include "utils/ChangeJournal.h"
 #include "utils/RssReader.h"
 #include "utils/StringUtils.h"
 #include "utils/Weather.h"
@@ -3431,6 +3433,9 @@ bool CApplication::Cleanup()
 
     CAddonMgr::Get().DeInit();
 
+    // close the idle pooled database connections while the database libraries are still loaded
+    CDatabaseManager::Get().Deinitialize();
+
 #if defined(HAS_LIRC) || defined(HAS_IRSERVERSUITE)
     CLog::Log(LOGNOTICE, "closing down remote control service");
     g_RemoteControl.Disconnect();
@@ -3537,6 +3542,8 @@ void CApplication::Stop(int exitCode)
     CLog::Log(LOGNOTICE, "stop player");
     m_pPlayer->ClosePlayer();
 
+    CDVDDemuxProbeCache::Get().Save();
+
     CAnnouncementManager::Get().Deinitialize();
 
     StopPVRManager();
@@ -3560,6 +3567,9 @@ void CApplication::Stop(int exitCode)
     }
 #endif
 
+    CLog::Log(LOGNOTICE, "stop change journal");
+    CChangeJournal::Get().Stop();
+
     CLog::Log(LOGNOTICE, "clean cached files!");
 
     CVFSEntryManager::Get().DisconnectAll();
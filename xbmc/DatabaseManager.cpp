@@ -28,6 +28,12 @@
 #include "pvr/PVRDatabase.h"
 #include "epg/EpgDatabase.h"
 #include "settings/AdvancedSettings.h"
+#include "dbwrappers/dataset.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+
+// idle connections are closed after this long, so we don't hold on to database servers forever
+#define DB_CONNECTION_IDLE_TIMEOUT 300000 // ms
 
 using namespace std;
 using namespace EPG;
@@ -41,10 +47,13 @@ CDatabaseManager &CDatabaseManager::Get()
 
 CDatabaseManager::CDatabaseManager()
 {
+  memset(&m_poolStats, 0, sizeof(m_poolStats));
+  m_poolConnectTime = 0;
 }
 
 CDatabaseManager::~CDatabaseManager()
 {
+  ClearConnections();
 }
 
 void CDatabaseManager::Initialize(bool addonsOnly)
@@ -68,6 +77,8 @@ void CDatabaseManager::Initialize(bool addonsOnly)
 
 void CDatabaseManager::Deinitialize()
 {
+  ClearConnections();
+
   CSingleLock lock(m_section);
   m_dbStatus.clear();
 }
@@ -96,3 +107,124 @@ void CDatabaseManager::UpdateStatus(const std::string &name, DB_STATUS status)
   CSingleLock lock(m_section);
   m_dbStatus[name] = status;
 }
+
+bool CDatabaseManager::AcquireConnection(const std::string &key, dbiplus::Database *&db, dbiplus::Dataset *&ds, dbiplus::Dataset *&ds2)
+{
+  CSingleLock lock(m_poolSection);
+  m_poolStats.checkouts++;
+
+  // don't hand out a connection the server may have dropped in the meantime
+  ExpireConnections(XbmcThreads::SystemClockMillis());
+
+  ConnectionMap::iterator it = m_connections.find(key);
+  if (it == m_connections.end() || it->second.empty())
+    return false;
+
+  // prefer the connection this thread used last, otherwise the most recently used one
+  std::deque<Connection> &idle = it->second;
+  std::deque<Connection>::iterator connection = idle.end() - 1;
+  for (std::deque<Connection>::iterator i = idle.begin(); i != idle.end(); ++i)
+  {
+    if (CThread::IsCurrentThread(i->thread))
+    {
+      connection = i;
+      m_poolStats.sameThread++;
+      break;
+    }
+  }
+
+  db  = connection->db;
+  ds  = connection->ds;
+  ds2 = connection->ds2;
+  idle.erase(connection);
+  m_poolStats.hits++;
+  return true;
+}
+
+bool CDatabaseManager::ReleaseConnection(const std::string &key, dbiplus::Database *db, dbiplus::Dataset *ds, dbiplus::Dataset *ds2)
+{
+  if (g_advancedSettings.m_databaseConnections == 0 || !db || !ds || !ds2)
+    return false;
+
+  Connection connection;
+  connection.db = db;
+  connection.ds = ds;
+  connection.ds2 = ds2;
+  connection.thread = CThread::GetCurrentThreadId();
+  connection.released = XbmcThreads::SystemClockMillis();
+
+  CSingleLock lock(m_poolSection);
+  ExpireConnections(connection.released);
+
+  std::deque<Connection> &idle = m_connections[key];
+  if (idle.size() >= g_advancedSettings.m_databaseConnections)
+    return false;
+
+  idle.push_back(connection);
+  return true;
+}
+
+void CDatabaseManager::ConnectionMade(unsigned int time)
+{
+  CSingleLock lock(m_poolSection);
+  m_poolStats.connects++;
+  m_poolConnectTime += time;
+}
+
+CDatabaseManager::PoolStatistics CDatabaseManager::GetPoolStatistics() const
+{
+  CSingleLock lock(m_poolSection);
+  PoolStatistics stats = m_poolStats;
+  stats.connectTime = m_poolStats.connects ? m_poolConnectTime / m_poolStats.connects : 0;
+  stats.idle = 0;
+  for (ConnectionMap::const_iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+    stats.idle += it->second.size();
+  return stats;
+}
+
+void CDatabaseManager::ExpireConnections(unsigned int now)
+{
+  for (ConnectionMap::iterator it = m_connections.begin(); it != m_connections.end(); )
+  {
+    // the oldest connections are at the front
+    std::deque<Connection> &idle = it->second;
+    while (!idle.empty() && now - idle.front().released > DB_CONNECTION_IDLE_TIMEOUT)
+    {
+      Disconnect(idle.front());
+      idle.pop_front();
+    }
+
+    if (idle.empty())
+      m_connections.erase(it++);
+    else
+      ++it;
+  }
+}
+
+void CDatabaseManager::ClearConnections()
+{
+  ConnectionMap connections;
+  PoolStatistics stats = GetPoolStatistics();
+  {
+    CSingleLock lock(m_poolSection);
+    connections.swap(m_connections);
+  }
+
+  for (ConnectionMap::iterator it = connections.begin(); it != connections.end(); ++it)
+  {
+    for (std::deque<Connection>::iterator connection = it->second.begin(); connection != it->second.end(); ++connection)
+      Disconnect(*connection);
+  }
+
+  if (stats.checkouts > 0)
+    CLog::Log(LOGDEBUG, "%s - %u of %u database opens served from the pool (%u by the same thread), %u connections made in %u ms on average",
+              __FUNCTION__, stats.hits, stats.checkouts, stats.sameThread, stats.connects, stats.connectTime);
+}
+
+void CDatabaseManager::Disconnect(Connection &connection)
+{
+  connection.db->disconnect();
+  delete connection.db;
+  delete connection.ds;
+  delete connection.ds2;
+}
@@ -20,14 +20,21 @@
 
 #pragma once
 
+#include <deque>
 #include <map>
 #include <string>
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
+#include "threads/Thread.h"
 
 class CDatabase;
 class DatabaseSettings;
 
+namespace dbiplus {
+  class Database;
+  class Dataset;
+}
+
 /*!
  \ingroup database
  \brief Database manager class for handling database updating
@@ -35,6 +42,9 @@ class DatabaseSettings;
  Ensures that databases used in XBMC are up to date, and if a database can't be
  opened, ensures we don't continuously try it.
 
+ It also keeps the connections of closed databases for a while, so that the
+ many short lived CDatabase instances don't have to connect every time.
+
  */
 class CDatabaseManager
 {
@@ -51,6 +61,7 @@ public:
   void Initialize(bool addonsOnly = false);
 
   /*! \brief Deinitialize the database manager
+   Closes the idle connections of the pool.
    */
   void Deinitialize();
 
@@ -65,6 +76,39 @@ public:
    */ 
   bool CanOpen(const std::string &name);
 
+  struct PoolStatistics
+  {
+    unsigned int checkouts;     ///< database opens that went through the pool
+    unsigned int hits;          ///< opens served with an idle connection
+    unsigned int sameThread;    ///< hits that got a connection last used by the same thread
+    unsigned int connects;      ///< new connections made for opens
+    unsigned int connectTime;   ///< average time to make a new connection in ms
+    unsigned int idle;          ///< connections currently idle in the pool
+  };
+
+  /*! \brief Take an idle connection from the pool.
+   Connections last used by the calling thread are preferred.
+   \param key the identification of the database and server the connection is for.
+   \param db [out] the connection, owned by the caller on success.
+   \param ds [out] the first dataset of the connection.
+   \param ds2 [out] the second dataset of the connection.
+   \return true if an idle connection was available, false otherwise.
+   */
+  bool AcquireConnection(const std::string &key, dbiplus::Database *&db, dbiplus::Dataset *&ds, dbiplus::Dataset *&ds2);
+
+  /*! \brief Return a connection to the pool.
+   \param key the identification of the database and server the connection is for.
+   \return true if the pool took the connection, false if the caller has to close it.
+   */
+  bool ReleaseConnection(const std::string &key, dbiplus::Database *db, dbiplus::Dataset *ds, dbiplus::Dataset *ds2);
+
+  /*! \brief Account for a connection made because the pool had none idle.
+   \param time the time it took to connect in ms.
+   */
+  void ConnectionMade(unsigned int time);
+
+  PoolStatistics GetPoolStatistics() const;
+
 private:
   // private construction, and no assignements; use the provided singleton methods
   CDatabaseManager();
@@ -76,6 +120,25 @@ private:
   void UpdateStatus(const std::string &name, DB_STATUS status);
   void UpdateDatabase(CDatabase &db, DatabaseSettings *settings = NULL);
 
+  struct Connection
+  {
+    dbiplus::Database *db;
+    dbiplus::Dataset  *ds;
+    dbiplus::Dataset  *ds2;
+    ThreadIdentifier   thread;
+    unsigned int       released;
+  };
+  typedef std::map<std::string, std::deque<Connection> > ConnectionMap;
+
+  void ExpireConnections(unsigned int now);
+  void ClearConnections();
+  static void Disconnect(Connection &connection);
+
   CCriticalSection            m_section;     ///< Critical section protecting m_dbStatus.
   std::map<std::string, DB_STATUS> m_dbStatus;    ///< Our database status map.
+
+  CCriticalSection            m_poolSection; ///< Critical section protecting the pool.
+  ConnectionMap               m_connections; ///< Idle connections by database.
+  PoolStatistics              m_poolStats;
+  unsigned int                m_poolConnectTime;
 };
@@ -54,6 +54,7 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "utils/RegExp.h"
+#include "utils/RegExpCache.h"
 #include "utils/log.h"
 #include "utils/Variant.h"
 #include "music/karaoke/karaokelyricsfactory.h"
@@ -2343,21 +2344,8 @@ void CFileItemList::Stack(bool stackFiles /* = true */)
 
 void CFileItemList::StackFolders()
 {
-  // Precompile our REs
-  VECCREGEXP folderRegExps;
-  CRegExp folderRegExp(true, CRegExp::autoUtf8);
-  const CStdStringArray& strFolderRegExps = g_advancedSettings.m_folderStackRegExps;
-
-  CStdStringArray::const_iterator strExpression = strFolderRegExps.begin();
-  while (strExpression != strFolderRegExps.end())
-  {
-    if (!folderRegExp.RegComp(*strExpression))
-      CLog::Log(LOGERROR, "%s: Invalid folder stack RegExp:'%s'", __FUNCTION__, strExpression->c_str());
-    else
-      folderRegExps.push_back(folderRegExp);
-
-    strExpression++;
-  }
+  // Get our precompiled REs
+  CCachedRegExpSet folderRegExps(g_advancedSettings.m_folderStackRegExps, true);
 
   // stack folders
   for (int i = 0; i < Size(); i++)
@@ -2382,11 +2370,12 @@ void CFileItemList::StackFolders()
 
         bool bMatch(false);
 
-        VECCREGEXP::iterator expr = folderRegExps.begin();
-        while (!bMatch && expr != folderRegExps.end())
+        for (size_t expr = 0; !bMatch && expr < folderRegExps->Size(); expr++)
         {
-          //CLog::Log(LOGDEBUG,"%s: Running expression %s on %s", __FUNCTION__, expr->GetPattern().c_str(), item->GetLabel().c_str());
-          bMatch = (expr->RegFind(item->GetLabel().c_str()) != -1);
+          if (!folderRegExps->Get(expr))
+            continue;
+          //CLog::Log(LOGDEBUG,"%s: Running expression %s on %s", __FUNCTION__, folderRegExps->Get(expr)->GetPattern().c_str(), item->GetLabel().c_str());
+          bMatch = (folderRegExps->Get(expr)->RegFind(item->GetLabel().c_str()) != -1);
           if (bMatch)
           {
             CFileItemList items;
@@ -2410,7 +2399,6 @@ void CFileItemList::StackFolders()
             if (nFiles == 1)
               *item = *items[index];
           }
-          expr++;
         }
 
         // check for dvd folders
@@ -2433,156 +2421,185 @@ void CFileItemList::StackFolders()
   }
 }
 
+namespace
+{
+/// \brief The captures of a stack expression for a file name
+struct StackKey
+{
+  CStdString title;
+  CStdString volume;
+  CStdString ignore;
+  CStdString extension;
+  int ignoreStart;
+};
+
+/// \brief Matches the stack expressions against the file names of a list, once per file and expression
+class CStackKeys
+{
+public:
+  CStackKeys(const vector<CRegExp*> &expressions, const vector<CStdString> &files)
+    : m_expressions(expressions), m_files(files)
+  {
+    m_state.resize(files.size() * expressions.size(), 0);
+    m_keys.resize(files.size() * expressions.size());
+  }
+
+  /*! \brief Get the captures of an expression for a file.
+   \return the captures, NULL if the expression doesn't match. Captures for an offset
+   are only valid until the next call with an offset.
+   */
+  const StackKey *Get(size_t expression, int file, size_t offset)
+  {
+    // matches from an offset are rare, don't bother keeping them
+    if (offset)
+      return Match(*m_expressions[expression], m_files[file], offset, m_offsetKey) ? &m_offsetKey : NULL;
+
+    size_t index = file * m_expressions.size() + expression;
+    if (m_state[index] == 0)
+      m_state[index] = Match(*m_expressions[expression], m_files[file], 0, m_keys[index]) ? 1 : -1;
+    return m_state[index] > 0 ? &m_keys[index] : NULL;
+  }
+
+private:
+  static bool Match(CRegExp &expression, const CStdString &file, size_t offset, StackKey &key)
+  {
+    if (expression.RegFind(file, offset) == -1)
+      return false;
+
+    key.title     = expression.GetMatch(1);
+    key.volume    = expression.GetMatch(2);
+    key.ignore    = expression.GetMatch(3);
+    key.extension = expression.GetMatch(4);
+    if (offset)
+      key.title = file.substr(0, expression.GetSubStart(2));
+    key.ignoreStart = expression.GetSubStart(3);
+    return true;
+  }
+
+  const vector<CRegExp*> &m_expressions;
+  const vector<CStdString> &m_files;
+  vector<char> m_state; // 0 = not matched yet, 1 = match, -1 = no match
+  vector<StackKey> m_keys;
+  StackKey m_offsetKey;
+};
+}
+
 void CFileItemList::StackFiles()
 {
-  // Precompile our REs
-  VECCREGEXP stackRegExps;
-  CRegExp tmpRegExp(true, CRegExp::autoUtf8);
-  const CStdStringArray& strStackRegExps = g_advancedSettings.m_videoStackRegExps;
-  CStdStringArray::const_iterator strRegExp = strStackRegExps.begin();
-  while (strRegExp != strStackRegExps.end())
+  // Get our precompiled REs
+  CCachedRegExpSet stackRegExpSet(g_advancedSettings.m_videoStackRegExps, true);
+  vector<CRegExp*> stackRegExps;
+  for (size_t k = 0; k < stackRegExpSet->Size(); k++)
   {
-    if (tmpRegExp.RegComp(*strRegExp))
-    {
-      if (tmpRegExp.GetCaptureTotal() == 4)
-        stackRegExps.push_back(tmpRegExp);
-      else
-        CLog::Log(LOGERROR, "Invalid video stack RE (%s). Must have 4 captures.", strRegExp->c_str());
-    }
-    strRegExp++;
+    CRegExp *stackRegExp = stackRegExpSet->Get(k);
+    if (!stackRegExp)
+      continue;
+    if (stackRegExp->GetCaptureTotal() == 4)
+      stackRegExps.push_back(stackRegExp);
+    else
+      CLog::Log(LOGERROR, "Invalid video stack RE (%s). Must have 4 captures.", stackRegExp->GetPattern().c_str());
   }
 
-  // now stack the files, some of which may be from the previous stack iteration
-  int i = 0;
-  while (i < Size())
+  // every file is compared with its neighbours for several expressions,
+  // so get the file names and their captures only once
+  vector<CStdString> files(Size());
+  vector<bool> stackable(Size(), false);
+  for (int i = 0; i < Size(); i++)
   {
-    CFileItemPtr item1 = Get(i);
+    CFileItemPtr item = Get(i);
 
     // skip folders, nfo files, playlists
-    if (item1->m_bIsFolder
-      || item1->IsParentFolder()
-      || item1->IsNFO()
-      || item1->IsPlayList()
+    if (item->m_bIsFolder
+      || item->IsParentFolder()
+      || item->IsNFO()
+      || item->IsPlayList()
       )
-    {
-      // increment index
-      i++;
       continue;
-    }
-
-    int64_t               size        = 0;
-    size_t                offset      = 0;
-    CStdString            stackName;
-    CStdString            file1;
-    CStdString            filePath;
-    vector<int>           stack;
-    VECCREGEXP::iterator  expr        = stackRegExps.begin();
 
-    URIUtils::Split(item1->GetPath(), filePath, file1);
+    CStdString filePath;
+    URIUtils::Split(item->GetPath(), filePath, files[i]);
     if (URIUtils::ProtocolHasEncodedFilename(CURL(filePath).GetProtocol() ) )
-      file1 = CURL::Decode(file1);
+      files[i] = CURL::Decode(files[i]);
+    stackable[i] = true;
+  }
+  CStackKeys keys(stackRegExps, files);
+
+  // now stack the files, the stacked ones are removed once we're done
+  vector<bool> stacked(Size(), false);
+  for (int i = 0; i < Size(); i++)
+  {
+    if (!stackable[i] || stacked[i])
+      continue;
+
+    CFileItemPtr item1 = Get(i);
+    int64_t     size    = 0;
+    size_t      offset  = 0;
+    CStdString  stackName;
+    vector<int> stack;
+    size_t      expr    = 0;
 
-    int j;
-    while (expr != stackRegExps.end())
+    while (expr < stackRegExps.size())
     {
-      if (expr->RegFind(file1, offset) != -1)
+      const StackKey *key1 = keys.Get(expr, i, offset);
+      if (!key1) // No match 1
       {
-        CStdString  Title1      = expr->GetMatch(1),
-                    Volume1     = expr->GetMatch(2),
-                    Ignore1     = expr->GetMatch(3),
-                    Extension1  = expr->GetMatch(4);
-        if (offset)
-          Title1 = file1.substr(0, expr->GetSubStart(2));
-        j = i + 1;
-        while (j < Size())
-        {
-          CFileItemPtr item2 = Get(j);
-
-          // skip folders, nfo files, playlists
-          if (item2->m_bIsFolder
-            || item2->IsParentFolder()
-            || item2->IsNFO()
-            || item2->IsPlayList()
-            )
-          {
-            // increment index
-            j++;
-            continue;
-          }
+        offset = 0;
+        expr++;
+        continue;
+      }
+      const StackKey file1 = *key1;
+
+      int j;
+      for (j = i + 1; j < Size(); j++)
+      {
+        if (!stackable[j] || stacked[j])
+          continue;
 
-          CStdString file2, filePath2;
-          URIUtils::Split(item2->GetPath(), filePath2, file2);
-          if (URIUtils::ProtocolHasEncodedFilename(CURL(filePath2).GetProtocol() ) )
-            file2 = CURL::Decode(file2);
+        const StackKey *file2 = keys.Get(expr, j, offset);
+        if (!file2 || !file1.title.Equals(file2->title)) // No match 2 or title mismatch, next expression
+        {
+          offset = 0;
+          expr++;
+          break;
+        }
 
-          if (expr->RegFind(file2, offset) != -1)
+        if (!file1.volume.Equals(file2->volume))
+        {
+          if (file1.ignore.Equals(file2->ignore) && file1.extension.Equals(file2->extension))
           {
-            CStdString  Title2      = expr->GetMatch(1),
-                        Volume2     = expr->GetMatch(2),
-                        Ignore2     = expr->GetMatch(3),
-                        Extension2  = expr->GetMatch(4);
-            if (offset)
-              Title2 = file2.substr(0, expr->GetSubStart(2));
-            if (Title1.Equals(Title2))
-            {
-              if (!Volume1.Equals(Volume2))
-              {
-                if (Ignore1.Equals(Ignore2) && Extension1.Equals(Extension2))
-                {
-                  if (stack.size() == 0)
-                  {
-                    stackName = Title1 + Ignore1 + Extension1;
-                    stack.push_back(i);
-                    size += item1->m_dwSize;
-                  }
-                  stack.push_back(j);
-                  size += item2->m_dwSize;
-                }
-                else // Sequel
-                {
-                  offset = 0;
-                  expr++;
-                  break;
-                }
-              }
-              else if (!Ignore1.Equals(Ignore2)) // False positive, try again with offset
-              {
-                offset = expr->GetSubStart(3);
-                break;
-              }
-              else // Extension mismatch
-              {
-                offset = 0;
-                expr++;
-                break;
-              }
-            }
-            else // Title mismatch
+            if (stack.size() == 0)
             {
-              offset = 0;
-              expr++;
-              break;
+              stackName = file1.title + file1.ignore + file1.extension;
+              stack.push_back(i);
+              size += item1->m_dwSize;
             }
+            stack.push_back(j);
+            size += Get(j)->m_dwSize;
+            continue;
           }
-          else // No match 2, next expression
-          {
-            offset = 0;
-            expr++;
-            break;
-          }
-          j++;
+          // Sequel
+          offset = 0;
+          expr++;
+          break;
         }
-        if (j == Size())
-          expr = stackRegExps.end();
-      }
-      else // No match 1
-      {
+
+        if (!file1.ignore.Equals(file2->ignore)) // False positive, try again with offset
+        {
+          offset = file2->ignoreStart;
+          break;
+        }
+
+        // Extension mismatch
         offset = 0;
         expr++;
+        break;
       }
+      if (j == Size())
+        expr = stackRegExps.size();
+
       if (stack.size() > 1)
       {
-        // have a stack, remove the items and add the stacked item
+        // have a stack, mark the items for removal and turn the first one into the stacked item
         // dont actually stack a multipart rar set, just remove all items but the first
         CStdString stackPath;
         if (Get(stack[0])->IsRAR())
@@ -2593,9 +2610,8 @@ void CFileItemList::StackFiles()
           stackPath = dir.ConstructStackPath(*this, stack);
         }
         item1->SetPath(stackPath);
-        // clean up list
         for (unsigned k = 1; k < stack.size(); k++)
-          Remove(i+1);
+          stacked[stack[k]] = true;
         // item->m_bIsFolder = true;  // don't treat stacked files as folders
         // the label may be in a different char set from the filename (eg over smb
         // the label is converted from utf8, but the filename is not)
@@ -2607,8 +2623,19 @@ void CFileItemList::StackFiles()
         break;
       }
     }
-    i++;
   }
+
+  // clean up list, removing one item at a time would shift the rest of the list each time
+  CSingleLock lock(m_lock);
+  size_t kept = 0;
+  for (size_t i = 0; i < m_items.size(); i++)
+  {
+    if (!stacked[i])
+      m_items[kept++] = m_items[i];
+    else if (m_fastLookup)
+      m_map.erase(m_items[i]->GetPath());
+  }
+  m_items.resize(kept);
 }
 
 bool CFileItemList::Load(int windowID)
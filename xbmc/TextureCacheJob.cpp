@@ -168,6 +168,14 @@ CStdString CTextureCacheJob::DecodeImageURL(const CStdString &url, unsigned int
       {
         width = height = g_advancedSettings.GetThumbSize();
       }
+      else if (option == "width" && !value.empty())
+      {
+        width = (unsigned int)strtoul(value.c_str(), NULL, 10);
+      }
+      else if (option == "height" && !value.empty())
+      {
+        height = (unsigned int)strtoul(value.c_str(), NULL, 10);
+      }
       else if (option == "flipped")
       {
         additional_info = "flipped";
@@ -56,6 +56,7 @@
 #endif
 #include "profiles/ProfilesManager.h"
 #include "utils/RegExp.h"
+#include "utils/RegExpCache.h"
 #include "guilib/GraphicContext.h"
 #include "guilib/TextureManager.h"
 #include "utils/fstrcmp.h"
@@ -238,35 +239,25 @@ void CUtil::CleanString(const CStdString& strFileName, CStdString& strTitle, CSt
   if (strFileName.Equals(".."))
    return;
 
-  const CStdStringArray &regexps = g_advancedSettings.m_videoCleanStringRegExps;
+  CCachedRegExpSet reTags(g_advancedSettings.m_videoCleanStringRegExps, true);
+  CCachedRegExpSet reYear(std::vector<std::string>(1, g_advancedSettings.m_videoCleanDateTimeRegExp), false);
 
-  CRegExp reTags(true, CRegExp::autoUtf8);
-  CRegExp reYear(false, CRegExp::autoUtf8);
-
-  if (!reYear.RegComp(g_advancedSettings.m_videoCleanDateTimeRegExp))
-  {
-    CLog::Log(LOGERROR, "%s: Invalid datetime clean RegExp:'%s'", __FUNCTION__, g_advancedSettings.m_videoCleanDateTimeRegExp.c_str());
-  }
-  else
+  if (reYear->Get(0) && reYear->Get(0)->RegFind(strTitleAndYear.c_str()) >= 0)
   {
-    if (reYear.RegFind(strTitleAndYear.c_str()) >= 0)
-    {
-      strTitleAndYear = reYear.GetMatch(1);
-      strYear = reYear.GetMatch(2);
-    }
+    strTitleAndYear = reYear->Get(0)->GetMatch(1);
+    strYear = reYear->Get(0)->GetMatch(2);
   }
 
   URIUtils::RemoveExtension(strTitleAndYear);
 
-  for (unsigned int i = 0; i < regexps.size(); i++)
+  // each expression cuts the title further, so they have to run in order
+  for (unsigned int i = 0; i < reTags->Size(); i++)
   {
-    if (!reTags.RegComp(regexps[i].c_str()))
-    { // invalid regexp - complain in logs
-      CLog::Log(LOGERROR, "%s: Invalid string clean RegExp:'%s'", __FUNCTION__, regexps[i].c_str());
+    CRegExp *expression = reTags->Get(i);
+    if (!expression)
       continue;
-    }
     int j=0;
-    if ((j=reTags.RegFind(strTitleAndYear.c_str())) > 0)
+    if ((j=expression->RegFind(strTitleAndYear.c_str())) > 0)
       strTitleAndYear = strTitleAndYear.substr(0, j);
   }
 
@@ -516,20 +507,13 @@ bool CUtil::ExcludeFileOrFolder(const CStdString& strFileOrFolder, const CStdStr
   if (strFileOrFolder.empty())
     return false;
 
-  CRegExp regExExcludes(true, CRegExp::autoUtf8);  // case insensitive regex
+  CCachedRegExpSet regExExcludes(regexps, true);  // case insensitive regex
 
-  for (unsigned int i = 0; i < regexps.size(); i++)
+  int match = regExExcludes->FindAny(strFileOrFolder);
+  if (match >= 0)
   {
-    if (!regExExcludes.RegComp(regexps[i].c_str()))
-    { // invalid regexp - complain in logs
-      CLog::Log(LOGERROR, "%s: Invalid exclude RegExp:'%s'", __FUNCTION__, regexps[i].c_str());
-      continue;
-    }
-    if (regExExcludes.RegFind(strFileOrFolder) > -1)
-    {
-      CLog::Log(LOGDEBUG, "%s: File '%s' excluded. (Matches exclude rule RegExp:'%s')", __FUNCTION__, strFileOrFolder.c_str(), regexps[i].c_str());
-      return true;
-    }
+    CLog::Log(LOGDEBUG, "%s: File '%s' excluded. (Matches exclude rule RegExp:'%s')", __FUNCTION__, strFileOrFolder.c_str(), regexps[match].c_str());
+    return true;
   }
   return false;
 }
@@ -21,6 +21,7 @@
 #include "AddonDatabase.h"
 #include "addons/AddonManager.h"
 #include "utils/log.h"
+#include "utils/md5.h"
 #include "utils/Variant.h"
 #include "utils/StringUtils.h"
 #include "XBDateTime.h"
@@ -51,7 +52,7 @@ void CAddonDatabase::CreateTables()
               "name text, summary text, description text, stars integer,"
               "path text, addonID text, icon text, version text, "
               "changelog text, fanart text, author text, disclaimer text,"
-              "minversion text)\n");
+              "minversion text, hash text)\n");
 
   CLog::Log(LOGINFO, "create addonextra table");
   m_pDS->exec("CREATE TABLE addonextra (id integer, key text, value text)\n");
@@ -99,6 +100,10 @@ void CAddonDatabase::UpdateTables(int version)
   {
     m_pDS->exec("CREATE TABLE package (id integer primary key, addonID text, filename text, hash text)\n");
   }
+  if (version < 17)
+  {
+    m_pDS->exec("ALTER TABLE addon ADD hash text\n");
+  }
 }
 
 int CAddonDatabase::AddAddon(const AddonPtr& addon,
@@ -111,9 +116,9 @@ int CAddonDatabase::AddAddon(const AddonPtr& addon,
 
     CStdString sql = PrepareSQL("insert into addon (id, type, name, summary,"
                                "description, stars, path, icon, changelog, "
-                               "fanart, addonID, version, author, disclaimer, minversion)"
+                               "fanart, addonID, version, author, disclaimer, minversion, hash)"
                                " values(NULL, '%s', '%s', '%s', '%s', %i,"
-                               "'%s', '%s', '%s', '%s', '%s','%s','%s','%s','%s')",
+                               "'%s', '%s', '%s', '%s', '%s','%s','%s','%s','%s','%s')",
                                TranslateType(addon->Type(),false).c_str(),
                                addon->Name().c_str(), addon->Summary().c_str(),
                                addon->Description().c_str(),addon->Stars(),
@@ -121,7 +126,8 @@ int CAddonDatabase::AddAddon(const AddonPtr& addon,
                                addon->ChangeLog().c_str(),addon->FanArt().c_str(),
                                addon->ID().c_str(), addon->Version().asString().c_str(),
                                addon->Author().c_str(),addon->Disclaimer().c_str(),
-                               addon->MinVersion().asString().c_str());
+                               addon->MinVersion().asString().c_str(),
+                               GetAddonFingerprint(addon).c_str());
     m_pDS->exec(sql.c_str());
     int idAddon = (int)m_pDS->lastinsertid();
 
@@ -351,6 +357,50 @@ void CAddonDatabase::DeleteRepository(const CStdString& id)
   }
 }
 
+void CAddonDatabase::DeleteAddon(int idAddon)
+{
+  CStdString sql = PrepareSQL("delete from addon where id=%i",idAddon);
+  m_pDS->exec(sql.c_str());
+  sql = PrepareSQL("delete from addonextra where id=%i",idAddon);
+  m_pDS->exec(sql.c_str());
+  sql = PrepareSQL("delete from dependencies where id=%i",idAddon);
+  m_pDS->exec(sql.c_str());
+  sql = PrepareSQL("delete from addonlinkrepo where idAddon=%i",idAddon);
+  m_pDS->exec(sql.c_str());
+}
+
+std::string CAddonDatabase::GetAddonFingerprint(const AddonPtr& addon)
+{
+  XBMC::XBMC_MD5 md5;
+  std::string fields = StringUtils::Format("%s\n%s\n%s\n%s\n%i\n%s\n%s\n%s\n%s\n%s\n%s\n%s\n%s\n%s\n",
+                                           TranslateType(addon->Type(),false).c_str(),
+                                           addon->Name().c_str(), addon->Summary().c_str(),
+                                           addon->Description().c_str(),addon->Stars(),
+                                           addon->Path().c_str(), addon->Props().icon.c_str(),
+                                           addon->ChangeLog().c_str(),addon->FanArt().c_str(),
+                                           addon->ID().c_str(), addon->Version().asString().c_str(),
+                                           addon->Author().c_str(),addon->Disclaimer().c_str(),
+                                           addon->MinVersion().asString().c_str());
+  md5.append(fields.c_str(), fields.size());
+
+  const InfoMap &info = addon->ExtraInfo();
+  for (InfoMap::const_iterator i = info.begin(); i != info.end(); ++i)
+  {
+    std::string extra = StringUtils::Format("%s=%s\n", i->first.c_str(), i->second.c_str());
+    md5.append(extra.c_str(), extra.size());
+  }
+  const ADDONDEPS &deps = addon->GetDeps();
+  for (ADDONDEPS::const_iterator i = deps.begin(); i != deps.end(); ++i)
+  {
+    std::string dep = StringUtils::Format("%s>=%s%s\n", i->first.c_str(), i->second.first.asString().c_str(), i->second.second ? "?" : "");
+    md5.append(dep.c_str(), dep.size());
+  }
+
+  CStdString digest;
+  md5.getDigest(digest);
+  return digest;
+}
+
 void CAddonDatabase::DeleteRepository(int idRepo)
 {
   try
@@ -383,21 +433,63 @@ int CAddonDatabase::AddRepository(const CStdString& id, const VECADDONS& addons,
     if (NULL == m_pDB.get()) return -1;
     if (NULL == m_pDS.get()) return -1;
 
-    CStdString sql;
+    std::string sql;
     int idRepo = GetRepoChecksum(id,sql);
-    if (idRepo > -1)
-      DeleteRepository(idRepo);
 
     BeginTransaction();
 
     CDateTime time = CDateTime::GetCurrentDateTime();
-    sql = PrepareSQL("insert into repo (id,addonID,checksum,lastcheck) values (NULL,'%s','%s','%s')",id.c_str(),checksum.c_str(),time.GetAsDBDateTime().c_str());
-    m_pDS->exec(sql.c_str());
-    idRepo = (int)m_pDS->lastinsertid();
+    if (idRepo < 0)
+    {
+      sql = PrepareSQL("insert into repo (id,addonID,checksum,lastcheck) values (NULL,'%s','%s','%s')",id.c_str(),checksum.c_str(),time.GetAsDBDateTime().c_str());
+      m_pDS->exec(sql.c_str());
+      idRepo = (int)m_pDS->lastinsertid();
+    }
+    else
+    {
+      sql = PrepareSQL("update repo set checksum='%s', lastcheck='%s' where id=%i",checksum.c_str(),time.GetAsDBDateTime().c_str(),idRepo);
+      m_pDS->exec(sql.c_str());
+    }
+
+    // grab the stored catalogue so we only have to touch the add-ons that changed
+    std::map<std::string, std::pair<int, std::string> > stored;
+    std::vector<int> stale;
+    sql = PrepareSQL("select addon.id, addon.addonID, addon.hash from addon join addonlinkrepo on addon.id=addonlinkrepo.idAddon where addonlinkrepo.idRepo=%i",idRepo);
+    m_pDS->query(sql.c_str());
+    while (!m_pDS->eof())
+    {
+      if (!stored.insert(make_pair(m_pDS->fv(1).get_asString(), make_pair(m_pDS->fv(0).get_asInt(), m_pDS->fv(2).get_asString()))).second)
+        stale.push_back(m_pDS->fv(0).get_asInt());
+      m_pDS->next();
+    }
+    m_pDS->close();
+
+    unsigned int changed = 0;
     for (unsigned int i=0;i<addons.size();++i)
+    {
+      std::map<std::string, std::pair<int, std::string> >::iterator it = stored.find(addons[i]->ID());
+      if (it != stored.end())
+      {
+        bool unchanged = it->second.second == GetAddonFingerprint(addons[i]);
+        if (!unchanged)
+          stale.push_back(it->second.first);
+        stored.erase(it);
+        if (unchanged)
+          continue;
+      }
       AddAddon(addons[i],idRepo);
+      changed++;
+    }
+
+    // whatever is left has been removed from the repository
+    unsigned int removed = stored.size();
+    for (std::map<std::string, std::pair<int, std::string> >::const_iterator it = stored.begin(); it != stored.end(); ++it)
+      stale.push_back(it->second.first);
+    for (std::vector<int>::const_iterator it = stale.begin(); it != stale.end(); ++it)
+      DeleteAddon(*it);
 
     CommitTransaction();
+    CLog::Log(LOGDEBUG, "%s - repository %s: %u add-ons added or changed, %u removed", __FUNCTION__, id.c_str(), changed, removed);
     return idRepo;
   }
   catch (...)
@@ -44,6 +44,15 @@ public:
    \return true if a repo was found, false otherwise.
    */
   bool GetRepoForAddon(const CStdString& addonID, CStdString& repo);
+
+  /*! \brief Store the add-on catalogue of a repository
+   The catalogue is compared against the stored one, so only add-ons that were added, changed or
+   removed since the last update are written.
+   \param id id of the repository
+   \param addons the add-ons the repository provides
+   \param checksum checksum of the repository listing
+   \return the database id of the repository, -1 on failure
+   */
   int AddRepository(const CStdString& id, const ADDON::VECADDONS& addons, const CStdString& checksum);
   void DeleteRepository(const CStdString& id);
   void DeleteRepository(int id);
@@ -139,10 +148,16 @@ protected:
   virtual void CreateAnalytics();
   virtual void UpdateTables(int version);
   virtual int GetMinSchemaVersion() const { return 15; }
-  virtual int GetSchemaVersion() const { return 16; }
+  virtual int GetSchemaVersion() const { return 17; }
   const char *GetBaseDBName() const { return "Addons"; }
 
   bool GetAddon(int id, ADDON::AddonPtr& addon);
+  void DeleteAddon(int idAddon);
+
+  /*! \brief Compute a hash over all fields of an add-on that are stored by AddAddon
+   Used to find the add-ons that changed when a repository is updated.
+   */
+  static std::string GetAddonFingerprint(const ADDON::AddonPtr& addon);
 
   /* keep in sync with the select in GetAddon */
   enum _AddonFields
@@ -162,6 +177,7 @@ protected:
     addon_author,
     addon_disclaimer,
     addon_minversion,
+    addon_hash,
     broken_reason,
     addonextra_key,
     addonextra_value,
@@ -30,6 +30,7 @@
 #include "LangInfo.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
+#include "utils/CharsetDetection.h"
 #include "utils/log.h"
 #include "utils/XBMCTinyXML.h"
 #ifdef HAS_VISUALISATION
@@ -216,6 +217,7 @@ bool CAddonMgr::CheckUserDirs(const cp_cfg_element_t *settings)
 CAddonMgr::CAddonMgr()
 {
   m_cpluff = NULL;
+  m_snapshotVersion = 0;
 }
 
 CAddonMgr::~CAddonMgr()
@@ -318,14 +320,114 @@ void CAddonMgr::DeInit()
   m_cpluff = NULL;
   m_database.Close();
   m_disabled.clear();
+  InvalidateSnapshot();
+}
+
+AddonSnapshotPtr CAddonMgr::GetSnapshot()
+{
+  {
+    CSingleLock lock(m_snapshotSection);
+    if (m_snapshot)
+      return m_snapshot;
+  }
+
+  CSingleLock lock(m_critSection);
+  unsigned int version;
+  {
+    CSingleLock snapshotLock(m_snapshotSection);
+    if (m_snapshot) // built by someone else while we waited
+      return m_snapshot;
+    version = m_snapshotVersion;
+  }
+
+  boost::shared_ptr<AddonSnapshot> snapshot(new AddonSnapshot);
+  snapshot->version = version;
+  if (m_cpluff && m_cp_context)
+  {
+    cp_status_t status;
+    int num;
+    for (int i = ADDON_UNKNOWN+1; i <= ADDON_SCRIPT_MODULE; ++i)
+    {
+      CStdString ext_point(TranslateType((TYPE)i));
+      cp_extension_t **exts = m_cpluff->get_extensions_info(m_cp_context, ext_point.c_str(), &status, &num);
+      if (!exts)
+        continue;
+
+      VECADDONS &addons = snapshot->byType[(TYPE)i];
+      for (int j = 0; j < num; j++)
+      {
+        AddonPtr addon(Factory(exts[j]));
+        if (addon)
+          addons.push_back(addon);
+      }
+      m_cpluff->release_info(m_cp_context, exts);
+    }
+
+    cp_plugin_info_t **plugins = m_cpluff->get_plugins_info(m_cp_context, &status, &num);
+    if (plugins)
+    {
+      for (int i = 0; i < num; i++)
+      {
+        AddonPtr addon(GetAddonFromDescriptor(plugins[i]));
+        if (addon)
+          snapshot->byId.insert(make_pair(std::string(plugins[i]->identifier), addon));
+        if (IsAddonDisabled(plugins[i]->identifier))
+          snapshot->disabled.insert(plugins[i]->identifier);
+      }
+      m_cpluff->release_info(m_cp_context, plugins);
+    }
+  }
+
+  CSingleLock snapshotLock(m_snapshotSection);
+  // addons changed while we were building, leave it to the next caller to rebuild
+  if (version == m_snapshotVersion)
+    m_snapshot = snapshot;
+  return snapshot;
+}
+
+void CAddonMgr::InvalidateSnapshot()
+{
+  CSingleLock lock(m_snapshotSection);
+  m_snapshot.reset();
+  m_snapshotVersion++;
+}
+
+AddonPtr CAddonMgr::CloneAddon(const AddonPtr &addon)
+{
+  if (addon->Type() == ADDON_PVRDLL)
+  {
+    // get a pointer to a running pvrclient if it's already started, or we won't be able to change settings
+    AddonPtr pvrAddon;
+    if (g_PVRManager.IsStarted() && g_PVRClients->GetClient(addon->ID(), pvrAddon))
+      return pvrAddon;
+
+    // pvr clients can't be copied, so create a new one from the descriptor
+    CSingleLock lock(m_critSection);
+    cp_status_t status;
+    cp_plugin_info_t *cpaddon = m_cpluff->get_plugin_info(m_cp_context, addon->ID().c_str(), &status);
+    if (!cpaddon)
+      return AddonPtr();
+    pvrAddon = GetAddonFromDescriptor(cpaddon, TranslateType(ADDON_PVRDLL));
+    m_cpluff->release_info(m_cp_context, cpaddon);
+    return pvrAddon;
+  }
+
+  return addon->Clone();
 }
 
 bool CAddonMgr::HasAddons(const TYPE &type, bool enabled /*= true*/)
 {
-  // TODO: This isn't particularly efficient as we create an addon type for each addon using the Factory, just so
-  //       we can check addon dependencies in the addon constructor.
-  VECADDONS addons;
-  return GetAddons(type, addons, enabled);
+  AddonSnapshotPtr snapshot = GetSnapshot();
+  std::map<TYPE, VECADDONS>::const_iterator it = snapshot->byType.find(type);
+  if (it == snapshot->byType.end())
+    return false;
+
+  for (VECADDONS::const_iterator addon = it->second.begin(); addon != it->second.end(); ++addon)
+  {
+    if ((snapshot->disabled.find((*addon)->ID()) != snapshot->disabled.end()) != enabled)
+      return true;
+  }
+  return false;
 }
 
 bool CAddonMgr::GetAllAddons(VECADDONS &addons, bool enabled /*= true*/, bool allowRepos /* = false */)
@@ -428,70 +530,53 @@ bool CAddonMgr::HasOutdatedAddons()
 
 bool CAddonMgr::GetAddons(const TYPE &type, VECADDONS &addons, bool enabled /* = true */)
 {
-  CSingleLock lock(m_critSection);
   addons.clear();
-  if (!m_cp_context)
+  AddonSnapshotPtr snapshot = GetSnapshot();
+  std::map<TYPE, VECADDONS>::const_iterator it = snapshot->byType.find(type);
+  if (it == snapshot->byType.end())
     return false;
-  cp_status_t status;
-  int num;
-  CStdString ext_point(TranslateType(type));
-  cp_extension_t **exts = m_cpluff->get_extensions_info(m_cp_context, ext_point.c_str(), &status, &num);
-  for(int i=0; i <num; i++)
+
+  for (VECADDONS::const_iterator addon = it->second.begin(); addon != it->second.end(); ++addon)
   {
-    const cp_extension_t *props = exts[i];
-    if (IsAddonDisabled(props->plugin->identifier) != enabled)
-    {
-      // get a pointer to a running pvrclient if it's already started, or we won't be able to change settings
-      if (TranslateType(props->ext_point_id) == ADDON_PVRDLL &&
-          enabled &&
-          g_PVRManager.IsStarted())
-      {
-        AddonPtr pvrAddon;
-        if (g_PVRClients->GetClient(props->plugin->identifier, pvrAddon))
-        {
-          addons.push_back(pvrAddon);
-          continue;
-        }
-      }
+    if ((snapshot->disabled.find((*addon)->ID()) != snapshot->disabled.end()) == enabled)
+      continue;
 
-      AddonPtr addon(Factory(props));
-      if (addon)
-        addons.push_back(addon);
-    }
+    AddonPtr clone(CloneAddon(*addon));
+    if (clone)
+      addons.push_back(clone);
   }
-  m_cpluff->release_info(m_cp_context, exts);
   return addons.size() > 0;
 }
 
 bool CAddonMgr::GetAddon(const CStdString &str, AddonPtr &addon, const TYPE &type/*=ADDON_UNKNOWN*/, bool enabledOnly /*= true*/)
 {
-  CSingleLock lock(m_critSection);
-
-  cp_status_t status;
-  cp_plugin_info_t *cpaddon = m_cpluff->get_plugin_info(m_cp_context, str.c_str(), &status);
-  if (status == CP_OK && cpaddon)
+  AddonSnapshotPtr snapshot = GetSnapshot();
+  AddonPtr prototype;
+  if (type == ADDON_UNKNOWN)
   {
-    addon = GetAddonFromDescriptor(cpaddon, type==ADDON_UNKNOWN?"":TranslateType(type));
-    m_cpluff->release_info(m_cp_context, cpaddon);
-
-    if (addon && addon.get())
+    std::map<std::string, AddonPtr>::const_iterator it = snapshot->byId.find(str);
+    if (it != snapshot->byId.end())
+      prototype = it->second;
+  }
+  else
+  {
+    std::map<TYPE, VECADDONS>::const_iterator it = snapshot->byType.find(type);
+    if (it != snapshot->byType.end())
     {
-      if (enabledOnly && IsAddonDisabled(addon->ID()))
-        return false;
-
-      if (addon->Type() == ADDON_PVRDLL && g_PVRManager.IsStarted())
-      {
-        AddonPtr pvrAddon;
-        if (g_PVRClients->GetClient(addon->ID(), pvrAddon))
-          addon = pvrAddon;
-      }
+      VECADDONS::const_iterator i = std::find_if(it->second.begin(), it->second.end(), AddonIdFinder(str));
+      if (i != it->second.end())
+        prototype = *i;
     }
-    return NULL != addon.get();
   }
-  if (cpaddon)
-    m_cpluff->release_info(m_cp_context, cpaddon);
 
-  return false;
+  if (!prototype)
+    return false;
+
+  if (enabledOnly && snapshot->disabled.find(prototype->ID()) != snapshot->disabled.end())
+    return false;
+
+  addon = CloneAddon(prototype);
+  return NULL != addon.get();
 }
 
 //TODO handle all 'default' cases here, not just scrapers & vizs
@@ -578,6 +663,7 @@ void CAddonMgr::FindAddons()
     if (m_cpluff && m_cp_context)
     {
       m_cpluff->scan_plugins(m_cp_context, CP_SP_UPGRADE);
+      InvalidateSnapshot();
       SetChanged();
     }
   }
@@ -589,6 +675,7 @@ void CAddonMgr::RemoveAddon(const CStdString& ID)
   if (m_cpluff && m_cp_context)
   {
     m_cpluff->uninstall_plugin(m_cp_context,ID.c_str());
+    InvalidateSnapshot();
     SetChanged();
     NotifyObservers(ObservableMessageAddons);
   }
@@ -600,6 +687,7 @@ bool CAddonMgr::DisableAddon(const std::string& ID, bool disable)
   if (m_database.DisableAddon(ID, disable))
   {
     m_disabled[ID] = disable;
+    InvalidateSnapshot();
     return true;
   }
 
@@ -860,6 +948,42 @@ bool CAddonMgr::AddonsFromRepoXML(const TiXmlElement *root, VECADDONS &addons)
   return true;
 }
 
+bool CAddonMgr::AddonsFromRepoXML(const std::string &declaration, const std::vector<std::string> &elements, VECADDONS &addons)
+{
+  // create a context for these addons
+  cp_status_t status;
+  cp_context_t *context = m_cpluff->create_context(&status);
+  if (!context)
+    return false;
+
+  // UTF-8 elements are handed over as they are, anything else is converted by TinyXML
+  std::string charset;
+  bool utf8 = CCharsetDetection::DetectXmlEncoding(declaration, charset) && charset == "UTF-8";
+  for (std::vector<std::string>::const_iterator it = elements.begin(); it != elements.end(); ++it)
+  {
+    std::string xml = declaration + *it;
+    if (!utf8)
+    {
+      CXBMCTinyXML doc;
+      if (!doc.Parse(xml) || !doc.RootElement())
+        continue;
+      xml.clear();
+      xml << TiXmlDeclaration("1.0", "UTF-8", "");
+      xml << *doc.RootElement();
+    }
+    cp_plugin_info_t *info = m_cpluff->load_plugin_descriptor_from_memory(context, xml.c_str(), xml.size(), &status);
+    if (info)
+    {
+      AddonPtr addon = GetAddonFromDescriptor(info);
+      if (addon.get())
+        addons.push_back(addon);
+      m_cpluff->release_info(context, info);
+    }
+  }
+  m_cpluff->destroy_context(context);
+  return true;
+}
+
 bool CAddonMgr::LoadAddonDescriptionFromMemory(const TiXmlElement *root, AddonPtr &addon)
 {
   // create a context for these addons
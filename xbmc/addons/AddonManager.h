@@ -24,6 +24,7 @@
 #include "utils/Observer.h"
 #include <vector>
 #include <map>
+#include <set>
 #include <deque>
 #include "AddonDatabase.h"
 
@@ -54,6 +55,19 @@ namespace ADDON
   * specific addon types. Could be mostly used for Dll addon types to handle
   * cleanup before restart/removal
   */
+  /*! \brief Immutable view of the installed addons.
+   Holds one instance of every addon, which is never handed out directly. Callers
+   get clones, so they are free to change settings or state of the addons they get.
+   */
+  struct AddonSnapshot
+  {
+    unsigned int version;
+    std::map<TYPE, VECADDONS> byType;
+    std::map<std::string, AddonPtr> byId;
+    std::set<std::string> disabled;
+  };
+  typedef boost::shared_ptr<const AddonSnapshot> AddonSnapshotPtr;
+
   class IAddonMgrCallback
   {
     public:
@@ -175,6 +189,14 @@ namespace ADDON
      */
     bool AddonsFromRepoXML(const TiXmlElement *root, VECADDONS &addons);
 
+    /*! \brief Load the descriptors of addons taken from a repository XML file
+     \param declaration the XML declaration of the repository XML file, empty if it has none.
+     \param elements the text of the addon elements, in the encoding of the file.
+     \param addons [out] the parsed addons are appended to this list.
+     \return true if the descriptors could be loaded, false otherwise.
+     */
+    bool AddonsFromRepoXML(const std::string &declaration, const std::vector<std::string> &elements, VECADDONS &addons);
+
     /*! \brief Start all services addons.
         \return True is all addons are started, false otherwise
     */
@@ -187,6 +209,15 @@ namespace ADDON
     void LoadAddons(const CStdString &path, 
                     std::map<CStdString, AddonPtr>& unresolved);
 
+    /*! \brief Get the current addon snapshot, building it if addons have changed since the last one.
+     Building is done with m_critSection held, readers only need it to build.
+     */
+    AddonSnapshotPtr GetSnapshot();
+    /*! \brief Drop the current snapshot, called whenever addons are installed, updated, removed, enabled or disabled.
+     */
+    void InvalidateSnapshot();
+    AddonPtr CloneAddon(const AddonPtr &addon);
+
     /* libcpluff */
     const cp_cfg_element_t *GetExtElement(cp_cfg_element_t *base, const char *path);
     cp_context_t *m_cp_context;
@@ -220,6 +251,9 @@ namespace ADDON
     std::map<std::string, bool> m_disabled;
     static std::map<TYPE, IAddonMgrCallback*> m_managers;
     CCriticalSection m_critSection;
+    AddonSnapshotPtr m_snapshot;
+    unsigned int     m_snapshotVersion;
+    CCriticalSection m_snapshotSection;
     CAddonDatabase m_database;
   };
 
@@ -28,18 +28,25 @@
 #include "filesystem/PluginDirectory.h"
 #include "pvr/PVRManager.h"
 #include "settings/Settings.h"
+#include "threads/SingleLock.h"
+#include "utils/JobManager.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
-#include "utils/XBMCTinyXML.h"
 #include "FileItem.h"
 #include "TextureDatabase.h"
 #include "URL.h"
 
+#include <sstream>
+
 using namespace std;
 using namespace XFILE;
 using namespace ADDON;
 
+#define REPO_READ_SIZE    65536
+#define REPO_PARSE_BATCH  50    // addon elements handed to the add-on manager at once
+#define REPO_FETCH_JOBS   4     // repositories fetched at the same time
+
 AddonPtr CRepository::Clone() const
 {
   return AddonPtr(new CRepository(*this));
@@ -166,10 +173,158 @@ string CRepository::GetAddonHash(const AddonPtr& addon) const
        x = y; \
   }
 
+/*! \brief Find the end of the tag starting at pos, skipping over quoted attribute values.
+ \return the position of the closing '>', string::npos if the tag isn't complete yet.
+ */
+static size_t FindTagEnd(const string &data, size_t pos)
+{
+  char quote = 0;
+  for (; pos < data.size(); ++pos)
+  {
+    char c = data[pos];
+    if (quote)
+    {
+      if (c == quote)
+        quote = 0;
+    }
+    else if (c == '"' || c == '\'')
+      quote = c;
+    else if (c == '>')
+      return pos;
+  }
+  return string::npos;
+}
+
+static bool IsTagName(const string &data, size_t pos, const char *name)
+{
+  size_t length = strlen(name);
+  if (data.compare(pos, length, name) != 0 || pos + length >= data.size())
+    return false;
+  char c = data[pos + length];
+  return c == '>' || c == '/' || isspace((unsigned char)c);
+}
+
+/*! \brief Split an addons.xml into its addon elements while it's being downloaded.
+ Only the tags are looked at, the elements themselves are parsed by cpluff.
+ */
+static bool ReadRepoXML(const string &path, VECADDONS &addons)
+{
+  CFile file;
+  if (!file.Open(path))
+    return false;
+
+  vector<string> elements;
+  string declaration;           // the document's own, it tells the encoding of the elements
+  string data;
+  size_t pos = 0;               // where to continue scanning
+  size_t start = string::npos;  // start of the addon element being read
+  int depth = 0;
+  bool eof = false;
+  char buffer[REPO_READ_SIZE];
+
+  while (true)
+  {
+    size_t tag = data.find('<', pos);
+    size_t end = string::npos;
+    // make sure we have enough to tell comments, CDATA and addon tags apart
+    if (tag != string::npos && (eof || data.size() >= tag + 9))
+    {
+      if (data.compare(tag, 4, "<!--") == 0)
+      {
+        end = data.find("-->", tag + 4);
+        if (end != string::npos)
+          pos = end + 3;
+      }
+      else if (data.compare(tag, 9, "<![CDATA[") == 0)
+      {
+        end = data.find("]]>", tag + 9);
+        if (end != string::npos)
+          pos = end + 3;
+      }
+      else if (IsTagName(data, tag, "</addon"))
+      {
+        end = data.find('>', tag);
+        if (end != string::npos)
+        {
+          pos = end + 1;
+          if (depth > 0 && --depth == 0)
+          {
+            elements.push_back(data.substr(start, pos - start));
+            start = string::npos;
+          }
+        }
+      }
+      else if (IsTagName(data, tag, "<addon"))
+      {
+        end = FindTagEnd(data, tag);
+        if (end != string::npos)
+        {
+          pos = end + 1;
+          if (depth == 0)
+            start = tag;
+          if (data[end - 1] != '/')
+            depth++;
+          else if (depth == 0)
+          {
+            elements.push_back(data.substr(start, pos - start));
+            start = string::npos;
+          }
+        }
+      }
+      else
+      {
+        end = FindTagEnd(data, tag);
+        if (end != string::npos)
+        {
+          pos = end + 1;
+          if (declaration.empty() && IsTagName(data, tag, "<?xml"))
+            declaration = data.substr(tag, pos - tag);
+        }
+      }
+    }
+
+    if (elements.size() >= REPO_PARSE_BATCH)
+    {
+      CAddonMgr::Get().AddonsFromRepoXML(declaration, elements, addons);
+      elements.clear();
+    }
+
+    if (end != string::npos)
+      continue;
+
+    // need more data, drop what we're done with first
+    if (eof)
+      break;
+    size_t resume = tag != string::npos ? tag : data.size();
+    size_t keep = start != string::npos ? start : resume;
+    data.erase(0, keep);
+    pos = resume - keep;
+    if (start != string::npos)
+      start = 0;
+
+    unsigned int read = file.Read(buffer, sizeof(buffer));
+    if (read == 0 || read > sizeof(buffer))
+      eof = true;
+    else
+      data.append(buffer, read);
+  }
+  file.Close();
+
+  if (depth > 0)
+  {
+    CLog::Log(LOGERROR, "%s - %s is truncated", __FUNCTION__, path.c_str());
+    addons.clear();
+    return false;
+  }
+
+  if (!elements.empty())
+    CAddonMgr::Get().AddonsFromRepoXML(declaration, elements, addons);
+  return true;
+}
+
 VECADDONS CRepository::Parse(const DirInfo& dir)
 {
   VECADDONS result;
-  CXBMCTinyXML doc;
 
   string file = dir.info;
   if (dir.compressed)
@@ -182,9 +337,8 @@ VECADDONS CRepository::Parse(const DirInfo& dir)
     file = url.Get();
   }
 
-  if (doc.LoadFile(file) && doc.RootElement())
+  if (ReadRepoXML(file, result))
   {
-    CAddonMgr::Get().AddonsFromRepoXML(doc.RootElement(), result);
     for (IVECADDONS i = result.begin(); i != result.end(); ++i)
     {
       AddonPtr addon = *i;
@@ -230,17 +384,121 @@ void MergeAddons(map<string, AddonPtr> &addons, const VECADDONS &new_addons)
   }
 }
 
+namespace ADDON
+{
+  /*! \brief Repositories still to be fetched by a CRepositoryUpdateJob.
+   The update job fetches repositories itself and additionally queues a few helper jobs
+   that take repositories from the same queue. Helper jobs that only get to run after the
+   queue has been closed find nothing to do, so the update job never waits on the job manager.
+   */
+  class CRepositoryFetchQueue
+  {
+  public:
+    CRepositoryFetchQueue(CRepositoryUpdateJob *job, const VECADDONS &repos)
+      : m_job(job), m_repos(repos), m_results(repos.size()), m_next(0), m_running(0),
+        m_closed(false), m_cancelled(false)
+    {
+    }
+
+    /*! \brief Fetch repositories until there are none left */
+    void Process()
+    {
+      {
+        CSingleLock lock(m_section);
+        if (m_closed)
+          return;
+        m_running++;
+      }
+
+      while (true)
+      {
+        size_t index;
+        {
+          CSingleLock lock(m_section);
+          if (m_cancelled || m_next >= m_repos.size())
+            break;
+          index = m_next++;
+        }
+
+        if (m_job->ShouldCancel(0, 0))
+        {
+          CSingleLock lock(m_section);
+          m_cancelled = true;
+          break;
+        }
+
+        RepositoryPtr repo = boost::dynamic_pointer_cast<CRepository>(m_repos[index]);
+        VECADDONS addons = m_job->GrabAddons(repo);
+
+        CSingleLock lock(m_section);
+        m_results[index] = addons;
+      }
+
+      CSingleLock lock(m_section);
+      if (--m_running == 0)
+        m_idle.Set();
+    }
+
+    /*! \brief Stop handing out repositories and wait for the fetches in progress.
+     \param addons [out] the add-ons of all repositories, the newest version of each.
+     \return false if the update job was cancelled, true otherwise.
+     */
+    bool Close(map<string, AddonPtr> &addons)
+    {
+      CSingleLock lock(m_section);
+      m_closed = true;
+      while (m_running > 0)
+      {
+        m_idle.Reset();
+        CSingleExit exit(m_section);
+        m_idle.Wait();
+      }
+
+      // merge in the original order so equal versions are resolved as before
+      for (vector<VECADDONS>::const_iterator i = m_results.begin(); i != m_results.end(); ++i)
+        MergeAddons(addons, *i);
+      return !m_cancelled;
+    }
+
+  private:
+    CRepositoryUpdateJob *m_job;  ///< only valid while fetches are running
+    VECADDONS m_repos;
+    vector<VECADDONS> m_results;
+    size_t m_next;
+    unsigned int m_running;
+    bool m_closed;
+    bool m_cancelled;
+    CCriticalSection m_section;
+    CEvent m_idle;
+  };
+
+  typedef boost::shared_ptr<CRepositoryFetchQueue> RepositoryFetchQueuePtr;
+
+  class CRepositoryFetchJob : public CJob
+  {
+  public:
+    CRepositoryFetchJob(const RepositoryFetchQueuePtr &queue) : m_queue(queue) {}
+
+    virtual const char *GetType() const { return "repofetch"; };
+    virtual bool DoWork()
+    {
+      m_queue->Process();
+      return true;
+    }
+  private:
+    RepositoryFetchQueuePtr m_queue;
+  };
+}
+
 bool CRepositoryUpdateJob::DoWork()
 {
   map<string, AddonPtr> addons;
-  for (VECADDONS::const_iterator i = m_repos.begin(); i != m_repos.end(); ++i)
-  {
-    if (ShouldCancel(0, 0))
-      return false;
-    RepositoryPtr repo = boost::dynamic_pointer_cast<CRepository>(*i);
-    VECADDONS newAddons = GrabAddons(repo);
-    MergeAddons(addons, newAddons);
-  }
+  RepositoryFetchQueuePtr queue(new CRepositoryFetchQueue(this, m_repos));
+  for (size_t i = 1; i < m_repos.size() && i < REPO_FETCH_JOBS; ++i)
+    CJobManager::GetInstance().AddJob(new CRepositoryFetchJob(queue), NULL);
+  queue->Process();
+  if (!queue->Close(addons))
+    return false;
   if (addons.empty())
     return false;
 
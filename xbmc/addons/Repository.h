@@ -57,12 +57,23 @@ namespace ADDON
     typedef std::vector<DirInfo> DirList;
     DirList m_dirs;
 
+    /*! \brief Parse the addons.xml of a repository directory.
+     The listing is read incrementally and each addon element is handed to the add-on manager
+     as soon as it's complete, so the whole document is never held in memory at once.
+     \param dir the repository directory to parse.
+     \return the addons listed, empty if the listing couldn't be read completely.
+     */
     static VECADDONS Parse(const DirInfo& dir);
     static std::string FetchChecksum(const std::string& url);
   private:
     CRepository(const CRepository &rhs);
   };
 
+  class CRepositoryFetchQueue;
+
+  /*! \brief Fetch the listings of a set of repositories and check them for add-on updates.
+   The repositories are fetched concurrently on the job manager, see CRepositoryFetchQueue.
+   */
   class CRepositoryUpdateJob : public CJob
   {
   public:
@@ -72,6 +83,7 @@ namespace ADDON
     virtual const char *GetType() const { return "repoupdate"; };
     virtual bool DoWork();
   private:
+    friend class CRepositoryFetchQueue;
     VECADDONS GrabAddons(RepositoryPtr& repo);
 
     VECADDONS m_repos;
@@ -23,6 +23,7 @@
 #include "filesystem/CurlFile.h"
 #include "AddonManager.h"
 #include "utils/ScraperParser.h"
+#include "utils/ScraperCache.h"
 #include "utils/ScraperUrl.h"
 #include "utils/CharsetConverter.h"
 #include "utils/log.h"
@@ -231,6 +232,9 @@ void CScraper::ClearCache()
   }
   else
     CDirectory::Create(strCachePath);
+
+  // responses are kept for a week after they expire, to be revalidated with the site
+  CScraperCache::Get().Prune(g_advancedSettings.m_scraperCacheTime + 7 * 24 * 3600);
 }
 
 // returns a vector of strings: the first is the XML output by the function; the rest
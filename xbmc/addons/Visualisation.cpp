@@ -67,6 +67,12 @@ void CAudioBuffer::Set(const float* psBuffer, int iSize)
   for (int i = iSize; i < m_iLen; ++i) m_pBuffer[i] = 0;
 }
 
+AddonPtr CVisualisation::Clone() const
+{
+  // Copy constructor is generated by compiler and calls parent copy constructor
+  return AddonPtr(new CVisualisation(*this));
+}
+
 bool CVisualisation::Create(int x, int y, int w, int h, void *device)
 {
   m_pInfo = new VIS_PROPS;
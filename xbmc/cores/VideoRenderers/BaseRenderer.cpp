@@ -34,6 +34,10 @@
 #include "settings/AdvancedSettings.h"
 #include "cores/VideoRenderers/RenderFlags.h"
 
+// read when calculating the display rectangles
+static const CSettingHandle g_settingErrorInAspect("videoplayer.errorinaspect");
+static const CSettingHandle g_settingStretch43("videoplayer.stretch43");
+
 
 CBaseRenderer::CBaseRenderer()
 {
@@ -423,7 +427,7 @@ void CBaseRenderer::CalcNormalDisplayRect(float offsetX, float offsetY, float sc
 
   // allow a certain error to maximize screen size
   float fCorrection = screenWidth / screenHeight / outputFrameRatio - 1.0f;
-  float fAllowed    = CSettings::Get().GetInt("videoplayer.errorinaspect") * 0.01f;
+  float fAllowed    = CSettings::Get().GetInt(g_settingErrorInAspect) * 0.01f;
   if(fCorrection >   fAllowed) fCorrection =   fAllowed;
   if(fCorrection < - fAllowed) fCorrection = - fAllowed;
 
@@ -646,7 +650,7 @@ void CBaseRenderer::SetViewMode(int viewMode)
   CDisplaySettings::Get().SetNonLinearStretched(false);
 
   if ( CMediaSettings::Get().GetCurrentVideoSettings().m_ViewMode == ViewModeZoom ||
-       (is43 && CSettings::Get().GetInt("videoplayer.stretch43") == ViewModeZoom))
+       (is43 && CSettings::Get().GetInt(g_settingStretch43) == ViewModeZoom))
   { // zoom image so no black bars
     CDisplaySettings::Get().SetPixelRatio(1.0);
     // calculate the desired output ratio
@@ -678,7 +682,7 @@ void CBaseRenderer::SetViewMode(int viewMode)
     }
   }
   else if ( CMediaSettings::Get().GetCurrentVideoSettings().m_ViewMode == ViewModeWideZoom ||
-           (is43 && CSettings::Get().GetInt("videoplayer.stretch43") == ViewModeWideZoom))
+           (is43 && CSettings::Get().GetInt(g_settingStretch43) == ViewModeWideZoom))
   { // super zoom
     float stretchAmount = (screenWidth / screenHeight) * info.fPixelRatio / sourceFrameRatio;
     CDisplaySettings::Get().SetPixelRatio(pow(stretchAmount, float(2.0/3.0)));
@@ -686,7 +690,7 @@ void CBaseRenderer::SetViewMode(int viewMode)
     CDisplaySettings::Get().SetNonLinearStretched(true);
   }
   else if ( CMediaSettings::Get().GetCurrentVideoSettings().m_ViewMode == ViewModeStretch16x9 ||
-           (is43 && CSettings::Get().GetInt("videoplayer.stretch43") == ViewModeStretch16x9))
+           (is43 && CSettings::Get().GetInt(g_settingStretch43) == ViewModeStretch16x9))
   { // stretch image to 16:9 ratio
     CDisplaySettings::Get().SetZoomAmount(1.0);
     if (res == RES_PAL_4x3 || res == RES_PAL60_4x3 || res == RES_NTSC_4x3 || res == RES_HDTV_480p_4x3)
@@ -45,6 +45,7 @@
 #include "utils/StringUtils.h"
 #include "RenderCapture.h"
 #include "RenderFormats.h"
+#include "YUV2RGB.h"
 #include "cores/IPlayer.h"
 #include "cores/dvdplayer/DVDCodecs/DVDCodecUtils.h"
 #include "cores/FFmpeg.h"
@@ -91,6 +92,10 @@ extern "C" {
 
 using namespace Shaders;
 
+// read while rendering
+static const CSettingHandle g_settingLimitedRange("videoscreen.limitedrange");
+static const CSettingHandle g_settingHqScalers("videoplayer.hqscalers");
+
 static const GLubyte stipple_weave[] = {
   0x00, 0x00, 0x00, 0x00,
   0xFF, 0xFF, 0xFF, 0xFF,
@@ -3156,14 +3161,24 @@ void CLinuxRendererGL::ToRGBFrame(YV12Image* im, unsigned flipIndexPlane, unsign
     m_rgbBuffer = (BYTE*)glMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB) + PBO_OFFSET;
   }
 
-  m_context = sws_getCachedContext(m_context,
-                                                 im->width, im->height, (AVPixelFormat)srcFormat,
-                                                 im->width, im->height, (AVPixelFormat)PIX_FMT_BGRA,
-                                                 SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
+  //8 bit 4:2:0 is converted by our own kernel, it doesn't need to scale
+  if (m_format == RENDER_FMT_YUV420P)
+    CYUV2RGB::YUV420ToBGRA(m_rgbBuffer, m_sourceWidth * 4, src[0], src[1], src[2],
+                           srcStride[0], srcStride[1], im->width, im->height);
+  else if (m_format == RENDER_FMT_NV12)
+    CYUV2RGB::NV12ToBGRA(m_rgbBuffer, m_sourceWidth * 4, src[0], src[1],
+                         srcStride[0], srcStride[1], im->width, im->height);
+  else
+  {
+    m_context = sws_getCachedContext(m_context,
+                                                   im->width, im->height, (AVPixelFormat)srcFormat,
+                                                   im->width, im->height, (AVPixelFormat)PIX_FMT_BGRA,
+                                                   SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
 
-  uint8_t *dst[]       = { m_rgbBuffer, 0, 0, 0 };
-  int      dstStride[] = { (int)m_sourceWidth * 4, 0, 0, 0 };
-  sws_scale(m_context, src, srcStride, 0, im->height, dst, dstStride);
+    uint8_t *dst[]       = { m_rgbBuffer, 0, 0, 0 };
+    int      dstStride[] = { (int)m_sourceWidth * 4, 0, 0, 0 };
+    sws_scale(m_context, src, srcStride, 0, im->height, dst, dstStride);
+  }
 
   if (m_rgbPbo)
   {
@@ -3236,18 +3251,35 @@ void CLinuxRendererGL::ToRGBFields(YV12Image* im, unsigned flipIndexPlaneTop, un
     m_rgbBuffer = (BYTE*)glMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB) + PBO_OFFSET;
   }
 
-  m_context = sws_getCachedContext(m_context,
-                                                 im->width, im->height >> 1, (AVPixelFormat)srcFormat,
-                                                 im->width, im->height >> 1, (AVPixelFormat)PIX_FMT_BGRA,
-                                                 SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
   uint8_t *dstTop[]    = { m_rgbBuffer, 0, 0, 0 };
   uint8_t *dstBot[]    = { m_rgbBuffer + m_sourceWidth * m_sourceHeight * 2, 0, 0, 0 };
   int      dstStride[] = { (int)m_sourceWidth * 4, 0, 0, 0 };
 
   //convert each YUV field to an RGB field, the top field is placed at the top of the rgb buffer
   //the bottom field is placed at the bottom of the rgb buffer
-  sws_scale(m_context, srcTop, srcStrideTop, 0, im->height >> 1, dstTop, dstStride);
-  sws_scale(m_context, srcBot, srcStrideBot, 0, im->height >> 1, dstBot, dstStride);
+  if (m_format == RENDER_FMT_YUV420P)
+  {
+    CYUV2RGB::YUV420ToBGRA(dstTop[0], dstStride[0], srcTop[0], srcTop[1], srcTop[2],
+                           srcStrideTop[0], srcStrideTop[1], im->width, im->height >> 1);
+    CYUV2RGB::YUV420ToBGRA(dstBot[0], dstStride[0], srcBot[0], srcBot[1], srcBot[2],
+                           srcStrideBot[0], srcStrideBot[1], im->width, im->height >> 1);
+  }
+  else if (m_format == RENDER_FMT_NV12)
+  {
+    CYUV2RGB::NV12ToBGRA(dstTop[0], dstStride[0], srcTop[0], srcTop[1],
+                         srcStrideTop[0], srcStrideTop[1], im->width, im->height >> 1);
+    CYUV2RGB::NV12ToBGRA(dstBot[0], dstStride[0], srcBot[0], srcBot[1],
+                         srcStrideBot[0], srcStrideBot[1], im->width, im->height >> 1);
+  }
+  else
+  {
+    m_context = sws_getCachedContext(m_context,
+                                                   im->width, im->height >> 1, (AVPixelFormat)srcFormat,
+                                                   im->width, im->height >> 1, (AVPixelFormat)PIX_FMT_BGRA,
+                                                   SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
+    sws_scale(m_context, srcTop, srcStrideTop, 0, im->height >> 1, dstTop, dstStride);
+    sws_scale(m_context, srcBot, srcStrideBot, 0, im->height >> 1, dstBot, dstStride);
+  }
 
   if (m_rgbPbo)
   {
@@ -3433,7 +3465,7 @@ bool CLinuxRendererGL::Supports(ERENDERFEATURE feature)
 {
   if(feature == RENDERFEATURE_BRIGHTNESS)
   {
-    if ((m_renderMethod & RENDER_VDPAU) && !CSettings::Get().GetBool("videoscreen.limitedrange"))
+    if ((m_renderMethod & RENDER_VDPAU) && !CSettings::Get().GetBool(g_settingLimitedRange))
       return true;
 
     if (m_renderMethod & RENDER_VAAPI)
@@ -3446,7 +3478,7 @@ bool CLinuxRendererGL::Supports(ERENDERFEATURE feature)
   
   if(feature == RENDERFEATURE_CONTRAST)
   {
-    if ((m_renderMethod & RENDER_VDPAU) && !CSettings::Get().GetBool("videoscreen.limitedrange"))
+    if ((m_renderMethod & RENDER_VDPAU) && !CSettings::Get().GetBool(g_settingLimitedRange))
       return true;
 
     if (m_renderMethod & RENDER_VAAPI)
@@ -3591,7 +3623,7 @@ bool CLinuxRendererGL::Supports(ESCALINGMETHOD method)
     // if scaling is below level, avoid hq scaling
     float scaleX = fabs(((float)m_sourceWidth - m_destRect.Width())/m_sourceWidth)*100;
     float scaleY = fabs(((float)m_sourceHeight - m_destRect.Height())/m_sourceHeight)*100;
-    int minScale = CSettings::Get().GetInt("videoplayer.hqscalers");
+    int minScale = CSettings::Get().GetInt(g_settingHqScalers);
     if (scaleX < minScale && scaleY < minScale)
       return false;
 
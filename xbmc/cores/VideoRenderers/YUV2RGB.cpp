@@ -0,0 +1,151 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "YUV2RGB.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* BT.601 coefficients in 4.12 fixed point. The products are taken as
+ * (x * c) >> 9, which is what _mm_mulhi_epi16 gives for x << 7, so the
+ * results carry 3 fractional bits. */
+#define YUV_CY   4769 // 1.164
+#define YUV_CRV  6537 // 1.596
+#define YUV_CGU  1605 // 0.392
+#define YUV_CGV  3330 // 0.813
+#define YUV_CBU  8263 // 2.017
+
+static inline uint8_t Clip(int value)
+{
+  return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+static inline void ConvertPixel(uint8_t *dst, int y, int u, int v)
+{
+  int luma = (((y - 16) * YUV_CY) >> 9) + 4;
+  u -= 128;
+  v -= 128;
+
+  dst[0] = Clip((luma + ((u * YUV_CBU) >> 9)) >> 3);
+  dst[1] = Clip((luma - ((u * YUV_CGU) >> 9) - ((v * YUV_CGV) >> 9)) >> 3);
+  dst[2] = Clip((luma + ((v * YUV_CRV) >> 9)) >> 3);
+  dst[3] = 0xff;
+}
+
+#ifdef __SSE2__
+/* converts 16 pixels, u and v hold the 8 chroma samples as (x - 128) << 7 */
+static inline void Convert16(uint8_t *dst, __m128i y, __m128i u, __m128i v)
+{
+  const __m128i zero  = _mm_setzero_si128();
+  const __m128i alpha = _mm_set1_epi8((char)0xff);
+  const __m128i round = _mm_set1_epi16(4);
+  const __m128i black = _mm_set1_epi16(16);
+  const __m128i cy    = _mm_set1_epi16(YUV_CY);
+
+  __m128i bu = _mm_mulhi_epi16(u, _mm_set1_epi16(YUV_CBU));
+  __m128i gu = _mm_add_epi16(_mm_mulhi_epi16(u, _mm_set1_epi16(YUV_CGU)),
+                             _mm_mulhi_epi16(v, _mm_set1_epi16(YUV_CGV)));
+  __m128i rv = _mm_mulhi_epi16(v, _mm_set1_epi16(YUV_CRV));
+
+  __m128i ylo = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(y, zero), black), 7);
+  __m128i yhi = _mm_slli_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(y, zero), black), 7);
+  ylo = _mm_add_epi16(_mm_mulhi_epi16(ylo, cy), round);
+  yhi = _mm_add_epi16(_mm_mulhi_epi16(yhi, cy), round);
+
+  // every chroma sample covers two pixels
+  __m128i b = _mm_packus_epi16(_mm_srai_epi16(_mm_add_epi16(ylo, _mm_unpacklo_epi16(bu, bu)), 3),
+                               _mm_srai_epi16(_mm_add_epi16(yhi, _mm_unpackhi_epi16(bu, bu)), 3));
+  __m128i g = _mm_packus_epi16(_mm_srai_epi16(_mm_sub_epi16(ylo, _mm_unpacklo_epi16(gu, gu)), 3),
+                               _mm_srai_epi16(_mm_sub_epi16(yhi, _mm_unpackhi_epi16(gu, gu)), 3));
+  __m128i r = _mm_packus_epi16(_mm_srai_epi16(_mm_add_epi16(ylo, _mm_unpacklo_epi16(rv, rv)), 3),
+                               _mm_srai_epi16(_mm_add_epi16(yhi, _mm_unpackhi_epi16(rv, rv)), 3));
+
+  __m128i bglo = _mm_unpacklo_epi8(b, g);
+  __m128i bghi = _mm_unpackhi_epi8(b, g);
+  __m128i ralo = _mm_unpacklo_epi8(r, alpha);
+  __m128i rahi = _mm_unpackhi_epi8(r, alpha);
+
+  _mm_storeu_si128((__m128i*)(dst +  0), _mm_unpacklo_epi16(bglo, ralo));
+  _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi16(bglo, ralo));
+  _mm_storeu_si128((__m128i*)(dst + 32), _mm_unpacklo_epi16(bghi, rahi));
+  _mm_storeu_si128((__m128i*)(dst + 48), _mm_unpackhi_epi16(bghi, rahi));
+}
+#endif
+
+void CYUV2RGB::YUV420ToBGRA(uint8_t *dst, int dstPitch,
+                            const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                            int yPitch, int uvPitch, int width, int height)
+{
+  for (int row = 0; row < height; row++)
+  {
+    const uint8_t *ys = y + row * yPitch;
+    const uint8_t *us = u + (row >> 1) * uvPitch;
+    const uint8_t *vs = v + (row >> 1) * uvPitch;
+    uint8_t       *d  = dst + row * dstPitch;
+    int x = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    for (; x + 16 <= width; x += 16)
+    {
+      __m128i yy = _mm_loadu_si128((const __m128i*)(ys + x));
+      __m128i uu = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(us + x / 2)), zero);
+      __m128i vv = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(vs + x / 2)), zero);
+      Convert16(d + x * 4, yy, _mm_slli_epi16(_mm_sub_epi16(uu, bias), 7),
+                               _mm_slli_epi16(_mm_sub_epi16(vv, bias), 7));
+    }
+#endif
+
+    for (; x < width; x++)
+      ConvertPixel(d + x * 4, ys[x], us[x >> 1], vs[x >> 1]);
+  }
+}
+
+void CYUV2RGB::NV12ToBGRA(uint8_t *dst, int dstPitch,
+                          const uint8_t *y, const uint8_t *uv,
+                          int yPitch, int uvPitch, int width, int height)
+{
+  for (int row = 0; row < height; row++)
+  {
+    const uint8_t *ys  = y + row * yPitch;
+    const uint8_t *uvs = uv + (row >> 1) * uvPitch;
+    uint8_t       *d   = dst + row * dstPitch;
+    int x = 0;
+
+#ifdef __SSE2__
+    const __m128i mask = _mm_set1_epi16(0xff);
+    const __m128i bias = _mm_set1_epi16(128);
+    for (; x + 16 <= width; x += 16)
+    {
+      __m128i yy = _mm_loadu_si128((const __m128i*)(ys + x));
+      __m128i cc = _mm_loadu_si128((const __m128i*)(uvs + x));
+      __m128i uu = _mm_and_si128(cc, mask);
+      __m128i vv = _mm_srli_epi16(cc, 8);
+      Convert16(d + x * 4, yy, _mm_slli_epi16(_mm_sub_epi16(uu, bias), 7),
+                               _mm_slli_epi16(_mm_sub_epi16(vv, bias), 7));
+    }
+#endif
+
+    for (; x < width; x++)
+      ConvertPixel(d + x * 4, ys[x], uvs[(x >> 1) * 2], uvs[(x >> 1) * 2 + 1]);
+  }
+}
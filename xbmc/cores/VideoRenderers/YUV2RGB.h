@@ -0,0 +1,52 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+
+/*!
+ \brief Converts 8 bit YUV 4:2:0 pictures to BGRA.
+
+ Uses BT.601 coefficients with limited range input and full range output, which
+ matches the swscale defaults used by the software render paths. With SSE2 the
+ conversion handles 16 pixels at a time, the remaining pixels of a line and
+ builds without SSE2 use the same fixed point math in plain C.
+ */
+class CYUV2RGB
+{
+public:
+  /*!
+   \brief Convert a picture with separate Y, U and V planes.
+   \param dst destination buffer, 4 bytes per pixel.
+   \param dstPitch line size of the destination in bytes.
+   */
+  static void YUV420ToBGRA(uint8_t *dst, int dstPitch,
+                           const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                           int yPitch, int uvPitch, int width, int height);
+
+  /*!
+   \brief Convert a picture with a Y plane and an interleaved UV plane.
+   \param dst destination buffer, 4 bytes per pixel.
+   \param dstPitch line size of the destination in bytes.
+   */
+  static void NV12ToBGRA(uint8_t *dst, int dstPitch,
+                         const uint8_t *y, const uint8_t *uv,
+                         int yPitch, int uvPitch, int width, int height);
+};
@@ -300,6 +300,10 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
     || pCodec->id == AV_CODEC_ID_HEVC))
     m_pCodecContext->thread_count = num_threads;
 
+  // threading rules from advancedsettings.xml, not for thumbnail extraction
+  if (!hints.software)
+    ApplyThreadingRule(pCodec, hints);
+
   if (avcodec_open2(m_pCodecContext, pCodec, NULL) < 0)
   {
     CLog::Log(LOGDEBUG,"CDVDVideoCodecFFmpeg::Open() Unable to open codec");
@@ -316,6 +320,49 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
   return true;
 }
 
+void CDVDVideoCodecFFmpeg::ApplyThreadingRule(const AVCodec* codec, const CDVDStreamInfo &hints)
+{
+  const std::vector<VideoThreadingRule> &rules = g_advancedSettings.m_videoThreadingRules;
+  for (std::vector<VideoThreadingRule>::const_iterator rule = rules.begin(); rule != rules.end(); ++rule)
+  {
+    if (!rule->codec.empty() && !StringUtils::EqualsNoCase(rule->codec, codec->name))
+      continue;
+    if (hints.height < rule->minheight || (rule->maxheight > 0 && hints.height > rule->maxheight))
+      continue;
+
+    int threads = rule->threads > 0 ? rule->threads : g_cpuInfo.getCPUCount();
+    switch (rule->type)
+    {
+    case VIDEO_THREADING_FRAME:
+      // frame threading keeps several packets in flight, but can't be combined with hw accel
+      if (AllowFrameThreading(m_bSoftware, m_isSWCodec, (EDECODEMETHOD) CSettings::Get().GetInt("videoplayer.decodingmethod")))
+      {
+        m_pCodecContext->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        break;
+      }
+      CLog::Log(LOGDEBUG,"CDVDVideoCodecFFmpeg::Open() Frame threading requires software decoding, using slice threading");
+      // fall through
+    case VIDEO_THREADING_SLICE:
+      m_pCodecContext->thread_type = FF_THREAD_SLICE;
+      break;
+    case VIDEO_THREADING_NONE:
+      threads = 1;
+      break;
+    }
+    m_pCodecContext->thread_count = threads;
+
+    CLog::Log(LOGDEBUG,"CDVDVideoCodecFFmpeg::Open() Threading rule for %s at %d lines: thread type %d, %d threads",
+                       codec->name, hints.height, m_pCodecContext->thread_type, threads);
+    return;
+  }
+}
+
+bool CDVDVideoCodecFFmpeg::AllowFrameThreading(bool software, bool swCodec, EDECODEMETHOD decodingMethod)
+{
+  // codecs without a hardware path, such as hevc or hi10p, are decoded in software anyway
+  return software || swCodec || decodingMethod == VS_DECODEMETHOD_SOFTWARE;
+}
+
 void CDVDVideoCodecFFmpeg::Dispose()
 {
   if (m_pFrame) av_free(m_pFrame);
@@ -24,6 +24,8 @@
 #include "DVDResource.h"
 #include <string>
 #include "utils/StdString.h"
+#include "utils/StringUtils.h"
+#include "settings/VideoSettings.h"
 
 extern "C" {
 #include "libavfilter/avfilter.h"
@@ -68,6 +70,13 @@ public:
   virtual unsigned GetConvergeCount();
   virtual unsigned GetAllowedReferences();
 
+  /*! \brief Whether frame threading can be used, as it can't be combined with hardware decoding.
+   \param software whether the codec was opened for software decoding.
+   \param swCodec whether the codec has no hardware path.
+   \param decodingMethod the decoding method the user chose.
+   */
+  static bool AllowFrameThreading(bool software, bool swCodec, EDECODEMETHOD decodingMethod);
+
   bool               IsHardwareAllowed()                     { return !m_bSoftware; }
   IHardwareDecoder * GetHardware()                           { return m_pHardware; };
   void               SetHardware(IHardwareDecoder* hardware) 
@@ -93,8 +102,12 @@ protected:
 
     if(m_pHardware)
       m_name += "-" + m_pHardware->Name();
+    else if(m_pCodecContext->thread_count > 1 && m_pCodecContext->active_thread_type)
+      m_name += StringUtils::Format("-%s%d", m_pCodecContext->active_thread_type == FF_THREAD_FRAME ? "frame" : "slice", m_pCodecContext->thread_count);
   }
 
+  void ApplyThreadingRule(const AVCodec* codec, const CDVDStreamInfo &hints);
+
   AVFrame* m_pFrame;
   AVCodecContext* m_pCodecContext;
 
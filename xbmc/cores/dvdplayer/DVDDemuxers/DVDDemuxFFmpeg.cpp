@@ -37,6 +37,7 @@
 #include "DVDInputStreams/DVDInputStreamPVRManager.h"
 #include "DVDInputStreams/DVDInputStreamFFmpeg.h"
 #include "DVDDemuxUtils.h"
+#include "DVDDemuxProbeCache.h"
 #include "DVDClock.h" // for DVD_TIME_BASE
 #include "commons/Exception.h"
 #include "settings/AdvancedSettings.h"
@@ -153,6 +154,7 @@ CDVDDemuxFFmpeg::CDVDDemuxFFmpeg() : CDVDDemux()
   m_program = UINT_MAX;
   m_pkt.result = -1;
   memset(&m_pkt.pkt, 0, sizeof(AVPacket));
+  m_bProbeCacheMismatch = false;
 }
 
 CDVDDemuxFFmpeg::~CDVDDemuxFFmpeg()
@@ -189,6 +191,27 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
 
   bool streaminfo = true; /* set to true if we want to look for streams before playback*/
 
+  // files we have fully probed before only need a short analysis
+  CDVDDemuxProbeInfo probeInfo;
+  bool probeCacheable = false;
+  bool probeCached = false;
+  int64_t probeFileSize = 0;
+  int64_t probeFileMTime = 0;
+  if (g_advancedSettings.m_videoProbeCache && m_pInput->IsStreamType(DVDSTREAM_TYPE_FILE) &&
+      m_pInput->Seek(0, SEEK_POSSIBLE) != 0)
+  {
+    struct __stat64 st;
+    if (XFILE::CFile::Stat(strFile, &st) == 0 && st.st_size > 0)
+    {
+      probeCacheable = true;
+      probeFileSize = st.st_size;
+      probeFileMTime = st.st_mtime;
+      // after a mismatch the full probe replaces the dropped entry
+      if (!m_bProbeCacheMismatch)
+        probeCached = CDVDDemuxProbeCache::Get().Lookup(strFile, probeFileSize, probeFileMTime, probeInfo);
+    }
+  }
+
   if( m_pInput->GetContent().length() > 0 )
   {
     std::string content = m_pInput->GetContent();
@@ -253,6 +276,15 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
     if(m_pInput->Seek(0, SEEK_POSSIBLE) == 0)
       m_ioContext->seekable = 0;
 
+    if (iformat == NULL && probeCached)
+    {
+      // av_find_input_format() only matches a single short name
+      std::string format = probeInfo.format.substr(0, probeInfo.format.find(','));
+      iformat = av_find_input_format(format.c_str());
+      if (iformat)
+        CLog::Log(LOGDEBUG, "%s - using cached format [%s]", __FUNCTION__, iformat->name);
+    }
+
     if( iformat == NULL )
     {
       // let ffmpeg decide which demuxer we have to open
@@ -394,9 +426,29 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
     if(m_pInput->IsStreamType(DVDSTREAM_TYPE_DVD))
       m_pFormatContext->max_analyze_duration = 500000;
 
+    /* the stream layout is known, we only need the codec parameters */
+    if (probeCached)
+    {
+      m_pFormatContext->max_analyze_duration = 500000;
+      m_pFormatContext->probesize = 1024 * 1024;
+    }
 
     CLog::Log(LOGDEBUG, "%s - avformat_find_stream_info starting", __FUNCTION__);
     int iErr = avformat_find_stream_info(m_pFormatContext, NULL);
+    if (probeCached && (iErr < 0 || !CDVDDemuxProbeCache::Validate(probeInfo, m_pFormatContext)))
+    {
+      CLog::Log(LOGDEBUG, "%s - streams don't match cached probe, probing fully", __FUNCTION__);
+      CDVDDemuxProbeCache::Get().Remove(strFile);
+
+      CDVDInputStream* input = m_pInput;
+      Dispose();
+      if (input->Seek(0, SEEK_SET) != 0)
+        return false;
+      m_bProbeCacheMismatch = true;
+      bool opened = Open(input);
+      m_bProbeCacheMismatch = false;
+      return opened;
+    }
     if (iErr < 0)
     {
       CLog::Log(LOGWARNING,"could not find codec parameters for %s", CURL::GetRedacted(strFile).c_str());
@@ -413,6 +465,15 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       }
     }
     CLog::Log(LOGDEBUG, "%s - av_find_stream_info finished", __FUNCTION__);
+
+    if (probeCached)
+    {
+      // a short analysis may not be enough to estimate the duration
+      if (m_pFormatContext->duration == (int64_t)AV_NOPTS_VALUE && probeInfo.duration > 0)
+        m_pFormatContext->duration = probeInfo.duration;
+    }
+    else if (probeCacheable && iErr >= 0)
+      CDVDDemuxProbeCache::Get().Store(strFile, probeFileSize, probeFileMTime, m_pFormatContext);
   }
   // reset any timeout
   m_timeout.SetInfinite();
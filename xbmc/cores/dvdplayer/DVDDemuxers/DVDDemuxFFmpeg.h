@@ -142,6 +142,7 @@ protected:
   double   m_iCurrentPts; // used for stream length estimation
   bool     m_bMatroska;
   bool     m_bAVI;
+  bool     m_bProbeCacheMismatch; // the cached probe didn't match, the file is probed fully
   int      m_speed;
   unsigned m_program;
   XbmcThreads::EndTime  m_timeout;
@@ -0,0 +1,269 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#ifndef __STDC_CONSTANT_MACROS
+#define __STDC_CONSTANT_MACROS
+#endif
+#ifndef __STDC_LIMIT_MACROS
+#define __STDC_LIMIT_MACROS
+#endif
+#ifdef TARGET_POSIX
+#include "stdint.h"
+#endif
+#include "DVDDemuxProbeCache.h"
+#include <algorithm>
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/XBMCTinyXML.h"
+#include "utils/XMLUtils.h"
+
+extern "C" {
+#include "libavformat/avformat.h"
+}
+
+#define PROBECACHE_FILE         "special://temp/probecache.xml"
+#define PROBECACHE_MAX_ENTRIES  2000
+#define PROBECACHE_SAVE_BATCH   25
+
+static bool UsageSortFunction(const std::pair<unsigned int, std::map<std::string, CDVDDemuxProbeInfo>::iterator> &left,
+                              const std::pair<unsigned int, std::map<std::string, CDVDDemuxProbeInfo>::iterator> &right)
+{
+  return left.first < right.first;
+}
+
+CDVDDemuxProbeCache::CDVDDemuxProbeCache()
+{
+  m_useCounter = 0;
+  m_unsavedChanges = 0;
+  m_loaded = false;
+}
+
+CDVDDemuxProbeCache::~CDVDDemuxProbeCache()
+{
+}
+
+CDVDDemuxProbeCache &CDVDDemuxProbeCache::Get()
+{
+  static CDVDDemuxProbeCache sProbeCache;
+  return sProbeCache;
+}
+
+bool CDVDDemuxProbeCache::Lookup(const std::string &path, int64_t size, int64_t mtime, CDVDDemuxProbeInfo &info)
+{
+  CSingleLock lock(m_critSection);
+  Load();
+
+  ProbeInfoMap::iterator it = m_entries.find(path);
+  if (it == m_entries.end())
+    return false;
+
+  // the file has changed since it was probed
+  if (it->second.size != size || it->second.mtime != mtime)
+  {
+    m_entries.erase(it);
+    m_unsavedChanges++;
+    return false;
+  }
+
+  it->second.lastUsed = ++m_useCounter;
+  info = it->second;
+  return true;
+}
+
+void CDVDDemuxProbeCache::Store(const std::string &path, int64_t size, int64_t mtime, const AVFormatContext *context)
+{
+  if (path.empty() || !context || !context->iformat || !context->iformat->name || context->nb_streams == 0)
+    return;
+
+  CDVDDemuxProbeInfo info;
+  info.size = size;
+  info.mtime = mtime;
+  info.format = context->iformat->name;
+  info.duration = context->duration;
+  for (unsigned int i = 0; i < context->nb_streams; i++)
+  {
+    CDVDDemuxProbeInfo::Stream stream;
+    stream.codecType = context->streams[i]->codec->codec_type;
+    stream.codecId = context->streams[i]->codec->codec_id;
+    info.streams.push_back(stream);
+  }
+
+  // a layout with incomplete codec parameters would never validate
+  if (!Validate(info, context))
+    return;
+
+  bool save = false;
+  {
+    CSingleLock lock(m_critSection);
+    Load();
+
+    info.lastUsed = ++m_useCounter;
+    m_entries[path] = info;
+    if (m_entries.size() > PROBECACHE_MAX_ENTRIES)
+      Evict();
+
+    save = ++m_unsavedChanges >= PROBECACHE_SAVE_BATCH;
+  }
+
+  if (save)
+    Save();
+}
+
+void CDVDDemuxProbeCache::Remove(const std::string &path)
+{
+  CSingleLock lock(m_critSection);
+  if (m_entries.erase(path) > 0)
+    m_unsavedChanges++;
+}
+
+bool CDVDDemuxProbeCache::Validate(const CDVDDemuxProbeInfo &info, const AVFormatContext *context)
+{
+  if (!context || context->nb_streams != info.streams.size())
+    return false;
+
+  for (unsigned int i = 0; i < context->nb_streams; i++)
+  {
+    const AVCodecContext *codec = context->streams[i]->codec;
+    if (codec->codec_type != info.streams[i].codecType ||
+        codec->codec_id != info.streams[i].codecId)
+      return false;
+
+    if (codec->codec_type == AVMEDIA_TYPE_VIDEO && (codec->width <= 0 || codec->height <= 0))
+      return false;
+    if (codec->codec_type == AVMEDIA_TYPE_AUDIO && (codec->channels <= 0 || codec->sample_rate <= 0))
+      return false;
+  }
+
+  return true;
+}
+
+void CDVDDemuxProbeCache::Evict()
+{
+  // drop the least recently used tenth of the entries in one go
+  std::vector<std::pair<unsigned int, ProbeInfoMap::iterator> > usage;
+  usage.reserve(m_entries.size());
+  for (ProbeInfoMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    usage.push_back(std::make_pair(it->second.lastUsed, it));
+
+  // entries used equally long ago are cut at the same count, so ties can't stop the eviction
+  size_t count = std::max<size_t>(usage.size() / 10, 1);
+  std::nth_element(usage.begin(), usage.begin() + count - 1, usage.end(), UsageSortFunction);
+  for (size_t i = 0; i < count; i++)
+    m_entries.erase(usage[i].second);
+}
+
+void CDVDDemuxProbeCache::Load()
+{
+  if (m_loaded)
+    return;
+  m_loaded = true;
+
+  CXBMCTinyXML doc;
+  if (!doc.LoadFile(PROBECACHE_FILE))
+    return;
+
+  const TiXmlElement *root = doc.RootElement();
+  if (!root || root->ValueStr() != "probecache")
+    return;
+
+  const TiXmlElement *file = root->FirstChildElement("file");
+  while (file)
+  {
+    CDVDDemuxProbeInfo info;
+    std::string path, size, mtime, duration;
+    if (XMLUtils::GetString(file, "path", path) &&
+        XMLUtils::GetString(file, "size", size) &&
+        XMLUtils::GetString(file, "mtime", mtime) &&
+        XMLUtils::GetString(file, "format", info.format))
+    {
+      info.size = strtoll(size.c_str(), NULL, 10);
+      info.mtime = strtoll(mtime.c_str(), NULL, 10);
+      if (XMLUtils::GetString(file, "duration", duration))
+        info.duration = strtoll(duration.c_str(), NULL, 10);
+
+      // the entries are saved in path order, caches without the usage count them as loaded
+      int lastUsed;
+      if (XMLUtils::GetInt(file, "lastused", lastUsed) && lastUsed > 0)
+        info.lastUsed = lastUsed;
+      else
+        info.lastUsed = m_useCounter + 1;
+      m_useCounter = std::max(m_useCounter, info.lastUsed);
+
+      const TiXmlElement *stream = file->FirstChildElement("stream");
+      while (stream)
+      {
+        CDVDDemuxProbeInfo::Stream entry;
+        if (stream->QueryIntAttribute("type", &entry.codecType) == TIXML_SUCCESS &&
+            stream->QueryIntAttribute("codec", &entry.codecId) == TIXML_SUCCESS)
+          info.streams.push_back(entry);
+        stream = stream->NextSiblingElement("stream");
+      }
+
+      if (!info.streams.empty())
+        m_entries[path] = info;
+    }
+    file = file->NextSiblingElement("file");
+  }
+
+  CLog::Log(LOGDEBUG, "%s - loaded %u cached stream probes", __FUNCTION__, (unsigned int)m_entries.size());
+}
+
+void CDVDDemuxProbeCache::Save()
+{
+  // the document is built under m_critSection, writing it only holds up other saves
+  CSingleLock saveLock(m_saveSection);
+  CXBMCTinyXML doc;
+  {
+    CSingleLock lock(m_critSection);
+    if (m_unsavedChanges == 0)
+      return;
+    m_unsavedChanges = 0;
+
+    TiXmlElement rootElement("probecache");
+    TiXmlNode *root = doc.InsertEndChild(rootElement);
+    if (!root)
+      return;
+
+    for (ProbeInfoMap::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+      const CDVDDemuxProbeInfo &info = it->second;
+      TiXmlElement fileElement("file");
+      TiXmlNode *file = root->InsertEndChild(fileElement);
+      XMLUtils::SetString(file, "path", it->first);
+      XMLUtils::SetString(file, "size", StringUtils::Format("%" PRId64, info.size));
+      XMLUtils::SetString(file, "mtime", StringUtils::Format("%" PRId64, info.mtime));
+      XMLUtils::SetString(file, "format", info.format);
+      XMLUtils::SetString(file, "duration", StringUtils::Format("%" PRId64, info.duration));
+      XMLUtils::SetInt(file, "lastused", info.lastUsed);
+      for (std::vector<CDVDDemuxProbeInfo::Stream>::const_iterator stream = info.streams.begin(); stream != info.streams.end(); ++stream)
+      {
+        TiXmlElement streamElement("stream");
+        streamElement.SetAttribute("type", stream->codecType);
+        streamElement.SetAttribute("codec", stream->codecId);
+        file->InsertEndChild(streamElement);
+      }
+    }
+  }
+
+  if (!doc.SaveFile(PROBECACHE_FILE))
+    CLog::Log(LOGWARNING, "%s - unable to save %s", __FUNCTION__, PROBECACHE_FILE);
+}
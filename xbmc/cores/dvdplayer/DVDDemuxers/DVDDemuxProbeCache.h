@@ -0,0 +1,118 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "threads/CriticalSection.h"
+
+struct AVFormatContext;
+
+/*!
+ \brief Stream layout of a file as found by a full avformat_find_stream_info run.
+ */
+class CDVDDemuxProbeInfo
+{
+public:
+  CDVDDemuxProbeInfo() : size(0), mtime(0), duration(0), lastUsed(0) {}
+
+  struct Stream
+  {
+    int codecType;
+    int codecId;
+  };
+
+  int64_t size;
+  int64_t mtime;
+  std::string format;     ///< name of the input format, e.g. "matroska,webm"
+  int64_t duration;       ///< container duration in AV_TIME_BASE units
+  std::vector<Stream> streams;
+  unsigned int lastUsed;  ///< used to evict the least recently used entries
+};
+
+/*!
+ \brief Persistent cache of stream probe results for local and network files.
+
+ The first time a file is opened by CDVDDemuxFFmpeg it is fully probed and the resulting
+ stream layout is stored here, keyed by path, size and modification time. Subsequent opens
+ of the same file skip input format probing and only run a short stream analysis, after which
+ the found streams are validated against the cached layout. On any mismatch the entry is
+ dropped and the demuxer falls back to a full probe.
+
+ As CDVDFileInfo::GetFileStreamDetails() opens files through the same demuxer, library scans
+ populate the cache before first playback.
+ */
+class CDVDDemuxProbeCache
+{
+public:
+  static CDVDDemuxProbeCache &Get();
+
+  /*! \brief Retrieve the cached probe results of a file.
+   \param path the path of the file.
+   \param size the current size of the file.
+   \param mtime the current modification time of the file.
+   \param info [out] the cached probe results.
+   \return true if a matching entry exists, false otherwise.
+   */
+  bool Lookup(const std::string &path, int64_t size, int64_t mtime, CDVDDemuxProbeInfo &info);
+
+  /*! \brief Store the probe results of a fully probed file.
+   \param path the path of the file.
+   \param size the size of the file.
+   \param mtime the modification time of the file.
+   \param context the format context after avformat_find_stream_info().
+   */
+  void Store(const std::string &path, int64_t size, int64_t mtime, const AVFormatContext *context);
+
+  /*! \brief Remove the cached probe results of a file.
+   \param path the path of the file.
+   */
+  void Remove(const std::string &path);
+
+  /*! \brief Check whether the streams found by a short analysis match the cached layout.
+   \param info the cached probe results.
+   \param context the format context after avformat_find_stream_info().
+   \return true if all streams match and have their codec parameters set, false otherwise.
+   */
+  static bool Validate(const CDVDDemuxProbeInfo &info, const AVFormatContext *context);
+
+  /*! \brief Write the cache to disk if it has been modified.
+   */
+  void Save();
+
+private:
+  CDVDDemuxProbeCache();
+  CDVDDemuxProbeCache(const CDVDDemuxProbeCache&);
+  CDVDDemuxProbeCache const& operator=(CDVDDemuxProbeCache const&);
+  virtual ~CDVDDemuxProbeCache();
+
+  void Load();
+  void Evict();
+
+  typedef std::map<std::string, CDVDDemuxProbeInfo> ProbeInfoMap;
+  ProbeInfoMap m_entries;
+  unsigned int m_useCounter;
+  unsigned int m_unsavedChanges;
+  bool m_loaded;
+  CCriticalSection m_critSection;
+  CCriticalSection m_saveSection;
+};
@@ -26,6 +26,7 @@
 #include "settings/Settings.h"
 #include "video/VideoReferenceClock.h"
 #include "utils/MathUtils.h"
+#include "utils/TimeUtils.h"
 #include "DVDPlayer.h"
 #include "DVDPlayerVideo.h"
 #include "DVDCodecs/DVDFactoryCodec.h"
@@ -151,6 +152,8 @@ CDVDPlayerVideo::CDVDPlayerVideo( CDVDClock* pClock
 
   m_iCurrentPts = DVD_NOPTS_VALUE;
   m_iDroppedFrames = 0;
+  m_decodeTicks = 0;
+  m_fDecodeTime = 0.0;
   m_fFrameRate = 25;
   m_bCalcFrameRate = false;
   m_fStableFrameRate = 0.0;
@@ -296,6 +299,8 @@ void CDVDPlayerVideo::CloseStream(bool bWaitForBuffers)
 void CDVDPlayerVideo::OnStartup()
 {
   m_iDroppedFrames = 0;
+  m_decodeTicks = 0;
+  m_fDecodeTime = 0.0;
 
   m_crop.x1 = m_crop.x2 = 0.0f;
   m_crop.y1 = m_crop.y2 = 0.0f;
@@ -551,7 +556,7 @@ void CDVDPlayerVideo::Process()
 
       mFilters = m_pVideoCodec->SetFilters(mFilters);
 
-      int iDecoderState = m_pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+      int iDecoderState = DecodePacket(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
 
       // buffer packets so we can recover should decoder flush for some reason
       if(m_pVideoCodec->GetConvergeCount() > 0)
@@ -619,6 +624,10 @@ void CDVDPlayerVideo::Process()
           {
             sPostProcessType.clear();
 
+            double decodeTime = (double)m_decodeTicks * 1000.0 / (double)CurrentHostFrequency();
+            m_fDecodeTime = m_fDecodeTime == 0.0 ? decodeTime : m_fDecodeTime * 0.95 + decodeTime * 0.05;
+            m_decodeTicks = 0;
+
             if(picture.iDuration == 0.0)
               picture.iDuration = frametime;
 
@@ -750,7 +759,7 @@ void CDVDPlayerVideo::Process()
           break;
 
         // the decoder didn't need more data, flush the remaning buffer
-        iDecoderState = m_pVideoCodec->Decode(NULL, 0, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
+        iDecoderState = DecodePacket(NULL, 0, DVD_NOPTS_VALUE, DVD_NOPTS_VALUE);
       }
     }
 
@@ -762,6 +771,16 @@ void CDVDPlayerVideo::Process()
   m_pVideoCodec->ClearPicture(&picture);
 }
 
+int CDVDPlayerVideo::DecodePacket(uint8_t* pData, int iSize, double dts, double pts)
+{
+  // with frame threading this only covers the time the decoder blocks us,
+  // the worker threads decode in parallel
+  int64_t start = CurrentHostCounter();
+  int iDecoderState = m_pVideoCodec->Decode(pData, iSize, dts, pts);
+  m_decodeTicks += CurrentHostCounter() - start;
+  return iDecoderState;
+}
+
 void CDVDPlayerVideo::OnExit()
 {
   if (m_pOverlayCodecCC)
@@ -1433,6 +1452,8 @@ std::string CDVDPlayerVideo::GetPlayerInfo()
   s << ", vq:"   << setw(2) << min(99,GetLevel()) << "%";
   s << ", dc:"   << m_codecname;
   s << ", Mb/s:" << fixed << setprecision(2) << (double)GetVideoBitrate() / (1024.0*1024.0);
+  s << ", pq:"   << m_messageQueue.GetPacketCount(CDVDMsg::DEMUXER_PACKET);
+  s << ", dt:"   << fixed << setprecision(1) << m_fDecodeTime << "ms";
   s << ", drop:" << m_iDroppedFrames;
   s << ", skip:" << g_renderManager.GetSkippedFrames();
 
@@ -127,6 +127,10 @@ protected:
   int m_iDroppedFrames;
   int m_iDroppedRequest;
 
+  int    DecodePacket(uint8_t* pData, int iSize, double dts, double pts);
+  int64_t m_decodeTicks;     //time spent in the decoder since the last picture
+  double m_fDecodeTime;      //average time spent in the decoder per picture in ms
+
   void   ResetFrameRateCalc();
   void   CalcFrameRate();
 
@@ -23,6 +23,7 @@
 #include "filesystem/SpecialProtocol.h"
 #include "filesystem/File.h"
 #include "profiles/ProfilesManager.h"
+#include "threads/SystemClock.h"
 #include "utils/AutoPtrHandle.h"
 #include "utils/log.h"
 #include "utils/SortUtils.h"
@@ -321,7 +322,28 @@ bool CDatabase::Open(const DatabaseSettings &settings)
 
   CStdString dbName = dbSettings.name;
   dbName += StringUtils::Format("%d", GetSchemaVersion());
-  return Connect(dbName, dbSettings, false);
+
+  // reuse an idle connection to the same database if there is one
+  std::string poolKey = dbSettings.type + "|" + dbSettings.host + "|" + dbSettings.port + "|" + dbSettings.user + "|" + dbName;
+  Database *db = NULL;
+  Dataset *ds = NULL, *ds2 = NULL;
+  if (CDatabaseManager::Get().AcquireConnection(poolKey, db, ds, ds2))
+  {
+    m_pDB.reset(db);
+    m_pDS.reset(ds);
+    m_pDS2.reset(ds2);
+    m_sqlite = dbSettings.type.Equals("sqlite3");
+    m_poolKey = poolKey;
+    m_openCount = 1;
+    return true;
+  }
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  if (!Connect(dbName, dbSettings, false))
+    return false;
+  CDatabaseManager::Get().ConnectionMade(XbmcThreads::SystemClockMillis() - start);
+  m_poolKey = poolKey;
+  return true;
 }
 
 void CDatabase::InitSettings(DatabaseSettings &dbSettings)
@@ -423,10 +445,14 @@ bool CDatabase::Update(const DatabaseSettings &settings)
 
 bool CDatabase::Connect(const CStdString &dbName, const DatabaseSettings &dbSettings, bool create)
 {
+  m_poolKey.clear();
+
   // create the appropriate database structure
   if (dbSettings.type.Equals("sqlite3"))
   {
-    m_pDB.reset( new SqliteDatabase() ) ;
+    SqliteDatabase *sqlite = new SqliteDatabase();
+    sqlite->setReportChanges(ReportsChanges());
+    m_pDB.reset(sqlite);
   }
 #ifdef HAS_MYSQL
   else if (dbSettings.type.Equals("mysql"))
@@ -579,12 +605,34 @@ void CDatabase::Close()
 
   if (NULL == m_pDB.get() ) return ;
   if (NULL != m_pDS.get()) m_pDS->close();
+  if (ReleaseConnection())
+    return;
   m_pDB->disconnect();
   m_pDB.reset();
   m_pDS.reset();
   m_pDS2.reset();
 }
 
+bool CDatabase::ReleaseConnection()
+{
+  if (m_poolKey.empty() || NULL == m_pDS.get() || NULL == m_pDS2.get())
+    return false;
+
+  // a connection in the middle of a transaction isn't fit for anyone else
+  if (m_pDB->in_transaction())
+    return false;
+
+  m_pDS2->close();
+  if (!CDatabaseManager::Get().ReleaseConnection(m_poolKey, m_pDB.get(), m_pDS.get(), m_pDS2.get()))
+    return false;
+
+  m_pDB.release();
+  m_pDS.release();
+  m_pDS2.release();
+  m_poolKey.clear();
+  return true;
+}
+
 bool CDatabase::Compress(bool bForce /* =true */)
 {
   if (!m_sqlite)
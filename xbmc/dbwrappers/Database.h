@@ -199,6 +199,11 @@ protected:
   virtual int GetSchemaVersion() const=0;
   virtual const char *GetBaseDBName() const=0;
 
+  /* \brief Whether the rows written to the database are reported to the change handler of sqlite databases.
+   \sa CSmartPlaylistCache
+   */
+  virtual bool ReportsChanges() const { return false; };
+
   int GetDBVersion();
   bool UpdateVersion(const CStdString &dbName);
 
@@ -213,6 +218,7 @@ protected:
 private:
   void InitSettings(DatabaseSettings &dbSettings);
   bool Connect(const CStdString &dbName, const DatabaseSettings &db, bool create);
+  bool ReleaseConnection();
   void UpdateVersionNumber();
 
   bool m_bMultiWrite; /*!< True if there are any queries in the queue, false otherwise */
@@ -220,4 +226,6 @@ private:
 
   bool m_multipleExecute;
   std::vector<std::string> m_multipleQueries;
+
+  std::string m_poolKey; ///< pool the connection goes back to on Close(), empty if it isn't pooled
 };
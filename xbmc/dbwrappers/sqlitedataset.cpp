@@ -86,12 +86,24 @@ static int busy_callback(void*, int busyCount)
   return 1;
 }
 
+static void update_callback(void *data, int operation, const char *database, const char *table, sqlite3_int64 rowid)
+{
+  ((SqliteDatabase *)data)->addChange(table, rowid);
+}
+
+// rows kept per transaction, only the changed tables are kept above that
+#define MAX_CHANGED_ROWS 1000
+
 //************* SqliteDatabase implementation ***************
 
+SqliteDatabase::ChangeHandler SqliteDatabase::changeHandler = NULL;
+
 SqliteDatabase::SqliteDatabase() {
 
   active = false;  
   _in_transaction = false;    // for transaction
+  changedTables = false;
+  followChanges = false;
 
   error = "Unknown database error";//S_NO_CONNECTION;
   host = "localhost";
@@ -222,6 +234,8 @@ int SqliteDatabase::connect(bool create) {
     if (sqlite3_open_v2(db_fullpath.c_str(), &conn, flags, NULL)==SQLITE_OK)
     {
       sqlite3_busy_handler(conn, busy_callback, NULL);
+      if (followChanges)
+        sqlite3_update_hook(conn, update_callback, this);
       char* err=NULL;
       if (setErr(sqlite3_exec(getHandle(),"PRAGMA empty_result_callbacks=ON",NULL,NULL,&err),"PRAGMA empty_result_callbacks=ON") != SQLITE_OK)
       {
@@ -261,6 +275,32 @@ void SqliteDatabase::disconnect(void) {
   if (active == false) return;
   sqlite3_close(conn);
   active = false;
+  changes.clear();
+  changedTables = false;
+}
+
+void SqliteDatabase::addChange(const char *table, int64_t rowid) {
+  if (changeHandler == NULL) return;
+  if (!changedTables && changes.size() >= MAX_CHANGED_ROWS) {
+    std::set<std::pair<std::string, int64_t> > tables;
+    for (std::set<std::pair<std::string, int64_t> >::const_iterator i = changes.begin(); i != changes.end(); ++i)
+      tables.insert(std::make_pair(i->first, (int64_t)0));
+    changes.swap(tables);
+    changedTables = true;
+  }
+  changes.insert(std::make_pair(std::string(table), changedTables ? 0 : rowid));
+}
+
+void SqliteDatabase::reportChanges() {
+  // the changes of a transaction are seen by other connections once it's committed
+  if (changes.empty() || !active || !sqlite3_get_autocommit(conn)) return;
+  std::set<std::pair<std::string, int64_t> > changed;
+  changed.swap(changes);
+  changedTables = false;
+  ChangeHandler handler = changeHandler;
+  if (handler == NULL) return;
+  for (std::set<std::pair<std::string, int64_t> >::const_iterator i = changed.begin(); i != changed.end(); ++i)
+    handler(host.c_str(), db.c_str(), i->first.c_str(), i->second);
 }
 
 int SqliteDatabase::create() {
@@ -403,6 +443,7 @@ void SqliteDatabase::commit_transaction() {
   if (active) {
     sqlite3_exec(conn,"commit",NULL,NULL,NULL);
     _in_transaction = false;
+    reportChanges();
   }
 }
 
@@ -410,6 +451,7 @@ void SqliteDatabase::rollback_transaction() {
   if (active) {
     sqlite3_exec(conn,"rollback",NULL,NULL,NULL);
     _in_transaction = false;
+    reportChanges();
   }  
 }
 
@@ -503,6 +545,7 @@ void SqliteDataset::make_query(StringList &_sql) {
 
 
   if (db->in_transaction() && autocommit) db->commit_transaction();
+  static_cast<SqliteDatabase*>(db)->reportChanges();
 
   active = true;
   ds_state = dsSelect;    
@@ -621,7 +664,9 @@ int SqliteDataset::exec(const string &sql) {
       qry = qry.substr(0, pos);
   }
 
-  if((res = db->setErr(sqlite3_exec(handle(),qry.c_str(),&callback,&exec_res,&errmsg),qry.c_str())) == SQLITE_OK)
+  res = db->setErr(sqlite3_exec(handle(),qry.c_str(),&callback,&exec_res,&errmsg),qry.c_str());
+  static_cast<SqliteDatabase*>(db)->reportChanges();
+  if (res == SQLITE_OK)
     return res;
   else
     {
@@ -30,6 +30,7 @@
 #define _SQLITEDATASET_H
 
 #include <stdio.h>
+#include <set>
 #include "dataset.h"
 #include <sqlite3.h>
 
@@ -40,11 +41,20 @@ namespace dbiplus {
 
 ******************************************************************/
 class SqliteDatabase: public Database {
+public:
+/* function called for the rows inserted, updated or deleted on the connections reporting changes */
+  typedef void (*ChangeHandler)(const char *host, const char *database, const char *table, int64_t rowid);
+
 protected:
 /* connect descriptor */
   sqlite3 *conn;
   bool _in_transaction;
   int last_err;
+/* rows changed and not yet passed to the change handler, rowid 0 for all rows of a table */
+  std::set<std::pair<std::string, int64_t> > changes;
+  bool changedTables;
+  bool followChanges;
+  static ChangeHandler changeHandler;
 
 public:
 /* default constructor */
@@ -97,6 +107,15 @@ public:
 
   bool in_transaction() {return _in_transaction;}; 	
 
+/* whether the rows changed on this connection are reported, to be set before connecting */
+  void setReportChanges(bool report) { followChanges = report; }
+/* sets the function called for the changed rows once they're committed, NULL for none */
+  static void setChangeHandler(ChangeHandler handler) { changeHandler = handler; }
+/* records a row changed by the current statement */
+  void addChange(const char *table, int64_t rowid);
+/* passes the changed rows to the change handler if they're committed */
+  void reportChanges();
+
 };
 
 
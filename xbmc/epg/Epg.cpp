@@ -352,11 +352,12 @@ bool CEpg::UpdateEntry(const CEpgInfoTag &tag, bool bUpdateDatabase /* = false *
     bNewTag = true;
   }
 
-  infoTag->Update(tag, bNewTag);
+  bool bChanged = infoTag->Update(tag, bNewTag);
   infoTag->m_epg          = this;
   infoTag->m_pvrChannel   = m_pvrChannel;
 
-  if (bUpdateDatabase)
+  /* don't rewrite tags that haven't changed */
+  if (bUpdateDatabase && (bNewTag || bChanged))
     m_changedTags.insert(make_pair(infoTag->UniqueBroadcastID(), infoTag));
 
   return true;
@@ -557,7 +558,7 @@ bool CEpg::Persist(void)
     }
 
     for (std::map<int, CEpgInfoTagPtr>::iterator it = m_deletedTags.begin(); it != m_deletedTags.end(); it++)
-      database->Delete(*it->second);
+      database->Delete(*it->second, true);
 
     for (std::map<int, CEpgInfoTagPtr>::iterator it = m_changedTags.begin(); it != m_changedTags.end(); it++)
       it->second->Persist(false);
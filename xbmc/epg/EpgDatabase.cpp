@@ -135,12 +135,16 @@ bool CEpgDatabase::DeleteOldEpgEntries(void)
   return DeleteValues("epgtags", filter);
 }
 
-bool CEpgDatabase::Delete(const CEpgInfoTag &tag)
+bool CEpgDatabase::Delete(const CEpgInfoTag &tag, bool bQueueWrite /* = false */)
 {
   /* tag without a database ID was not persisted */
   if (tag.BroadcastId() <= 0)
     return false;
 
+  /* remove it in the same transaction as the other queued changes */
+  if (bQueueWrite)
+    return QueueInsertQuery(PrepareSQL("DELETE FROM epgtags WHERE idBroadcast = %u", tag.BroadcastId()));
+
   Filter filter;
   filter.AppendWhere(PrepareSQL("idBroadcast = %u", tag.BroadcastId()));
 
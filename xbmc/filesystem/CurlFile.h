@@ -88,11 +88,13 @@ namespace XFILE
       void SetMimeType(CStdString mimetype)                      { SetRequestHeader("Content-Type", mimetype); }
       void SetRequestHeader(CStdString header, CStdString value);
       void SetRequestHeader(CStdString header, long value);
+      void RemoveRequestHeader(const CStdString &header)         { m_requestheaders.erase(header); }
 
       void ClearRequestHeaders();
       void SetBufferSize(unsigned int size);
 
       const CHttpHeader& GetHttpHeader() { return m_state->m_httpheader; }
+      long GetResponseCode() const                               { return m_httpresponse; }
       std::string GetServerReportedCharset(void);
 
       /* static function that will get content type of a file */
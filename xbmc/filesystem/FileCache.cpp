@@ -26,6 +26,7 @@
 #include "URL.h"
 
 #include "CircularCache.h"
+#include "SegmentedFileReader.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
@@ -35,6 +36,7 @@ using namespace AUTOPTR;
 using namespace XFILE;
 
 #define READ_CACHE_CHUNK_SIZE (64*1024)
+#define SEGMENTED_MIN_LENGTH  (32*1024*1024)
 
 class CWriteRate
 {
@@ -85,6 +87,7 @@ CFileCache::CFileCache(bool useDoubleCache) : CThread("FileCache")
    m_seekPos = 0;
    m_readPos = 0;
    m_writePos = 0;
+   m_segmented = NULL;
    if (g_advancedSettings.m_cacheMemBufferSize == 0)
      m_pCache = new CSimpleFileCache();
    else
@@ -115,6 +118,7 @@ CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache) : CThread("Fil
   m_writePos = 0;
   m_nSeekResult = 0;
   m_chunkSize = 0;
+  m_segmented = NULL;
 }
 
 CFileCache::~CFileCache()
@@ -179,6 +183,16 @@ bool CFileCache::Open(const CURL& url)
   m_seekPossible = m_source.IoControl(IOCTRL_SEEK_POSSIBLE, NULL);
   m_chunkSize = CFile::GetChunkSize(m_source.GetChunkSize(), READ_CACHE_CHUNK_SIZE);
 
+  // a single connection rarely reaches line rate on high latency links,
+  // so large http files are fetched as byte ranges over several connections
+  if (g_advancedSettings.m_cacheConnections > 1 && m_seekPossible > 0 &&
+      (url.GetProtocol().Equals("http") || url.GetProtocol().Equals("https")) &&
+      m_source.GetLength() >= SEGMENTED_MIN_LENGTH)
+  {
+    CLog::Log(LOGDEBUG, "CFileCache::Open - using up to %u connections", g_advancedSettings.m_cacheConnections);
+    m_segmented = new CSegmentedFileReader(m_sourcePath, m_source.GetLength(), g_advancedSettings.m_cacheConnections);
+  }
+
   m_readPos = 0;
   m_writePos = 0;
   m_writeRate = 1024 * 1024;
@@ -223,7 +237,10 @@ void CFileCache::Process()
       bool sourceSeekFailed = false;
       if (!cacheReachEOF)
       {
-        m_nSeekResult = m_source.Seek(cacheMaxPos, SEEK_SET);
+        if (m_segmented)
+          m_nSeekResult = m_segmented->Seek(cacheMaxPos);
+        else
+          m_nSeekResult = m_source.Seek(cacheMaxPos, SEEK_SET);
         if (m_nSeekResult != cacheMaxPos)
         {
           CLog::Log(LOGERROR,"CFileCache::Process - Error %d seeking. Seek returned %"PRId64, (int)GetLastError(), m_nSeekResult);
@@ -266,7 +283,17 @@ void CFileCache::Process()
 
     int iRead = 0;
     if (!cacheReachEOF)
-      iRead = m_source.Read(buffer.get(), m_chunkSize);
+    {
+      if (m_segmented)
+      {
+        iRead = m_segmented->Read(buffer.get(), m_chunkSize, 100);
+        // nothing arrived yet, check for seeks before waiting again
+        if (iRead == 0 && !m_segmented->IsEOF())
+          continue;
+      }
+      else
+        iRead = m_source.Read(buffer.get(), m_chunkSize);
+    }
     if (iRead == 0)
     {
       CLog::Log(LOGINFO, "CFileCache::Process - Hit eof.");
@@ -450,6 +477,9 @@ void CFileCache::Close()
 {
   StopThread();
 
+  delete m_segmented;
+  m_segmented = NULL;
+
   CSingleLock lock(m_sync);
   if (m_pCache)
     m_pCache->Close();
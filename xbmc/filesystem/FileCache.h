@@ -27,6 +27,7 @@
 
 namespace XFILE
 {
+  class CSegmentedFileReader;
 
   class CFileCache : public IFile, public CThread
   {
@@ -66,6 +67,7 @@ namespace XFILE
     bool      m_bDeleteCache;
     int        m_seekPossible;
     CFile      m_source;
+    CSegmentedFileReader *m_segmented;
     CStdString    m_sourcePath;
     CEvent      m_seekEvent;
     CEvent      m_seekEnded;
@@ -0,0 +1,324 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SegmentedFileReader.h"
+#include "File.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "utils/log.h"
+
+#include <algorithm>
+
+#define SEGMENT_SIZE       (4*1024*1024)
+#define SEGMENT_READ_SIZE  (64*1024)
+#define SEGMENT_RETRIES    3
+
+using namespace XFILE;
+
+namespace XFILE
+{
+  class CSegmentFileSource : public ISegmentSource
+  {
+  public:
+    virtual bool Open(const CStdString &path)
+    {
+      return m_file.Open(path, READ_NO_CACHE | READ_TRUNCATED | READ_CHUNKED);
+    }
+    virtual int64_t Seek(int64_t position) { return m_file.Seek(position, SEEK_SET); }
+    virtual unsigned int Read(void *buffer, unsigned int size) { return m_file.Read(buffer, size); }
+    virtual void Close() { m_file.Close(); }
+
+  private:
+    CFile m_file;
+  };
+
+  class CSegmentWorker : public CThread
+  {
+  public:
+    CSegmentWorker(CSegmentedFileReader *reader)
+      : CThread("SegmentWorker")
+      , m_reader(reader)
+    {
+    }
+
+  protected:
+    virtual void Process()
+    {
+      ISegmentSource *file = m_reader->m_factory ? m_reader->m_factory() : new CSegmentFileSource;
+      bool opened = false;
+      std::vector<char> buffer(SEGMENT_READ_SIZE);
+
+      while (!m_bStop)
+      {
+        CSegmentedFileReader::Segment *segment = m_reader->GetWork(this);
+        if (!segment)
+        {
+          m_reader->m_workEvent.WaitMSec(100);
+          continue;
+        }
+
+        // the segment is ours until it's released, so its fill level is stable
+        int64_t position = segment->start + segment->filled;
+        if (!opened)
+          opened = file->Open(m_reader->m_path);
+        if (!opened || file->Seek(position) != position)
+        {
+          CLog::Log(LOGWARNING, "CSegmentWorker::Process - unable to request data at %" PRId64, position);
+          file->Close();
+          opened = false;
+          m_reader->Release(segment, true);
+          continue;
+        }
+
+        bool failed = false;
+        while (!m_bStop && segment->filled < segment->data.size())
+        {
+          unsigned int size = std::min((unsigned int)buffer.size(), (unsigned int)segment->data.size() - segment->filled);
+          unsigned int read = file->Read(&buffer[0], size);
+          if (read == 0 || read > size)
+          {
+            failed = true;
+            break;
+          }
+          if (!m_reader->Deliver(segment, &buffer[0], read))
+            break;
+        }
+
+        if (failed)
+        {
+          file->Close();
+          opened = false;
+        }
+        m_reader->Release(segment, failed);
+      }
+
+      file->Close();
+      delete file;
+    }
+
+  private:
+    CSegmentedFileReader *m_reader;
+  };
+}
+
+CSegmentedFileReader::CSegmentedFileReader(const CStdString &path, int64_t length, unsigned int connections, SourceFactory factory, Clock clock)
+  : m_dataEvent(false), m_workEvent(true)
+{
+  m_path = path;
+  m_factory = factory;
+  m_clock = clock ? clock : XbmcThreads::SystemClockMillis;
+  m_length = length;
+  m_position = 0;
+  m_queued = 0;
+  m_maxActive = std::max(connections, 1U);
+  m_active = std::min(2U, m_maxActive);
+  m_rateStamp = m_clock();
+  m_rateBytes = 0;
+  m_lastRate = 0;
+
+  for (unsigned int i = 0; i < m_maxActive; i++)
+  {
+    CSegmentWorker *worker = new CSegmentWorker(this);
+    worker->Create();
+    m_workers.push_back(worker);
+  }
+}
+
+CSegmentedFileReader::~CSegmentedFileReader()
+{
+  for (std::vector<CSegmentWorker*>::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+    (*it)->StopThread(false);
+  m_workEvent.Set();
+  for (std::vector<CSegmentWorker*>::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+  {
+    (*it)->StopThread(true);
+    delete *it;
+  }
+  m_workers.clear();
+
+  for (std::deque<Segment*>::iterator it = m_segments.begin(); it != m_segments.end(); ++it)
+    delete *it;
+  m_segments.clear();
+}
+
+int CSegmentedFileReader::Read(char *buffer, unsigned int size, unsigned int timeout)
+{
+  CSingleLock lock(m_section);
+
+  for (bool waited = false; ; waited = true)
+  {
+    // drop the segments we're done with
+    while (!m_segments.empty() && !m_segments.front()->owner &&
+           m_segments.front()->consumed == m_segments.front()->data.size())
+    {
+      AdaptConnections(m_segments.front()->data.size());
+      delete m_segments.front();
+      m_segments.pop_front();
+    }
+
+    if (m_position >= m_length)
+      return 0;
+
+    QueueSegments();
+
+    Segment *segment = m_segments.front();
+    if (segment->consumed < segment->filled)
+    {
+      unsigned int available = std::min(size, segment->filled - segment->consumed);
+      memcpy(buffer, &segment->data[segment->consumed], available);
+      segment->consumed += available;
+      m_position += available;
+      return available;
+    }
+
+    if (segment->failed)
+    {
+      CLog::Log(LOGERROR, "%s - giving up on data at %" PRId64, __FUNCTION__, segment->start + segment->filled);
+      return -1;
+    }
+
+    if (waited)
+      return 0;
+
+    m_dataEvent.Reset();
+    CSingleExit exit(m_section);
+    m_dataEvent.WaitMSec(timeout);
+  }
+}
+
+int64_t CSegmentedFileReader::Seek(int64_t position)
+{
+  CSingleLock lock(m_section);
+  if (position < 0 || position > m_length)
+    return -1;
+
+  // segments being downloaded are deleted by their worker
+  for (std::deque<Segment*>::iterator it = m_segments.begin(); it != m_segments.end(); ++it)
+  {
+    if ((*it)->owner)
+      (*it)->abandoned = true;
+    else
+      delete *it;
+  }
+  m_segments.clear();
+
+  m_position = position;
+  m_queued = position;
+  m_rateStamp = m_clock();
+  m_rateBytes = 0;
+  QueueSegments();
+  return m_position;
+}
+
+void CSegmentedFileReader::QueueSegments()
+{
+  bool queued = false;
+  while (m_segments.size() < m_active && m_queued < m_length)
+  {
+    Segment *segment = new Segment();
+    segment->start = m_queued;
+    segment->data.resize((size_t)std::min((int64_t)SEGMENT_SIZE, m_length - m_queued));
+    segment->filled = 0;
+    segment->consumed = 0;
+    segment->retries = 0;
+    segment->owner = NULL;
+    segment->abandoned = false;
+    segment->failed = false;
+    m_queued += segment->data.size();
+    m_segments.push_back(segment);
+    queued = true;
+  }
+  if (queued)
+    m_workEvent.Set();
+}
+
+void CSegmentedFileReader::AdaptConnections(unsigned int bytes)
+{
+  // measure over as many segments as are in flight
+  m_rateBytes += bytes;
+  if (m_rateBytes < (int64_t)m_active * SEGMENT_SIZE)
+    return;
+
+  unsigned int now = m_clock();
+  unsigned int elapsed = now - m_rateStamp;
+  if (elapsed == 0)
+    return;
+
+  unsigned int rate = (unsigned int)(1000 * m_rateBytes / elapsed);
+  unsigned int active = m_active;
+  if ((m_lastRate == 0 || rate > m_lastRate + m_lastRate / 10) && m_active < m_maxActive)
+    m_active++;
+  else if (rate < m_lastRate - m_lastRate / 10 && m_active > 1)
+    m_active--;
+
+  if (active != m_active)
+    CLog::Log(LOGDEBUG, "CSegmentedFileReader - %u kB/s, using %u segments", rate / 1024, m_active);
+
+  m_lastRate = rate;
+  m_rateStamp = now;
+  m_rateBytes = 0;
+}
+
+CSegmentedFileReader::Segment *CSegmentedFileReader::GetWork(CSegmentWorker *worker)
+{
+  CSingleLock lock(m_section);
+  for (size_t i = 0; i < m_segments.size() && i < m_active; i++)
+  {
+    Segment *segment = m_segments[i];
+    if (!segment->owner && !segment->failed && segment->filled < segment->data.size())
+    {
+      segment->owner = worker;
+      return segment;
+    }
+  }
+  m_workEvent.Reset();
+  return NULL;
+}
+
+bool CSegmentedFileReader::Deliver(Segment *segment, const char *buffer, unsigned int size)
+{
+  CSingleLock lock(m_section);
+  if (segment->abandoned)
+    return false;
+
+  memcpy(&segment->data[segment->filled], buffer, size);
+  segment->filled += size;
+  m_dataEvent.Set();
+  return true;
+}
+
+void CSegmentedFileReader::Release(Segment *segment, bool failed)
+{
+  CSingleLock lock(m_section);
+  if (segment->abandoned)
+  {
+    delete segment;
+    return;
+  }
+
+  segment->owner = NULL;
+  if (failed && ++segment->retries >= SEGMENT_RETRIES)
+    segment->failed = true;
+
+  // let another worker continue where this one stopped
+  m_workEvent.Set();
+  m_dataEvent.Set();
+}
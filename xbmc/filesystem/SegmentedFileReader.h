@@ -0,0 +1,131 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <deque>
+#include <vector>
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/StdString.h"
+
+namespace XFILE
+{
+  class CSegmentWorker;
+
+  /*!
+   \brief A connection to the file the segments are requested over.
+   */
+  class ISegmentSource
+  {
+  public:
+    virtual ~ISegmentSource() {}
+    virtual bool Open(const CStdString &path) = 0;
+    virtual int64_t Seek(int64_t position) = 0;
+    virtual unsigned int Read(void *buffer, unsigned int size) = 0;
+    virtual void Close() = 0;
+  };
+
+  /*!
+   \brief Reads a remote file over several connections at once.
+
+   The file is split in fixed size segments which are requested as byte ranges
+   by a number of worker threads, each with its own connection. Read() returns
+   the data in order, so the caller sees a plain sequential stream.
+
+   The number of segments in flight starts at two and is adapted to the measured
+   throughput, up to the number of connections given on construction.
+   */
+  class CSegmentedFileReader
+  {
+  public:
+    typedef ISegmentSource *(*SourceFactory)();
+    typedef unsigned int (*Clock)();
+
+    /*! \brief Start reading a file.
+     \param path path of the file.
+     \param length length of the file.
+     \param connections maximum number of connections to use.
+     \param factory creates the connections of the workers, NULL to read the file with CFile.
+     \param clock time in milliseconds the throughput is measured with, NULL for the system clock.
+     */
+    CSegmentedFileReader(const CStdString &path, int64_t length, unsigned int connections, SourceFactory factory = NULL, Clock clock = NULL);
+    ~CSegmentedFileReader();
+
+    /*! \brief Read data at the current position.
+     \param buffer buffer to read the data into.
+     \param size size of the buffer.
+     \param timeout time in milliseconds to wait for data.
+     \return the number of bytes read, 0 if no data arrived in time or at end of file, -1 on error.
+     */
+    int Read(char *buffer, unsigned int size, unsigned int timeout);
+
+    /*! \brief Restart reading at a new position, dropping all pending segments.
+     \param position the position to continue reading at.
+     \return the new position, or -1 if it's out of range.
+     */
+    int64_t Seek(int64_t position);
+
+    bool IsEOF() const { return m_position >= m_length; }
+    int64_t GetPosition() const { return m_position; }
+    unsigned int GetActiveSegments() const { return m_active; }
+
+  private:
+    friend class CSegmentWorker;
+
+    struct Segment
+    {
+      int64_t start;
+      std::vector<char> data;
+      unsigned int filled;
+      unsigned int consumed;
+      unsigned int retries;
+      CSegmentWorker *owner;
+      bool abandoned;
+      bool failed;
+    };
+
+    // called by the workers
+    Segment *GetWork(CSegmentWorker *worker);
+    bool Deliver(Segment *segment, const char *buffer, unsigned int size);
+    void Release(Segment *segment, bool failed);
+
+    void QueueSegments();
+    void AdaptConnections(unsigned int bytes);
+
+    CStdString m_path;
+    SourceFactory m_factory;
+    Clock m_clock;
+    int64_t m_length;
+    int64_t m_position;
+    int64_t m_queued;       // end of the last queued segment
+    unsigned int m_active;  // number of segments in flight
+    unsigned int m_maxActive;
+
+    unsigned int m_rateStamp;
+    int64_t m_rateBytes;
+    unsigned int m_lastRate;
+
+    std::deque<Segment*> m_segments;
+    std::vector<CSegmentWorker*> m_workers;
+    CCriticalSection m_section;
+    CEvent m_dataEvent;
+    CEvent m_workEvent;
+  };
+}
@@ -23,8 +23,11 @@
 #include "utils/URIUtils.h"
 
 #include <sys/stat.h>
+#include <algorithm>
 
 #define ZIP_CACHE_LIMIT 4*1024*1024
+#define ZIP_SEEK_SPAN   256*1024  // distance between seek points in uncompressed data
+#define ZIP_WINDOW_SIZE 32768     // size of the deflate window
 
 using namespace XFILE;
 using namespace std;
@@ -36,6 +39,8 @@ CZipFile::CZipFile()
   m_iDataInStringBuffer = 0;
   m_bCached = false;
   m_iRead = -1;
+  m_bSeekIndexOwner = false;
+  m_iWindowPos = 0;
 }
 
 CZipFile::~CZipFile()
@@ -83,7 +88,24 @@ bool CZipFile::Open(const CURL&url)
     return false;
   }
   mFile.Seek(mZipItem.offset,SEEK_SET);
-  return InitDecompress();
+  if (!InitDecompress())
+    return false;
+
+  // seeking backwards in deflated data means inflating from the start of the entry,
+  // so larger entries get a seek index, recorded during the first sequential read
+  if (mZipItem.method == 8 && mZipItem.usize > 2 * ZIP_SEEK_SPAN)
+  {
+    m_strPath = strPath;
+    m_seekIndex = g_ZipManager.GetSeekIndex(m_strPath, mZipItem);
+    if (!m_seekIndex || !m_seekIndex->complete)
+    {
+      m_seekIndex.reset(new SZipSeekIndex(mZipItem));
+      m_bSeekIndexOwner = true;
+      m_window.resize(ZIP_WINDOW_SIZE);
+      m_iWindowPos = 0;
+    }
+  }
+  return true;
 }
 
 bool CZipFile::InitDecompress()
@@ -175,6 +197,16 @@ int64_t CZipFile::Seek(int64_t iFilePosition, int iWhence)
         return m_iFilePos; // mp3reader does this lots-of-times
       if (iFilePosition > mZipItem.usize || iFilePosition < 0)
         return -1;
+      // restart from the closest seek point, if that saves us inflating data
+      {
+        const SZipSeekPoint* point = FindSeekPoint(iFilePosition);
+        if (point && (iFilePosition < m_iFilePos || point->uoffset > m_iFilePos))
+        {
+          if (!SeekToPoint(*point))
+            return -1;
+          return Seek(iFilePosition-m_iFilePos,SEEK_CUR);
+        }
+      }
       // read until position in 128k blocks.. only way to do it due to format.
       // can't start in the middle of data since then we'd have no clue where
       // we are in uncompressed data..
@@ -206,6 +238,11 @@ int64_t CZipFile::Seek(int64_t iFilePosition, int iWhence)
       // read until requested position, drop data
       if (m_iFilePos+iFilePosition > mZipItem.usize)
         return -1;
+      {
+        const SZipSeekPoint* point = FindSeekPoint(m_iFilePos+iFilePosition);
+        if (point && point->uoffset > m_iFilePos)
+          return Seek(m_iFilePos+iFilePosition,SEEK_SET);
+      }
       iFilePosition += m_iFilePos;
       while (m_iFilePos < iFilePosition)
       {
@@ -218,15 +255,7 @@ int64_t CZipFile::Seek(int64_t iFilePosition, int iWhence)
 
     case SEEK_END:
       // now this is a nasty bastard, possibly takes lotsoftime
-      // uncompress, minding m_ZStream.total_out
-
-      while( (int)m_ZStream.total_out < mZipItem.usize+iFilePosition)
-      {
-        unsigned int iToRead = (mZipItem.usize+iFilePosition-m_ZStream.total_out > 131072)?131072:(int)(mZipItem.usize+iFilePosition-m_ZStream.total_out);
-        if (Read(temp,iToRead) != iToRead)
-          return -1;
-      }
-      return m_iFilePos;
+      return Seek(mZipItem.usize+iFilePosition,SEEK_SET);
       break;
     default:
       return -1;
@@ -300,13 +329,13 @@ unsigned int CZipFile::Read(void* lpBuf, int64_t uiBufSize)
   {
     uLong iDecompressed = 0;
     uLong prevOut = m_ZStream.total_out;
-    while (((int)iDecompressed < uiBufSize) && ((m_iZipFilePos < mZipItem.csize) || (m_bFlush)))
+    while (((int)iDecompressed < uiBufSize) && ((m_iZipFilePos < mZipItem.csize) || (m_bFlush) || (m_ZStream.avail_in)))
     {
       m_ZStream.next_out = (Bytef*)(lpBuf)+iDecompressed;
       m_ZStream.avail_out = static_cast<uInt>(uiBufSize-iDecompressed);
       if (m_bFlush) // need to flush buffer !
       {
-        int iMessage = inflate(&m_ZStream,Z_SYNC_FLUSH);
+        int iMessage = Inflate(Z_SYNC_FLUSH);
         m_bFlush = ((iMessage == Z_OK) && (m_ZStream.avail_out == 0))?true:false;
         if (!m_ZStream.avail_out) // flush filled buffer, get out of here
         {
@@ -324,13 +353,19 @@ unsigned int CZipFile::Read(void* lpBuf, int64_t uiBufSize)
         }
       }
 
-      int iMessage = inflate(&m_ZStream,Z_SYNC_FLUSH);
+      int iMessage = Inflate(Z_SYNC_FLUSH);
       if (iMessage < 0)
       {
         Close();
         return 0; // READ ERROR
       }
 
+      if (iMessage == Z_STREAM_END) // whatever is left in the input buffer isn't ours
+      {
+        iDecompressed = m_ZStream.total_out-prevOut;
+        break;
+      }
+
       m_bFlush = ((iMessage == Z_OK) && (m_ZStream.avail_out == 0))?true:false; // more info in input buffer
 
       iDecompressed = m_ZStream.total_out-prevOut;
@@ -360,6 +395,11 @@ void CZipFile::Close()
   if (mZipItem.method == 8 && !m_bCached && m_iRead != -1)
     inflateEnd(&m_ZStream);
 
+  if (m_bSeekIndexOwner)
+    g_ZipManager.SetSeekIndex(m_strPath, m_seekIndex);
+  m_seekIndex.reset();
+  m_bSeekIndexOwner = false;
+
   mFile.Close();
 }
 /* CHANGED: JM - moved to CFile
@@ -450,6 +490,108 @@ bool CZipFile::FillBuffer()
   return true;
 }
 
+int CZipFile::Inflate(int flush)
+{
+  if (!m_bSeekIndexOwner)
+    return inflate(&m_ZStream,flush);
+
+  // stop at block boundaries, as that is where seek points can be placed
+  Bytef* start = m_ZStream.next_out;
+  int iMessage = inflate(&m_ZStream,Z_BLOCK);
+  if (iMessage < 0)
+    return iMessage;
+
+  RecordWindow(start, static_cast<unsigned int>(m_ZStream.next_out-start));
+  if (iMessage == Z_STREAM_END)
+    m_seekIndex->complete = true;
+  else if ((m_ZStream.data_type & 128) && !(m_ZStream.data_type & 64))
+    AddSeekPoint();
+  return iMessage;
+}
+
+void CZipFile::RecordWindow(const Bytef* data, unsigned int size)
+{
+  if (size >= ZIP_WINDOW_SIZE)
+  {
+    memcpy(&m_window[0], data+size-ZIP_WINDOW_SIZE, ZIP_WINDOW_SIZE);
+    m_iWindowPos = 0;
+    return;
+  }
+
+  unsigned int iFirst = std::min(size, ZIP_WINDOW_SIZE-m_iWindowPos);
+  memcpy(&m_window[m_iWindowPos], data, iFirst);
+  memcpy(&m_window[0], data+iFirst, size-iFirst);
+  m_iWindowPos = (m_iWindowPos+size) % ZIP_WINDOW_SIZE;
+}
+
+void CZipFile::AddSeekPoint()
+{
+  int64_t uoffset = m_ZStream.total_out;
+  int64_t last = m_seekIndex->points.empty() ? 0 : m_seekIndex->points.back().uoffset;
+  if (uoffset-last < ZIP_SEEK_SPAN)
+    return;
+
+  m_seekIndex->points.push_back(SZipSeekPoint());
+  SZipSeekPoint& point = m_seekIndex->points.back();
+  point.uoffset = uoffset;
+  point.coffset = m_iZipFilePos-m_ZStream.avail_in;
+  point.bits = m_ZStream.data_type & 7;
+
+  // unwrap the last 32k of uncompressed data
+  point.window.resize(ZIP_WINDOW_SIZE);
+  memcpy(&point.window[0], &m_window[m_iWindowPos], ZIP_WINDOW_SIZE-m_iWindowPos);
+  memcpy(&point.window[ZIP_WINDOW_SIZE-m_iWindowPos], &m_window[0], m_iWindowPos);
+}
+
+const SZipSeekPoint* CZipFile::FindSeekPoint(int64_t iFilePosition) const
+{
+  if (!m_seekIndex)
+    return NULL;
+
+  const std::vector<SZipSeekPoint>& points = m_seekIndex->points;
+  for (std::vector<SZipSeekPoint>::const_reverse_iterator it = points.rbegin(); it != points.rend(); ++it)
+  {
+    if (it->uoffset <= iFilePosition)
+      return &(*it);
+  }
+  return NULL;
+}
+
+bool CZipFile::SeekToPoint(const SZipSeekPoint& point)
+{
+  inflateEnd(&m_ZStream);
+  if (inflateInit2(&m_ZStream,-MAX_WBITS) != Z_OK)
+    return false;
+
+  // a point may start in the middle of a byte, in which case we need the byte before
+  int64_t iZipFilePos = point.coffset - (point.bits ? 1 : 0);
+  if (mFile.Seek(mZipItem.offset+iZipFilePos,SEEK_SET) < 0)
+    return false;
+  m_iZipFilePos = iZipFilePos;
+  m_ZStream.next_in = (Bytef*)m_szBuffer;
+  m_ZStream.avail_in = 0;
+  m_bFlush = false;
+
+  if (point.bits)
+  {
+    if (!FillBuffer())
+      return false;
+    int iByte = *m_ZStream.next_in;
+    m_ZStream.next_in++;
+    m_ZStream.avail_in--;
+    inflatePrime(&m_ZStream, point.bits, iByte >> (8-point.bits));
+  }
+  inflateSetDictionary(&m_ZStream, &point.window[0], static_cast<uInt>(point.window.size()));
+
+  m_ZStream.total_out = static_cast<uLong>(point.uoffset);
+  m_iFilePos = point.uoffset;
+
+  // the window has to stay valid when recording continues from here
+  if (m_bSeekIndexOwner)
+    RecordWindow(&point.window[0], static_cast<unsigned int>(point.window.size()));
+  return true;
+}
+
 void CZipFile::DestroyBuffer(void* lpBuffer, int iBufSize)
 {
   if (!m_bFlush)
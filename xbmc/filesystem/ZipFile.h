@@ -50,6 +50,11 @@ namespace XFILE
     bool InitDecompress();
     bool FillBuffer();
     void DestroyBuffer(void* lpBuffer, int iBufSize);
+    int Inflate(int flush);
+    void RecordWindow(const Bytef* data, unsigned int size);
+    void AddSeekPoint();
+    const SZipSeekPoint* FindSeekPoint(int64_t iFilePosition) const;
+    bool SeekToPoint(const SZipSeekPoint& point);
     CFile mFile;
     SZipEntry mZipItem;
     int64_t m_iFilePos; // position in _uncompressed_ data read
@@ -63,6 +68,11 @@ namespace XFILE
     int m_iRead;
     bool m_bFlush;
     bool m_bCached;
+    CStdString m_strPath;           // path of the entry, used to share its seek index
+    ZipSeekIndexPtr m_seekIndex;
+    bool m_bSeekIndexOwner;         // true if we're recording m_seekIndex
+    std::vector<unsigned char> m_window; // last 32k of uncompressed data while recording
+    unsigned int m_iWindowPos;
   };
 }
 
@@ -27,17 +27,23 @@
 #include "utils/EndianSwap.h"
 #include "utils/URIUtils.h"
 #include "SpecialProtocol.h"
+#include "threads/SingleLock.h"
 
 
 #ifndef min
 #define min(a,b)            (((a) < (b)) ? (a) : (b))
 #endif
 
+#define ZIP_SEEK_INDEX_LIMIT 32
+#define ZIP_SEEK_INDEX_BYTES (8*1024*1024) // total size of the windows of the kept indexes
+
 using namespace XFILE;
 using namespace std;
 
 CZipManager::CZipManager()
 {
+  mSeekIndexBytes = 0;
+  mSeekIndexUse = 0;
 }
 
 CZipManager::~CZipManager()
@@ -324,6 +330,89 @@ void CZipManager::release(const CStdString& strPath)
     mZipMap.erase(it);
     mZipDate.erase(it2);
   }
+
+  CSingleLock lock(mSeekIndexSection);
+  for (map<CStdString,ZipSeekIndexPtr>::iterator it3 = mSeekIndexMap.begin(); it3 != mSeekIndexMap.end(); )
+  {
+    if (CURL(it3->first).GetHostName() == url.GetHostName())
+      EraseSeekIndex(it3++);
+    else
+      ++it3;
+  }
 }
 
+ZipSeekIndexPtr CZipManager::GetSeekIndex(const CStdString& strPath, const SZipEntry& item)
+{
+  CSingleLock lock(mSeekIndexSection);
+  map<CStdString,ZipSeekIndexPtr>::iterator it = mSeekIndexMap.find(strPath);
+  if (it == mSeekIndexMap.end())
+    return ZipSeekIndexPtr();
 
+  // the zip has been changed since the index was recorded
+  if (it->second->offset != item.offset || it->second->csize != item.csize || it->second->crc32 != item.crc32)
+  {
+    EraseSeekIndex(it);
+    return ZipSeekIndexPtr();
+  }
+  it->second->lastUsed = ++mSeekIndexUse;
+  return it->second;
+}
+
+void CZipManager::SetSeekIndex(const CStdString& strPath, const ZipSeekIndexPtr& index)
+{
+  if (!index || index->points.empty())
+    return;
+
+  CSingleLock lock(mSeekIndexSection);
+  map<CStdString,ZipSeekIndexPtr>::iterator it = mSeekIndexMap.find(strPath);
+  if (it != mSeekIndexMap.end())
+  {
+    // keep whichever index covers more of the entry
+    if (it->second->complete || it->second->points.size() >= index->points.size())
+      return;
+    EraseSeekIndex(it);
+  }
+
+  // an index of a huge entry on its own keeps fewer, wider spaced points
+  size_t size = GetSeekIndexSize(*index);
+  if (size > ZIP_SEEK_INDEX_BYTES)
+  {
+    size_t step = (size + ZIP_SEEK_INDEX_BYTES - 1) / ZIP_SEEK_INDEX_BYTES;
+    vector<SZipSeekPoint> points;
+    for (size_t i = step - 1; i < index->points.size(); i += step)
+      points.push_back(index->points[i]);
+    index->points.swap(points);
+    size = GetSeekIndexSize(*index);
+  }
+
+  // the windows make indexes rather large, so only keep a limited number and size around
+  while (!mSeekIndexMap.empty() &&
+         (mSeekIndexMap.size() >= ZIP_SEEK_INDEX_LIMIT || mSeekIndexBytes + size > ZIP_SEEK_INDEX_BYTES))
+  {
+    map<CStdString,ZipSeekIndexPtr>::iterator oldest = mSeekIndexMap.begin();
+    for (it = mSeekIndexMap.begin(); it != mSeekIndexMap.end(); ++it)
+    {
+      if (it->second->lastUsed < oldest->second->lastUsed)
+        oldest = it;
+    }
+    EraseSeekIndex(oldest);
+  }
+
+  index->lastUsed = ++mSeekIndexUse;
+  mSeekIndexMap.insert(make_pair(strPath, index));
+  mSeekIndexBytes += size;
+}
+
+void CZipManager::EraseSeekIndex(map<CStdString,ZipSeekIndexPtr>::iterator it)
+{
+  mSeekIndexBytes -= GetSeekIndexSize(*it->second);
+  mSeekIndexMap.erase(it);
+}
+
+size_t CZipManager::GetSeekIndexSize(const SZipSeekIndex& index)
+{
+  size_t size = 0;
+  for (vector<SZipSeekPoint>::const_iterator it = index.points.begin(); it != index.points.end(); ++it)
+    size += it->window.size();
+  return size;
+}
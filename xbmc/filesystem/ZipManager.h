@@ -30,10 +30,12 @@
 #define ECDREC_SIZE 22
 
 #include  "utils/StdString.h"
+#include "threads/CriticalSection.h"
 
 #include <memory.h>
 #include <vector>
 #include <map>
+#include <boost/shared_ptr.hpp>
 
 struct SZipEntry {
   unsigned int header;
@@ -94,6 +96,28 @@ struct SZipEntry {
   }
 };
 
+// A position in a deflated entry from which inflating can be restarted
+struct SZipSeekPoint {
+  int64_t uoffset; // offset in uncompressed data
+  int64_t coffset; // offset in compressed data of the first complete byte
+  int bits;        // bits of the byte before coffset that belong to the point
+  std::vector<unsigned char> window; // uncompressed data preceding the point
+};
+
+// Seek points of a deflated entry, recorded while it is read sequentially
+struct SZipSeekIndex {
+  SZipSeekIndex(const SZipEntry& entry) : offset(entry.offset), csize(entry.csize), crc32(entry.crc32), complete(false), lastUsed(0) {}
+
+  int64_t offset;
+  unsigned int csize;
+  unsigned int crc32;
+  bool complete; // true if the whole entry has been read
+  std::vector<SZipSeekPoint> points;
+  unsigned int lastUsed; // set by CZipManager to evict the least recently used indexes
+};
+
+typedef boost::shared_ptr<SZipSeekIndex> ZipSeekIndexPtr;
+
 class CZipManager
 {
 public:
@@ -105,11 +129,20 @@ public:
   bool ExtractArchive(const CStdString& strArchive, const CStdString& strPath);
   void CleanUp(const CStdString& strArchive, const CStdString& strPath); // deletes extracted archive. use with care!
   void release(const CStdString& strPath); // release resources used by list zip
+  ZipSeekIndexPtr GetSeekIndex(const CStdString& strPath, const SZipEntry& item);
+  void SetSeekIndex(const CStdString& strPath, const ZipSeekIndexPtr& index);
   static void readHeader(const char* buffer, SZipEntry& info);
   static void readCHeader(const char* buffer, SZipEntry& info);
 private:
   std::map<CStdString,std::vector<SZipEntry> > mZipMap;
   std::map<CStdString,int64_t> mZipDate;
+  void EraseSeekIndex(std::map<CStdString,ZipSeekIndexPtr>::iterator it);
+  static size_t GetSeekIndexSize(const SZipSeekIndex& index);
+
+  std::map<CStdString,ZipSeekIndexPtr> mSeekIndexMap;
+  size_t mSeekIndexBytes; // size of the windows of all indexes
+  unsigned int mSeekIndexUse;
+  CCriticalSection mSeekIndexSection;
 };
 
 extern CZipManager g_ZipManager;
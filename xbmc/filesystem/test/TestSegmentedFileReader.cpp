@@ -0,0 +1,230 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/SegmentedFileReader.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+// the segment size used by CSegmentedFileReader
+static const int64_t segmentSize = 4 * 1024 * 1024;
+
+// state shared by the connections of CFakeSegmentSource
+static CCriticalSection sourceSection;
+static std::vector<int64_t> requests;  // positions the connections were asked for
+static std::vector<int64_t> completed; // starts of the segments fully read, in the order they were read
+static int64_t slowStart, slowEnd;     // data in this range is read slowly
+static unsigned int slowDelay, delay;  // milliseconds a read takes
+static int64_t failAt;                 // position a read fails at once, -1 if none
+
+static char GetByte(int64_t position)
+{
+  return (char)(position % 251);
+}
+
+class CFakeSegmentSource : public ISegmentSource
+{
+public:
+  CFakeSegmentSource() : m_position(0) {}
+
+  virtual bool Open(const CStdString &path) { return true; }
+
+  virtual int64_t Seek(int64_t position)
+  {
+    CSingleLock lock(sourceSection);
+    requests.push_back(position);
+    m_position = position;
+    return position;
+  }
+
+  virtual unsigned int Read(void *buffer, unsigned int size)
+  {
+    bool slow = m_position >= slowStart && m_position < slowEnd;
+    if (slow ? slowDelay : delay)
+      XbmcThreads::ThreadSleep(slow ? slowDelay : delay);
+
+    CSingleLock lock(sourceSection);
+    if (m_position == failAt)
+    {
+      failAt = -1;
+      return 0;
+    }
+
+    char *data = (char *)buffer;
+    for (unsigned int i = 0; i < size; i++)
+      data[i] = GetByte(m_position + i);
+    m_position += size;
+    if (m_position % segmentSize == 0)
+      completed.push_back(m_position - segmentSize);
+    return size;
+  }
+
+  virtual void Close() {}
+
+private:
+  int64_t m_position;
+};
+
+// time the throughput is measured with, advanced by the test as it reads
+static unsigned int fakeTime;
+
+static unsigned int FakeClock()
+{
+  return fakeTime;
+}
+
+static ISegmentSource *CreateFakeSource()
+{
+  return new CFakeSegmentSource;
+}
+
+class TestSegmentedFileReader : public testing::Test
+{
+protected:
+  TestSegmentedFileReader()
+  {
+    requests.clear();
+    completed.clear();
+    slowStart = slowEnd = 0;
+    slowDelay = delay = 0;
+    failAt = -1;
+  }
+
+  // read the rest of the file, checking its content and keeping the most segments in flight
+  static bool ReadToEnd(CSegmentedFileReader &reader, int64_t length, unsigned int &maxActive)
+  {
+    std::vector<char> buffer(100000);
+    unsigned int idle = 0;
+    maxActive = reader.GetActiveSegments();
+    while (!reader.IsEOF())
+    {
+      int64_t position = reader.GetPosition();
+      int read = reader.Read(&buffer[0], buffer.size(), 100);
+      if (read < 0)
+        return false;
+      // data arrived for a later segment, or nothing did in time
+      if (read == 0)
+      {
+        if (++idle > 100)
+          return false;
+        continue;
+      }
+      idle = 0;
+      for (int i = 0; i < read; i++)
+      {
+        if (buffer[i] != GetByte(position + i))
+          return false;
+      }
+      maxActive = std::max(maxActive, reader.GetActiveSegments());
+    }
+    return reader.GetPosition() == length;
+  }
+};
+
+TEST_F(TestSegmentedFileReader, Segments)
+{
+  unsigned int maxActive;
+  int64_t length = 2 * segmentSize + 1000;
+  CSegmentedFileReader reader("http://example.com/file", length, 4, CreateFakeSource);
+  EXPECT_EQ(2U, reader.GetActiveSegments());
+  EXPECT_TRUE(ReadToEnd(reader, length, maxActive));
+
+  std::vector<int64_t> expected;
+  expected.push_back(0);
+  expected.push_back(segmentSize);
+  expected.push_back(2 * segmentSize);
+  CSingleLock lock(sourceSection);
+  std::sort(requests.begin(), requests.end());
+  EXPECT_EQ(expected, requests);
+
+  // the segments continue at the position sought to
+  requests.clear();
+  lock.Leave();
+  EXPECT_EQ(segmentSize + 1, reader.Seek(segmentSize + 1));
+  EXPECT_TRUE(ReadToEnd(reader, length, maxActive));
+
+  expected.clear();
+  expected.push_back(segmentSize + 1);
+  expected.push_back(2 * segmentSize + 1);
+  lock.Enter();
+  std::sort(requests.begin(), requests.end());
+  EXPECT_EQ(expected, requests);
+  lock.Leave();
+
+  EXPECT_EQ(-1, reader.Seek(length + 1));
+}
+
+TEST_F(TestSegmentedFileReader, InOrder)
+{
+  unsigned int maxActive;
+  int64_t length = 2 * segmentSize;
+  slowStart = 0;
+  slowEnd = segmentSize;
+  slowDelay = 5;
+  failAt = segmentSize + segmentSize / 2;
+
+  // the second segment arrives first and is retried where it failed, but is returned after the first
+  CSegmentedFileReader reader("http://example.com/file", length, 2, CreateFakeSource);
+  EXPECT_TRUE(ReadToEnd(reader, length, maxActive));
+
+  CSingleLock lock(sourceSection);
+  ASSERT_EQ(2U, completed.size());
+  EXPECT_EQ(segmentSize, completed[0]);
+  EXPECT_EQ(0, completed[1]);
+  EXPECT_TRUE(std::find(requests.begin(), requests.end(), segmentSize + segmentSize / 2) != requests.end());
+}
+
+TEST_F(TestSegmentedFileReader, AdaptSegments)
+{
+  int64_t length = 6 * segmentSize;
+
+  // more segments are requested while the throughput rises, fewer once it drops
+  fakeTime = 0;
+  CSegmentedFileReader reader("http://example.com/file", length, 3, CreateFakeSource, FakeClock);
+  EXPECT_EQ(2U, reader.GetActiveSegments());
+
+  std::vector<char> buffer(100000);
+  unsigned int idle = 0;
+  unsigned int maxActive = reader.GetActiveSegments();
+  while (!reader.IsEOF())
+  {
+    int64_t position = reader.GetPosition();
+    int read = reader.Read(&buffer[0], buffer.size(), 100);
+    ASSERT_GE(read, 0);
+    if (read == 0)
+    {
+      ASSERT_LT(++idle, 100U);
+      continue;
+    }
+    idle = 0;
+
+    // each connection moves 1 MB/s, until the server limits the file to 512 kB/s from the fifth segment on
+    int64_t rate = position >= 4 * segmentSize ? 512 * 1024 : reader.GetActiveSegments() * 1024 * 1024;
+    fakeTime += (unsigned int)(read * 1000 / rate);
+    maxActive = std::max(maxActive, reader.GetActiveSegments());
+  }
+  EXPECT_EQ(3U, maxActive);
+  EXPECT_EQ(2U, reader.GetActiveSegments());
+}
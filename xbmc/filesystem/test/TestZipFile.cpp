@@ -20,6 +20,7 @@
 
 #include "filesystem/Directory.h"
 #include "filesystem/File.h"
+#include "filesystem/ZipManager.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 #include "FileItem.h"
@@ -139,6 +140,97 @@ TEST_F(TestZipFile, Stat)
   EXPECT_TRUE(buffer.st_mode | _S_IFREG);
 }
 
+/* The entry in reflargefile.txt.zip is large enough to get a seek index. Each
+ * of its 64 byte lines starts with the 7 digit line number.
+ */
+TEST_F(TestZipFile, SeekLargeEntry)
+{
+  XFILE::CFile file;
+  char buf[64];
+  CStdString reffile, strzippath, strpathinzip;
+  CFileItemList itemlist;
+  const int64_t positions[] = { 600000, 64, 576000, 320000, 639936, 0 };
+
+  reffile = XBMC_REF_FILE_PATH("xbmc/filesystem/test/reflargefile.txt.zip");
+  URIUtils::CreateArchivePath(strzippath, "zip", reffile, "");
+  ASSERT_TRUE(XFILE::CDirectory::GetDirectory(strzippath, itemlist, "",
+    XFILE::DIR_FLAG_NO_FILE_DIRS));
+  strpathinzip = itemlist[0]->GetPath();
+
+  // the first open records the seek index while reading sequentially
+  for (int pass = 0; pass < 2; pass++)
+  {
+    ASSERT_TRUE(file.Open(strpathinzip));
+    EXPECT_EQ(640000, file.GetLength());
+    if (pass == 0)
+    {
+      while (file.Read(buf, sizeof(buf)) > 0)
+        ;
+      EXPECT_EQ(640000, file.GetPosition());
+    }
+    for (unsigned int i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+    {
+      EXPECT_EQ(positions[i], file.Seek(positions[i], SEEK_SET));
+      EXPECT_EQ(sizeof(buf), file.Read(buf, sizeof(buf)));
+      EXPECT_EQ(StringUtils::Format("%07d", (int)(positions[i] / 64)),
+                std::string(buf, 7));
+      EXPECT_EQ('\n', buf[63]);
+    }
+    EXPECT_EQ(639936, file.Seek(-64, SEEK_END));
+    file.Close();
+  }
+}
+
+static ZipSeekIndexPtr CreateSeekIndex(const SZipEntry& entry, unsigned int points)
+{
+  ZipSeekIndexPtr index(new SZipSeekIndex(entry));
+  index->points.resize(points);
+  for (unsigned int i = 0; i < points; i++)
+  {
+    index->points[i].uoffset = (i + 1) * 256 * 1024;
+    index->points[i].window.resize(32 * 1024);
+  }
+  return index;
+}
+
+TEST_F(TestZipFile, SeekIndexEviction)
+{
+  CZipManager manager;
+  SZipEntry entry;
+
+  // the least recently used index is evicted once 32 are kept
+  for (int i = 0; i < 32; i++)
+    manager.SetSeekIndex(StringUtils::Format("zip://archive/%02d", i), CreateSeekIndex(entry, 2));
+  EXPECT_TRUE(manager.GetSeekIndex("zip://archive/00", entry));
+  manager.SetSeekIndex("zip://archive/32", CreateSeekIndex(entry, 2));
+  EXPECT_TRUE(manager.GetSeekIndex("zip://archive/00", entry));
+  EXPECT_FALSE(manager.GetSeekIndex("zip://archive/01", entry));
+  EXPECT_TRUE(manager.GetSeekIndex("zip://archive/02", entry));
+  EXPECT_TRUE(manager.GetSeekIndex("zip://archive/32", entry));
+}
+
+TEST_F(TestZipFile, SeekIndexSize)
+{
+  CZipManager manager;
+  SZipEntry entry;
+
+  // the windows of all indexes are kept below 8MB, an index too large on its own is thinned
+  manager.SetSeekIndex("zip://archive/first", CreateSeekIndex(entry, 100));
+  manager.SetSeekIndex("zip://archive/large", CreateSeekIndex(entry, 400));
+  ZipSeekIndexPtr large = manager.GetSeekIndex("zip://archive/large", entry);
+  ASSERT_TRUE(large);
+  EXPECT_EQ(200U, large->points.size());
+  EXPECT_EQ(2 * 256 * 1024, large->points[0].uoffset);
+  EXPECT_FALSE(manager.GetSeekIndex("zip://archive/first", entry));
+
+  manager.SetSeekIndex("zip://archive/small", CreateSeekIndex(entry, 2));
+  EXPECT_TRUE(manager.GetSeekIndex("zip://archive/small", entry));
+  manager.SetSeekIndex("zip://archive/second", CreateSeekIndex(entry, 100));
+  EXPECT_FALSE(manager.GetSeekIndex("zip://archive/large", entry));
+  EXPECT_TRUE(manager.GetSeekIndex("zip://archive/small", entry));
+  EXPECT_TRUE(manager.GetSeekIndex("zip://archive/second", entry));
+}
+
 /* Test case to test for graceful handling of corrupted input.
  * NOTE: The test case is considered a "success" as long as the corrupted
  * file was successfully generated and the test case runs without a segfault.
@@ -40,8 +40,8 @@ using namespace std;
 
 extern bool g_fullScreen;
 
-/* quick access to a skin setting, fine unless we starts clearing video settings */
-static CSettingInt* g_guiSkinzoom = NULL;
+/* quick access to a skin setting */
+static const CSettingHandle g_guiSkinzoom("lookandfeel.skinzoom");
 
 CGraphicContext::CGraphicContext(void) :
   m_iScreenHeight(576),
@@ -749,12 +749,8 @@ void CGraphicContext::GetGUIScaling(const RESOLUTION_INFO &res, float &scaleX, f
     float fToWidth    = (float)info.Overscan.right  - fToPosX;
     float fToHeight   = (float)info.Overscan.bottom - fToPosY;
 
-    if(!g_guiSkinzoom) // lookup gui setting if we didn't have it already
-      g_guiSkinzoom = (CSettingInt*)CSettings::Get().GetSetting("lookandfeel.skinzoom");
-
     float fZoom = 1.0f;
-    if(g_guiSkinzoom)
-      fZoom *= (100 + g_guiSkinzoom->GetValue()) * 0.01f;
+    fZoom *= (100 + CSettings::Get().GetInt(g_guiSkinzoom)) * 0.01f;
 
     fZoom -= 1.0f;
     fToPosX -= fToWidth * fZoom * 0.5f;
@@ -223,23 +223,34 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
     end = items.Size();
   }
 
+  std::set<std::string> fields;
+  if (parameterObject.isMember("properties") && parameterObject["properties"].isArray())
+  {
+    for (CVariant::const_iterator_array field = parameterObject["properties"].begin_array(); field != parameterObject["properties"].end_array(); field++)
+      fields.insert(field->asString());
+  }
+
   CThumbLoader *thumbLoader = NULL;
   if (end - start > 0)
   {
+    CVideoThumbLoader *videoThumbLoader = NULL;
     if (items.Get(start)->HasVideoInfoTag())
-      thumbLoader = new CVideoThumbLoader();
+      thumbLoader = videoThumbLoader = new CVideoThumbLoader();
     else if (items.Get(start)->HasMusicInfoTag())
       thumbLoader = new CMusicThumbLoader();
 
     if (thumbLoader != NULL)
       thumbLoader->OnLoaderStart();
-  }
 
-  std::set<std::string> fields;
-  if (parameterObject.isMember("properties") && parameterObject["properties"].isArray())
-  {
-    for (CVariant::const_iterator_array field = parameterObject["properties"].begin_array(); field != parameterObject["properties"].end_array(); field++)
-      fields.insert(field->asString());
+    // fetch the art of all the returned items at once instead of item by item
+    if (videoThumbLoader != NULL &&
+       (fields.find("art") != fields.end() || fields.find("thumbnail") != fields.end() || fields.find("fanart") != fields.end()))
+    {
+      std::vector<CFileItemPtr> prefetch;
+      for (int i = start; i < end; i++)
+        prefetch.push_back(items.Get(i));
+      videoThumbLoader->PrefetchLibraryInfo(prefetch, false);
+    }
   }
 
   for (int i = start; i < end; i++)
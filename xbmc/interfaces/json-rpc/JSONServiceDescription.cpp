@@ -230,7 +230,9 @@ JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
 
 // XBMC operations
   { "XBMC.GetInfoLabels",                           CXBMCOperations::GetInfoLabels },
-  { "XBMC.GetInfoBooleans",                         CXBMCOperations::GetInfoBooleans }
+  { "XBMC.GetInfoBooleans",                         CXBMCOperations::GetInfoBooleans },
+  { "XBMC.GetWebserverStatistics",                  CXBMCOperations::GetWebserverStatistics },
+  { "XBMC.GetVideoClockStatistics",                 CXBMCOperations::GetVideoClockStatistics }
 };
 
 JSONSchemaTypeDefinition::JSONSchemaTypeDefinition()
@@ -567,6 +569,8 @@ bool JSONSchemaTypeDefinition::Parse(const CVariant &value, bool isParameter /*
       if (approved)
         enums.push_back(*enumItr);
     }
+
+    UpdateStringEnums();
   }
 
   if (type != ObjectValue)
@@ -617,9 +621,24 @@ bool JSONSchemaTypeDefinition::Parse(const CVariant &value, bool isParameter /*
 
 JSONRPC_STATUS JSONSchemaTypeDefinition::Check(const CVariant &value, CVariant &outputValue, CVariant &errorData)
 {
-  if (!name.empty())
-    errorData["name"] = name;
-  SchemaValueTypeToJson(type, errorData["type"]);
+  JSONRPC_STATUS status = check(value, outputValue, errorData);
+
+  // only describe the type in the error data if the check failed
+  // (and a more specific type hasn't already been described) so that
+  // well-formed requests don't have to pay for it
+  if (status != OK)
+  {
+    if (!name.empty() && !errorData.isMember("name"))
+      errorData["name"] = name;
+    if (!errorData.isMember("type"))
+      SchemaValueTypeToJson(type, errorData["type"]);
+  }
+
+  return status;
+}
+
+JSONRPC_STATUS JSONSchemaTypeDefinition::check(const CVariant &value, CVariant &outputValue, CVariant &errorData)
+{
   CStdString errorMessage;
 
   if (referencedType != NULL && !referencedTypeSet)
@@ -886,12 +905,18 @@ JSONRPC_STATUS JSONSchemaTypeDefinition::Check(const CVariant &value, CVariant &
   if (enums.size() > 0)
   {
     bool valid = false;
-    for (std::vector<CVariant>::const_iterator enumItr = enums.begin(); enumItr != enums.end(); ++enumItr)
+    // string enums (the most common case) can be looked up directly
+    if (!stringEnums.empty())
+      valid = value.isString() && stringEnums.find(value.asString()) != stringEnums.end();
+    else
     {
-      if (*enumItr == value)
+      for (std::vector<CVariant>::const_iterator enumItr = enums.begin(); enumItr != enums.end(); ++enumItr)
       {
-        valid = true;
-        break;
+        if (*enumItr == value)
+        {
+          valid = true;
+          break;
+        }
       }
     }
 
@@ -1154,6 +1179,22 @@ void JSONSchemaTypeDefinition::Set(const JSONSchemaTypeDefinitionPtr typeDefinit
   referencedTypeSet = true;
 }
 
+void JSONSchemaTypeDefinition::UpdateStringEnums()
+{
+  stringEnums.clear();
+  for (std::vector<CVariant>::const_iterator enumItr = enums.begin(); enumItr != enums.end(); ++enumItr)
+  {
+    // fall back to comparing every value if there are non-string values
+    if (!enumItr->isString())
+    {
+      stringEnums.clear();
+      return;
+    }
+
+    stringEnums.insert(enumItr->asString());
+  }
+}
+
 JSONSchemaTypeDefinition::CJsonSchemaPropertiesMap::CJsonSchemaPropertiesMap()
 {
   m_propertiesmap = std::map<std::string, JSONSchemaTypeDefinitionPtr>();
@@ -1339,8 +1380,8 @@ JSONRPC_STATUS JsonRpcMethod::checkParameter(const CVariant &requestParameters,
   // Let's check if the parameter has been provided
   if (ParameterExists(requestParameters, type->name, position))
   {
-    // Get the parameter
-    CVariant parameterValue = GetParameter(requestParameters, type->name, position);
+    // Get the parameter (without copying it)
+    const CVariant &parameterValue = IsValueMember(requestParameters, type->name) ? requestParameters[type->name] : requestParameters[position];
 
     // Evaluate the type of the parameter
     JSONRPC_STATUS status = type->Check(parameterValue, outputParameters[type->name], errorData["stack"]);
@@ -1610,6 +1651,7 @@ bool CJSONServiceDescription::AddEnum(const std::string &name, const std::vector
       return false;
   }
   definition->enums.insert(definition->enums.begin(), values.begin(), values.end());
+  definition->UpdateStringEnums();
 
   int schemaType = (int)AnyValue;
   for (unsigned int index = 0; index < types.size(); index++)
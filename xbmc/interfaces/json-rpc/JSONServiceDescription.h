@@ -19,6 +19,7 @@
  *
  */
 
+#include <set>
 #include <string>
 #include <vector>
 #include <limits>
@@ -50,6 +51,7 @@ namespace JSONRPC
     JSONRPC_STATUS Check(const CVariant &value, CVariant &outputValue, CVariant &errorData);
     void Print(bool isParameter, bool isGlobal, bool printDefault, bool printDescriptions, CVariant &output) const;
     void Set(const JSONSchemaTypeDefinitionPtr typeDefinition);
+    void UpdateStringEnums();
     
     std::string missingReference;
 
@@ -157,6 +159,12 @@ namespace JSONRPC
      */
     std::vector<CVariant> enums;
 
+    /*!
+     \brief Lookup set of the allowed values if
+     all of them are strings
+     */
+    std::set<std::string> stringEnums;
+
     /*!
      \brief List of possible values in an array
      */
@@ -221,6 +229,9 @@ namespace JSONRPC
      \brief Type definition for additional properties
      */
     JSONSchemaTypeDefinitionPtr additionalProperties;
+
+  private:
+    JSONRPC_STATUS check(const CVariant &value, CVariant &outputValue, CVariant &errorData);
   };
 
   /*! 
@@ -862,20 +862,31 @@ JSONRPC_STATUS CVideoLibrary::GetAdditionalMovieDetails(const CVariant &paramete
     return InternalError;
 
   bool additionalInfo = false;
+  bool cast = false;
+  bool streamdetails = false;
   for (CVariant::const_iterator_array itr = parameterObject["properties"].begin_array(); itr != parameterObject["properties"].end_array(); itr++)
   {
     CStdString fieldValue = itr->asString();
-    if (fieldValue == "cast" || fieldValue == "showlink" || fieldValue == "tag" || fieldValue == "streamdetails")
+    if (fieldValue == "showlink" || fieldValue == "tag")
       additionalInfo = true;
+    else if (fieldValue == "cast")
+      cast = true;
+    else if (fieldValue == "streamdetails")
+      streamdetails = true;
   }
 
   if (additionalInfo)
   {
     for (int index = 0; index < items.Size(); index++)
-    {
-      if (additionalInfo)
-        videodatabase.GetMovieInfo("", *(items[index]->GetVideoInfoTag()), items[index]->GetVideoInfoTag()->m_iDbId);
-    }
+      videodatabase.GetMovieInfo("", *(items[index]->GetVideoInfoTag()), items[index]->GetVideoInfoTag()->m_iDbId);
+  }
+  else
+  {
+    // the full details aren't needed, so fetch the cast and stream details for all movies at once
+    if (cast)
+      videodatabase.GetCastForItems(items);
+    if (streamdetails)
+      videodatabase.GetStreamDetailsForItems(items);
   }
 
   int size = items.Size();
@@ -891,22 +902,21 @@ JSONRPC_STATUS CVideoLibrary::GetAdditionalEpisodeDetails(const CVariant &parame
   if (!videodatabase.Open())
     return InternalError;
 
-  bool additionalInfo = false;
+  bool cast = false;
+  bool streamdetails = false;
   for (CVariant::const_iterator_array itr = parameterObject["properties"].begin_array(); itr != parameterObject["properties"].end_array(); itr++)
   {
     CStdString fieldValue = itr->asString();
-    if (fieldValue == "cast" || fieldValue == "streamdetails")
-      additionalInfo = true;
+    if (fieldValue == "cast")
+      cast = true;
+    else if (fieldValue == "streamdetails")
+      streamdetails = true;
   }
 
-  if (additionalInfo)
-  {
-    for (int index = 0; index < items.Size(); index++)
-    {
-      if (additionalInfo)
-        videodatabase.GetEpisodeInfo("", *(items[index]->GetVideoInfoTag()), items[index]->GetVideoInfoTag()->m_iDbId);
-    }
-  }
+  if (cast)
+    videodatabase.GetCastForItems(items);
+  if (streamdetails)
+    videodatabase.GetStreamDetailsForItems(items);
   
   int size = items.Size();
   if (!limit && items.HasProperty("total") && items.GetProperty("total").asInteger() > size)
@@ -921,18 +931,23 @@ JSONRPC_STATUS CVideoLibrary::GetAdditionalMusicVideoDetails(const CVariant &par
   if (!videodatabase.Open())
     return InternalError;
 
+  bool additionalInfo = false;
   bool streamdetails = false;
   for (CVariant::const_iterator_array itr = parameterObject["properties"].begin_array(); itr != parameterObject["properties"].end_array(); itr++)
   {
-    if (itr->asString() == "tag" || itr->asString() == "streamdetails")
+    if (itr->asString() == "tag")
+      additionalInfo = true;
+    else if (itr->asString() == "streamdetails")
       streamdetails = true;
   }
 
-  if (streamdetails)
+  if (additionalInfo)
   {
     for (int index = 0; index < items.Size(); index++)
       videodatabase.GetMusicVideoInfo("", *(items[index]->GetVideoInfoTag()), items[index]->GetVideoInfoTag()->m_iDbId);
   }
+  else if (streamdetails)
+    videodatabase.GetStreamDetailsForItems(items);
 
   int size = items.Size();
   if (!limit && items.HasProperty("total") && items.GetProperty("total").asInteger() > size)
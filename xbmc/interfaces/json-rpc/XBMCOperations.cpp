@@ -23,6 +23,10 @@
 #include "Util.h"
 #include "utils/Variant.h"
 #include "powermanagement/PowerManager.h"
+#include "video/VideoReferenceClock.h"
+#ifdef HAS_WEB_SERVER
+#include "network/WebServer.h"
+#endif
 
 using namespace JSONRPC;
 
@@ -92,3 +96,46 @@ JSONRPC_STATUS CXBMCOperations::GetInfoBooleans(const CStdString &method, ITrans
 
   return OK;
 }
+
+JSONRPC_STATUS CXBMCOperations::GetWebserverStatistics(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+#ifdef HAS_WEB_SERVER
+  CWebServer::GetStatistics(result);
+  return OK;
+#else
+  return FailedToExecute;
+#endif
+}
+
+JSONRPC_STATUS CXBMCOperations::GetVideoClockStatistics(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  CVideoReferenceClock::Statistics stats;
+  if (!g_VideoReferenceClock.GetStatistics(stats))
+  {
+    result["running"] = false;
+    return OK;
+  }
+
+  result["running"] = true;
+  result["software"] = stats.software;
+  result["refreshrate"] = stats.refreshRate;
+  result["measuredrefreshrate"] = stats.measuredRefreshRate;
+  result["locked"] = stats.locked;
+  result["missedvblanks"] = stats.missedVblanks;
+  result["unlocks"] = stats.unlocks;
+  result["phaseerror"] = stats.phaseError;
+  result["maximumphaseerror"] = stats.maxPhaseError;
+  result["phasehistogram"] = CVariant(CVariant::VariantTypeArray);
+  for (int i = 0; i < VBLANK_PHASE_BUCKETS; i++)
+  {
+    CVariant bucket(CVariant::VariantTypeObject);
+    bucket["limit"] = i < VBLANK_PHASE_BUCKETS - 1 ? CVblankPLL::PhaseBucketLimits[i] : 0;
+    bucket["count"] = stats.histogram[i];
+    result["phasehistogram"].push_back(bucket);
+  }
+  result["speed"] = stats.speed;
+  result["adjustments"] = stats.adjustments;
+  result["adjustrate"] = stats.adjustRate;
+
+  return OK;
+}
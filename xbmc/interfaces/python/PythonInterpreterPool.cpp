@@ -0,0 +1,253 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if (defined HAVE_CONFIG_H) && (!defined TARGET_WINDOWS)
+  #include "config.h"
+#endif
+
+// python.h should always be included first before any other includes
+#include <Python.h>
+
+#include "system.h"
+#include "PythonInterpreterPool.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+#include <vector>
+
+// the addon invoker uses two flavours of initialization script
+#define POOL_MAX_TEMPLATES  2
+// time to wait before trying again after an interpreter couldn't be prepared
+#define POOL_RETRY_DELAY    5000 // ms
+
+CPythonInterpreterPool::CPythonInterpreterPool()
+  : CThread("PythonInterpreterPool")
+{
+  memset(&m_stats, 0, sizeof(m_stats));
+  m_totalTime = 0;
+}
+
+CPythonInterpreterPool::~CPythonInterpreterPool()
+{
+  // the python engine is gone by now, so leave the interpreters alone
+  StopThread(false);
+  m_wakeEvent.Set();
+  StopThread(true);
+}
+
+CPythonInterpreterPool &CPythonInterpreterPool::Get()
+{
+  static CPythonInterpreterPool sPool;
+  return sPool;
+}
+
+CPythonInterpreterPool::Template *CPythonInterpreterPool::FindTemplate(const ModuleMap &modules, const char *script)
+{
+  for (std::deque<Template>::iterator it = m_templates.begin(); it != m_templates.end(); ++it)
+  {
+    if (it->hasScript != (script != NULL) || (script && it->script != script))
+      continue;
+    if (it->modules == modules)
+      return &(*it);
+  }
+  return NULL;
+}
+
+bool CPythonInterpreterPool::Acquire(const ModuleMap &modules, const char *script, PyThreadState *&state, LanguageHookRef &languageHook)
+{
+  Interpreter interpreter;
+  {
+    CSingleLock lock(m_section);
+    if (g_advancedSettings.m_pythonInterpreterPool == 0)
+      return false;
+
+    Template *tmpl = FindTemplate(modules, script);
+    if (!tmpl || tmpl->ready.empty())
+    {
+      m_stats.misses++;
+      // learn what to prepare from this invocation
+      if (!tmpl && m_templates.size() < POOL_MAX_TEMPLATES)
+      {
+        Template newTemplate;
+        newTemplate.modules = modules;
+        newTemplate.hasScript = script != NULL;
+        if (script)
+          newTemplate.script = script;
+        m_templates.push_back(newTemplate);
+      }
+      if (!IsRunning())
+        Create();
+      m_wakeEvent.Set();
+      return false;
+    }
+
+    interpreter = tmpl->ready.front();
+    tmpl->ready.pop_front();
+    m_stats.hits++;
+    m_wakeEvent.Set();
+  }
+
+  // the prepared thread state belongs to the pool's thread, so continue with one of our own
+  state = PyThreadState_New(interpreter.state->interp);
+  PyThreadState_Swap(state);
+  PyThreadState_Clear(interpreter.state);
+  PyThreadState_Delete(interpreter.state);
+  languageHook = interpreter.languageHook;
+  return true;
+}
+
+void CPythonInterpreterPool::Clear()
+{
+  StopThread(false);
+  m_wakeEvent.Set();
+  StopThread(true);
+
+  std::vector<Interpreter> interpreters;
+  Statistics stats;
+  {
+    CSingleLock lock(m_section);
+    for (std::deque<Template>::iterator it = m_templates.begin(); it != m_templates.end(); ++it)
+    {
+      interpreters.insert(interpreters.end(), it->ready.begin(), it->ready.end());
+      it->ready.clear();
+    }
+    m_stats.discarded += interpreters.size();
+    stats = GetStatistics();
+  }
+
+  if (!interpreters.empty())
+  {
+    PyEval_AcquireLock();
+    for (std::vector<Interpreter>::iterator it = interpreters.begin(); it != interpreters.end(); ++it)
+      End(*it);
+    PyEval_ReleaseLock();
+  }
+
+  if (stats.hits + stats.misses > 0)
+    CLog::Log(LOGDEBUG, "CPythonInterpreterPool: %u of %u invocations served from the pool, %u interpreters prepared in %u ms on average, %u failed, %u discarded",
+              stats.hits, stats.hits + stats.misses, stats.created, stats.averageTime, stats.failed, stats.discarded);
+}
+
+CPythonInterpreterPool::Statistics CPythonInterpreterPool::GetStatistics() const
+{
+  CSingleLock lock(m_section);
+  Statistics stats = m_stats;
+  stats.averageTime = m_stats.created ? m_totalTime / m_stats.created : 0;
+  return stats;
+}
+
+bool CPythonInterpreterPool::Prepare(const Template &tmpl, Interpreter &interpreter)
+{
+  PyEval_AcquireLock();
+  PyThreadState *state = Py_NewInterpreter();
+  if (state == NULL)
+  {
+    PyEval_ReleaseLock();
+    CLog::Log(LOGERROR, "CPythonInterpreterPool: FAILED to get thread state!");
+    return false;
+  }
+  PyThreadState_Swap(state);
+
+  interpreter.state = state;
+  interpreter.languageHook = new XBMCAddon::Python::PythonLanguageHook(state->interp);
+  interpreter.languageHook->RegisterMe();
+
+  bool success = CPythonInvoker::InitializeInterpreter(tmpl.modules, tmpl.hasScript ? tmpl.script.c_str() : NULL);
+
+  PyThreadState_Swap(NULL);
+  if (!success)
+    End(interpreter);
+  PyEval_ReleaseLock();
+
+  return success;
+}
+
+void CPythonInterpreterPool::End(Interpreter &interpreter)
+{
+  PyThreadState_Swap(interpreter.state);
+  Py_EndInterpreter(interpreter.state);
+  interpreter.state = NULL;
+
+  interpreter.languageHook->UnregisterMe();
+  interpreter.languageHook = LanguageHookRef();
+}
+
+void CPythonInterpreterPool::Process()
+{
+  while (!m_bStop)
+  {
+    Template tmpl;
+    bool needed = false;
+    {
+      CSingleLock lock(m_section);
+      for (std::deque<Template>::const_iterator it = m_templates.begin(); it != m_templates.end(); ++it)
+      {
+        if (it->ready.size() < g_advancedSettings.m_pythonInterpreterPool)
+        {
+          tmpl.modules = it->modules;
+          tmpl.script = it->script;
+          tmpl.hasScript = it->hasScript;
+          needed = true;
+          break;
+        }
+      }
+    }
+
+    if (!needed)
+    {
+      m_wakeEvent.Wait();
+      continue;
+    }
+
+    Interpreter interpreter;
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    if (!Prepare(tmpl, interpreter))
+    {
+      {
+        CSingleLock lock(m_section);
+        m_stats.failed++;
+      }
+      m_wakeEvent.WaitMSec(POOL_RETRY_DELAY);
+      continue;
+    }
+    unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+
+    CSingleLock lock(m_section);
+    m_stats.created++;
+    m_totalTime += elapsed;
+
+    Template *target = FindTemplate(tmpl.modules, tmpl.hasScript ? tmpl.script.c_str() : NULL);
+    if (target && !m_bStop && target->ready.size() < g_advancedSettings.m_pythonInterpreterPool)
+    {
+      target->ready.push_back(interpreter);
+      CLog::Log(LOGDEBUG, "CPythonInterpreterPool: prepared python interpreter in %u ms", elapsed);
+      continue;
+    }
+
+    // no longer needed
+    m_stats.discarded++;
+    lock.Leave();
+    PyEval_AcquireLock();
+    End(interpreter);
+    PyEval_ReleaseLock();
+  }
+}
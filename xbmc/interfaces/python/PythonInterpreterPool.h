@@ -0,0 +1,112 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// python.h should always be included first before any other includes
+#include "interfaces/python/LanguageHook.h"
+#include "interfaces/python/PythonInvoker.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+#include <deque>
+#include <map>
+#include <string>
+
+/*!
+ \brief Keeps python sub-interpreters ready for CPythonInvoker.
+
+ Creating a sub-interpreter and initializing the xbmc modules in it takes a good part of the
+ time needed to run a plugin, so a background thread prepares a few interpreters in advance.
+ Interpreters are prepared for a set of modules and an initialization script, which are taken
+ from the invokers asking for one.
+
+ Used interpreters are never handed out again, as scripts leave their state behind in the
+ modules they import. The invoker ends them as before.
+ */
+class CPythonInterpreterPool : protected CThread
+{
+public:
+  typedef std::map<std::string, CPythonInvoker::PythonModuleInitialization> ModuleMap;
+  typedef XBMCAddon::AddonClass::Ref<XBMCAddon::Python::PythonLanguageHook> LanguageHookRef;
+
+  struct Statistics
+  {
+    unsigned int hits;          ///< invocations served from the pool
+    unsigned int misses;        ///< invocations that had to create their own interpreter
+    unsigned int created;       ///< interpreters prepared by the pool
+    unsigned int failed;        ///< interpreters that couldn't be prepared
+    unsigned int discarded;     ///< prepared interpreters ended without being used
+    unsigned int averageTime;   ///< average time to prepare an interpreter in ms
+  };
+
+  static CPythonInterpreterPool &Get();
+
+  /*! \brief Take a prepared interpreter.
+   Must be called with the GIL held and without a thread state swapped in. On success a new
+   thread state of the interpreter for the calling thread is swapped in.
+   \param modules the modules that need to be initialized in the interpreter.
+   \param script the initialization script that needs to have run in the interpreter, may be NULL.
+   \param state [out] the thread state of the interpreter.
+   \param languageHook [out] the language hook registered for the interpreter.
+   \return true if a prepared interpreter was available, false otherwise.
+   */
+  bool Acquire(const ModuleMap &modules, const char *script, PyThreadState *&state, LanguageHookRef &languageHook);
+
+  /*! \brief Stop preparing interpreters and end the ones that are ready.
+   Must be called without holding the GIL, before the python engine is finalized.
+   */
+  void Clear();
+
+  Statistics GetStatistics() const;
+
+protected:
+  virtual void Process();
+
+private:
+  CPythonInterpreterPool();
+  CPythonInterpreterPool(const CPythonInterpreterPool&);
+  CPythonInterpreterPool const& operator=(CPythonInterpreterPool const&);
+  virtual ~CPythonInterpreterPool();
+
+  struct Interpreter
+  {
+    PyThreadState *state;
+    LanguageHookRef languageHook;
+  };
+
+  struct Template
+  {
+    ModuleMap modules;
+    std::string script;
+    bool hasScript;
+    std::deque<Interpreter> ready;
+  };
+
+  Template *FindTemplate(const ModuleMap &modules, const char *script);
+  bool Prepare(const Template &tmpl, Interpreter &interpreter);
+  static void End(Interpreter &interpreter);
+
+  std::deque<Template> m_templates;
+  Statistics m_stats;
+  unsigned int m_totalTime;
+  CCriticalSection m_section;
+  CEvent m_wakeEvent;
+};
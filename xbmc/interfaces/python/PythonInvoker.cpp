@@ -39,6 +39,7 @@
 #include "interfaces/legacy/Addon.h"
 #include "interfaces/python/LanguageHook.h"
 #include "interfaces/python/PyContext.h"
+#include "interfaces/python/PythonInterpreterPool.h"
 #include "interfaces/python/pythreadstate.h"
 #include "interfaces/python/swig.h"
 #include "interfaces/python/XBPython.h"
@@ -160,20 +161,27 @@ bool CPythonInvoker::execute(const std::string &script, const std::vector<std::s
 
   // get the global lock
   PyEval_AcquireLock();
-  PyThreadState* state = Py_NewInterpreter();
-  if (state == NULL)
+  PyThreadState* state = NULL;
+  XBMCAddon::AddonClass::Ref<XBMCAddon::Python::PythonLanguageHook> languageHook;
+  if (CPythonInterpreterPool::Get().Acquire(getModules(), getInitializationScript(), state, languageHook))
+    CLog::Log(LOGDEBUG, "CPythonInvoker(%d, %s): using a prepared interpreter", GetId(), m_sourceFile.c_str());
+  else
   {
-    PyEval_ReleaseLock();
-    CLog::Log(LOGERROR, "CPythonInvoker(%d, %s): FAILED to get thread state!", GetId(), m_sourceFile.c_str());
-    return false;
-  }
-  // swap in my thread state
-  PyThreadState_Swap(state);
+    state = Py_NewInterpreter();
+    if (state == NULL)
+    {
+      PyEval_ReleaseLock();
+      CLog::Log(LOGERROR, "CPythonInvoker(%d, %s): FAILED to get thread state!", GetId(), m_sourceFile.c_str());
+      return false;
+    }
+    // swap in my thread state
+    PyThreadState_Swap(state);
 
-  XBMCAddon::AddonClass::Ref<XBMCAddon::Python::PythonLanguageHook> languageHook(new XBMCAddon::Python::PythonLanguageHook(state->interp));
-  languageHook->RegisterMe();
+    languageHook = new XBMCAddon::Python::PythonLanguageHook(state->interp);
+    languageHook->RegisterMe();
 
-  onInitialization();
+    onInitialization();
+  }
   setState(InvokerStateInitialized);
 
   std::string realFilename(CSpecialProtocol::TranslatePath(m_sourceFile));
@@ -513,19 +521,28 @@ std::map<std::string, CPythonInvoker::PythonModuleInitialization> CPythonInvoker
 void CPythonInvoker::onInitialization()
 {
   XBMC_TRACE;
+  if (!InitializeInterpreter(getModules(), getInitializationScript()))
+    CLog::Log(LOGFATAL, "CPythonInvoker(%d, %s): initialize error", GetId(), m_sourceFile.c_str());
+}
+
+bool CPythonInvoker::InitializeInterpreter(const std::map<std::string, PythonModuleInitialization> &modules, const char *script)
+{
   {
     GilSafeSingleLock lock(s_critical);
-    initializeModules(getModules());
+    for (std::map<std::string, PythonModuleInitialization>::const_iterator module = modules.begin(); module != modules.end(); ++module)
+    {
+      if (module->second == NULL)
+        CLog::Log(LOGWARNING, "CPythonInvoker: unable to initialize python module \"%s\"", module->first.c_str());
+      else
+        module->second();
+    }
   }
 
-  // get a possible initialization script
-  const char* runscript = getInitializationScript();
-  if (runscript!= NULL && strlen(runscript) > 0)
-  {
-    // redirecting default output to debug console
-    if (PyRun_SimpleString(runscript) == -1)
-      CLog::Log(LOGFATAL, "CPythonInvoker(%d, %s): initialize error", GetId(), m_sourceFile.c_str());
-  }
+  // redirecting default output to debug console
+  if (script != NULL && strlen(script) > 0 && PyRun_SimpleString(script) == -1)
+    return false;
+
+  return true;
 }
 
 void CPythonInvoker::onPythonModuleInitialization(void* moduleDict)
@@ -585,24 +602,6 @@ const char* CPythonInvoker::getInitializationScript() const
   return NULL;
 }
 
-void CPythonInvoker::initializeModules(const std::map<std::string, PythonModuleInitialization> &modules)
-{
-  for (std::map<std::string, PythonModuleInitialization>::const_iterator module = modules.begin(); module != modules.end(); ++module)
-  {
-    if (!initializeModule(module->second))
-      CLog::Log(LOGWARNING, "CPythonInvoker(%d, %s): unable to initialize python module \"%s\"", GetId(), m_sourceFile.c_str(), module->first.c_str());
-  }
-}
-
-bool CPythonInvoker::initializeModule(PythonModuleInitialization module)
-{
-  if (module == NULL)
-    return false;
-
-  module();
-  return true;
-}
-
 void CPythonInvoker::addPath(const std::string& path)
 {
 #if defined(TARGET_WINDOWS)
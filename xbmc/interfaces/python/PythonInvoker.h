@@ -37,7 +37,15 @@ public:
   virtual bool IsStopping() const { return m_stop || ILanguageInvoker::IsStopping(); }
 
   typedef void (*PythonModuleInitialization)();
-  
+
+  /*! \brief Initialize modules and run an initialization script in the current interpreter.
+   Must be called with the GIL held and the interpreter's thread state swapped in.
+   \param modules the modules to initialize.
+   \param script the initialization script to run, may be NULL.
+   \return false if the initialization script failed, true otherwise.
+   */
+  static bool InitializeInterpreter(const std::map<std::string, PythonModuleInitialization> &modules, const char *script);
+
 protected:
   // implementation of ILanguageInvoker
   virtual bool execute(const std::string &script, const std::vector<std::string> &arguments);
@@ -47,6 +55,8 @@ protected:
   // custom virtual methods
   virtual std::map<std::string, PythonModuleInitialization> getModules() const;
   virtual const char* getInitializationScript() const;
+  // not called for interpreters taken from CPythonInterpreterPool, which have
+  // been initialized with getModules() and getInitializationScript() already
   virtual void onInitialization();
   // actually a PyObject* but don't wanna draw Python.h include into the header
   virtual void onPythonModuleInitialization(void* moduleDict);
@@ -62,8 +72,6 @@ protected:
   CCriticalSection m_critical;
 
 private:
-  void initializeModules(const std::map<std::string, PythonModuleInitialization> &modules);
-  bool initializeModule(PythonModuleInitialization module);
   void addPath(const std::string& path); // add path in UTF-8 encoding
   void addNativePath(const std::string& path); // add path in system/Python encoding
 
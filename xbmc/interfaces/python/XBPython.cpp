@@ -53,6 +53,7 @@
 #include "interfaces/legacy/AddonUtils.h"
 #include "interfaces/python/AddonPythonInvoker.h"
 #include "interfaces/python/PythonInvoker.h"
+#include "interfaces/python/PythonInterpreterPool.h"
 
 using namespace ANNOUNCEMENT;
 
@@ -537,6 +538,8 @@ void XBPython::Finalize()
     m_mainThreadState = NULL; // clear the main thread state before releasing the lock
     {
       CSingleExit exit(m_critSection);
+      CPythonInterpreterPool::Get().Clear();
+
       PyEval_AcquireLock();
       PyThreadState_Swap(curTs);
 
@@ -576,6 +579,8 @@ void XBPython::Uninitialize()
 
   // cleanup threads that are still running
   tmpvec.clear(); // boost releases the XBPyThreads which, if deleted, calls FinalizeScript
+
+  CPythonInterpreterPool::Get().Clear();
 }
 
 void XBPython::Process()
@@ -66,6 +66,7 @@
 #include "utils/XMLUtils.h"
 #include "URL.h"
 #include "playlists/SmartPlayList.h"
+#include "playlists/SmartPlaylistCache.h"
 
 using namespace std;
 using namespace AUTOPTR;
@@ -182,6 +183,13 @@ void CMusicDatabase::CreateTables()
   CLog::Log(LOGINFO, "create art table");
   m_pDS->exec("CREATE TABLE art(art_id INTEGER PRIMARY KEY, media_id INTEGER, media_type TEXT, type TEXT, url TEXT)");
 
+  CLog::Log(LOGINFO, "create smartplaylist table");
+  m_pDS->exec("CREATE TABLE smartplaylist (idPlaylist integer primary key, strHash text, media_type TEXT)");
+  CLog::Log(LOGINFO, "create smartplaylistlink table");
+  m_pDS->exec("CREATE TABLE smartplaylistlink (idPlaylist integer, idMedia integer)");
+  CLog::Log(LOGINFO, "create navcount table");
+  m_pDS->exec("CREATE TABLE navcount (idNav integer, nav_type text, media_type text, iCount integer)");
+
   // Add 'Karaoke' genre
   AddGenre( "Karaoke" );
 }
@@ -230,6 +238,10 @@ void CMusicDatabase::CreateAnalytics()
 
   m_pDS->exec("CREATE INDEX ix_art ON art(media_id, media_type(20), type(20))");
 
+  m_pDS->exec("CREATE INDEX idxSmartPlaylistLink ON smartplaylistlink (idPlaylist, idMedia)");
+
+  m_pDS->exec("CREATE UNIQUE INDEX idxNavCount ON navcount (nav_type(20), media_type(20), idNav)");
+
   CLog::Log(LOGINFO, "create triggers");
   m_pDS->exec("CREATE TRIGGER tgrDeleteAlbum AFTER delete ON album FOR EACH ROW BEGIN"
               "  DELETE FROM song WHERE song.idAlbum = old.idAlbum;"
@@ -243,6 +255,7 @@ void CMusicDatabase::CreateAnalytics()
               "  DELETE FROM song_artist WHERE song_artist.idArtist = old.idArtist;"
               "  DELETE FROM discography WHERE discography.idArtist = old.idArtist;"
               "  DELETE FROM art WHERE media_id=old.idArtist AND media_type='artist';"
+              "  DELETE FROM navcount WHERE idNav = old.idArtist AND nav_type = 'artist';"
               " END");
   m_pDS->exec("CREATE TRIGGER tgrDeleteSong AFTER delete ON song FOR EACH ROW BEGIN"
               "  DELETE FROM song_artist WHERE song_artist.idSong = old.idSong;"
@@ -250,6 +263,23 @@ void CMusicDatabase::CreateAnalytics()
               "  DELETE FROM karaokedata WHERE karaokedata.idSong = old.idSong;"
               "  DELETE FROM art WHERE media_id=old.idSong AND media_type='song';"
               " END");
+  // song and album counters of the artists, for the artists node
+  m_pDS->exec("CREATE TRIGGER tgrInsertArtist AFTER insert ON artist FOR EACH ROW BEGIN"
+              "  INSERT INTO navcount (idNav, nav_type, media_type, iCount) VALUES (new.idArtist, 'artist', 'song', 0);"
+              "  INSERT INTO navcount (idNav, nav_type, media_type, iCount) VALUES (new.idArtist, 'artist', 'album', 0);"
+              " END");
+  m_pDS->exec("CREATE TRIGGER tgrInsertSongArtist AFTER insert ON song_artist FOR EACH ROW BEGIN"
+              "  UPDATE navcount SET iCount = iCount + 1 WHERE idNav = new.idArtist AND nav_type = 'artist' AND media_type = 'song';"
+              " END");
+  m_pDS->exec("CREATE TRIGGER tgrDeleteSongArtist AFTER delete ON song_artist FOR EACH ROW BEGIN"
+              "  UPDATE navcount SET iCount = iCount - 1 WHERE idNav = old.idArtist AND nav_type = 'artist' AND media_type = 'song';"
+              " END");
+  m_pDS->exec("CREATE TRIGGER tgrInsertAlbumArtist AFTER insert ON album_artist FOR EACH ROW BEGIN"
+              "  UPDATE navcount SET iCount = iCount + 1 WHERE idNav = new.idArtist AND nav_type = 'artist' AND media_type = 'album';"
+              " END");
+  m_pDS->exec("CREATE TRIGGER tgrDeleteAlbumArtist AFTER delete ON album_artist FOR EACH ROW BEGIN"
+              "  UPDATE navcount SET iCount = iCount - 1 WHERE idNav = old.idArtist AND nav_type = 'artist' AND media_type = 'album';"
+              " END");
 
   // we create views last to ensure all indexes are rolled in
   CreateViews();
@@ -1233,9 +1263,15 @@ bool CMusicDatabase::DeleteArtistDiscography(int idArtist)
 
 bool CMusicDatabase::AddSongArtist(int idArtist, int idSong, std::string strArtist, std::string joinPhrase, bool featured, int iOrder)
 {
+  // replacing an existing link would count it again, as sqlite doesn't fire the delete trigger on a replace
   CStdString strSQL;
-  strSQL=PrepareSQL("replace into song_artist (idArtist, idSong, strArtist, strJoinPhrase, boolFeatured, iOrder) values(%i,%i,'%s','%s',%i,%i)",
-                    idArtist, idSong, strArtist.c_str(), joinPhrase.c_str(), featured == true ? 1 : 0, iOrder);
+  strSQL=PrepareSQL("SELECT 1 FROM song_artist WHERE idArtist = %i AND idSong = %i", idArtist, idSong);
+  if (GetSingleValue(strSQL).empty())
+    strSQL=PrepareSQL("INSERT INTO song_artist (idArtist, idSong, strArtist, strJoinPhrase, boolFeatured, iOrder) values(%i,%i,'%s','%s',%i,%i)",
+                      idArtist, idSong, strArtist.c_str(), joinPhrase.c_str(), featured == true ? 1 : 0, iOrder);
+  else
+    strSQL=PrepareSQL("UPDATE song_artist SET strArtist = '%s', strJoinPhrase = '%s', boolFeatured = %i, iOrder = %i WHERE idArtist = %i AND idSong = %i",
+                      strArtist.c_str(), joinPhrase.c_str(), featured == true ? 1 : 0, iOrder, idArtist, idSong);
   return ExecuteQuery(strSQL);
 };
 
@@ -1246,9 +1282,15 @@ bool CMusicDatabase::DeleteSongArtistsBySong(int idSong)
 
 bool CMusicDatabase::AddAlbumArtist(int idArtist, int idAlbum, std::string strArtist, std::string joinPhrase, bool featured, int iOrder)
 {
+  // see AddSongArtist
   CStdString strSQL;
-  strSQL=PrepareSQL("replace into album_artist (idArtist, idAlbum, strArtist, strJoinPhrase, boolFeatured, iOrder) values(%i,%i,'%s','%s',%i,%i)",
-                    idArtist, idAlbum, strArtist.c_str(), joinPhrase.c_str(), featured == true ? 1 : 0, iOrder);
+  strSQL=PrepareSQL("SELECT 1 FROM album_artist WHERE idArtist = %i AND idAlbum = %i", idArtist, idAlbum);
+  if (GetSingleValue(strSQL).empty())
+    strSQL=PrepareSQL("INSERT INTO album_artist (idArtist, idAlbum, strArtist, strJoinPhrase, boolFeatured, iOrder) values(%i,%i,'%s','%s',%i,%i)",
+                      idArtist, idAlbum, strArtist.c_str(), joinPhrase.c_str(), featured == true ? 1 : 0, iOrder);
+  else
+    strSQL=PrepareSQL("UPDATE album_artist SET strArtist = '%s', strJoinPhrase = '%s', boolFeatured = %i, iOrder = %i WHERE idArtist = %i AND idAlbum = %i",
+                      strArtist.c_str(), joinPhrase.c_str(), featured == true ? 1 : 0, iOrder, idArtist, idAlbum);
   return ExecuteQuery(strSQL);
 };
 
@@ -2417,7 +2459,8 @@ bool CMusicDatabase::CleanupPaths()
     // we can happily delete any path that has no reference to a song
     // but we must keep all paths that have been scanned that may contain songs in subpaths
 
-    // first create a temporary table of song paths
+    // first create a temporary table of song paths, the connection may still have one from an aborted cleanup
+    m_pDS->exec("DROP TABLE IF EXISTS songpaths\n");
     m_pDS->exec("CREATE TEMPORARY TABLE songpaths (idPath integer, strPath varchar(512))\n");
     m_pDS->exec("INSERT INTO songpaths select idPath,strPath from path where idPath in (select idPath from song)\n");
 
@@ -2428,6 +2471,7 @@ bool CMusicDatabase::CleanupPaths()
     if (iRowsFound == 0)
     {
       m_pDS->close();
+      m_pDS->exec("drop table songpaths");
       return true;
     }
     // and construct a list to delete
@@ -2475,6 +2519,7 @@ bool CMusicDatabase::CleanupArtists()
     // don't delete the "Various Artists" string
 
     // Create temp table to avoid 1442 trigger hell on mysql
+    m_pDS->exec("DROP TABLE IF EXISTS tmp_delartists");
     m_pDS->exec("CREATE TEMPORARY TABLE tmp_delartists (idArtist integer)");
     m_pDS->exec("INSERT INTO tmp_delartists select idArtist from song_artist");
     m_pDS->exec("INSERT INTO tmp_delartists select idArtist from album_artist");
@@ -2849,6 +2894,8 @@ bool CMusicDatabase::GetGenresNav(const CStdString& strBaseDir, CFileItemList& i
     if (NULL == m_pDS.get()) return false;
 
     // get primary genres for songs - could be simplified to just SELECT * FROM genre?
+    // unlike the artists there are no counters to read here: without filters only the
+    // genre table is listed, and CleanupGenres() removes genres without songs or albums
     CStdString strSQL = "SELECT %s FROM genre ";
 
     Filter extFilter = filter;
@@ -3934,11 +3981,60 @@ void CMusicDatabase::UpdateTables(int version)
                 " bookmark integer, file text, duration integer"
                 " dateAdded varchar (20) default NULL)");
   }
+  if (version < 49)
+  {
+    m_pDS->exec("CREATE TABLE smartplaylist (idPlaylist integer primary key, strHash text, media_type TEXT)");
+    m_pDS->exec("CREATE TABLE smartplaylistlink (idPlaylist integer, idMedia integer)");
+  }
+  if (version < 50)
+  {
+    m_pDS->exec("CREATE TABLE navcount (idNav integer, nav_type text, media_type text, iCount integer)");
+    RebuildNavCounts();
+  }
 }
 
 int CMusicDatabase::GetSchemaVersion() const
 {
-  return 48;
+  return 50;
+}
+
+void CMusicDatabase::RebuildNavCounts()
+{
+  m_pDS->exec("DELETE FROM navcount");
+  m_pDS->exec("INSERT INTO navcount (idNav, nav_type, media_type, iCount) SELECT idArtist, 'artist', 'song', "
+              "(SELECT COUNT(1) FROM song_artist WHERE song_artist.idArtist = artist.idArtist) FROM artist");
+  m_pDS->exec("INSERT INTO navcount (idNav, nav_type, media_type, iCount) SELECT idArtist, 'artist', 'album', "
+              "(SELECT COUNT(1) FROM album_artist WHERE album_artist.idArtist = artist.idArtist) FROM artist");
+}
+
+bool CMusicDatabase::CheckNavCounts()
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    CStdString strSQL = "SELECT COUNT(1) FROM artist"
+                        " LEFT JOIN navcount AS songs ON songs.idNav = artist.idArtist AND songs.nav_type = 'artist' AND songs.media_type = 'song'"
+                        " LEFT JOIN navcount AS albums ON albums.idNav = artist.idArtist AND albums.nav_type = 'artist' AND albums.media_type = 'album'"
+                        " WHERE songs.idNav IS NULL OR albums.idNav IS NULL"
+                        " OR songs.iCount <> (SELECT COUNT(1) FROM song_artist WHERE song_artist.idArtist = artist.idArtist)"
+                        " OR albums.iCount <> (SELECT COUNT(1) FROM album_artist WHERE album_artist.idArtist = artist.idArtist)";
+    int differences = (int)strtol(GetSingleValue(strSQL, m_pDS).c_str(), NULL, 10);
+    if (differences == 0)
+      return true;
+
+    CLog::Log(LOGWARNING, "%s - the counters of %i artists are off, rebuilding them", __FUNCTION__, differences);
+    BeginTransaction();
+    RebuildNavCounts();
+    CommitTransaction();
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+    RollbackTransaction();
+  }
+  return false;
 }
 
 unsigned int CMusicDatabase::GetSongIDs(const Filter &filter, vector<pair<int,int> > &songIDs)
@@ -5563,15 +5659,13 @@ bool CMusicDatabase::GetFilter(CDbUrl &musicUrl, Filter &filter, SortDescription
     }
     else
     {
-      if (!albumArtistsOnly)  // show all artists in this case (ie those linked to a song)
-        strSQL += "(SELECT song_artist.idArtist FROM song_artist)"
-                  " OR artistview.idArtist IN ";
-
-      // and always show any artists linked to an album (may be different from above due to album artist tag)
-      strSQL +=   "(SELECT album_artist.idArtist FROM album_artist"; // All artists linked to an album
-      if (albumArtistsOnly)
-        strSQL += " JOIN album ON album.idAlbum = album_artist.idAlbum WHERE album.bCompilation = 0 ";            // then exclude those that have no extra artists
-      strSQL +=   ")";
+      if (!albumArtistsOnly)  // show all artists in this case (ie those linked to a song or an album)
+        strSQL += "(SELECT navcount.idNav FROM navcount WHERE navcount.nav_type = 'artist' AND navcount.iCount > 0)";
+      else
+      { // artists linked to an album, excluding those that have no extra artists
+        strSQL += "(SELECT album_artist.idArtist FROM album_artist"
+                  " JOIN album ON album.idAlbum = album_artist.idAlbum WHERE album.bCompilation = 0 )";
+      }
     }
 
     // remove the null string
@@ -5682,7 +5776,11 @@ bool CMusicDatabase::GetFilter(CDbUrl &musicUrl, Filter &filter, SortDescription
        (xsp.GetGroup() == type && !xsp.IsGroupMixed()))
     {
       std::set<CStdString> playlists;
-      filter.AppendWhere(xsp.GetWhereClause(*this, playlists));
+      CStdString where = xsp.GetWhereClause(*this, playlists);
+      // a shared database may be changed by others without us being told
+      if (xsp.GetType() == type && m_sqlite && g_advancedSettings.m_smartPlaylistCache)
+        where = CSmartPlaylistCache::Get().GetWhereClause(*this, std::string(m_pDB->getHostName()) + m_pDB->getDatabase(), MediaTypes::FromString(type), where);
+      filter.AppendWhere(where);
 
       if (xsp.GetLimit() > 0)
         sorting.limitEnd = xsp.GetLimit();
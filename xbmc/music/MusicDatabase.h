@@ -346,6 +346,12 @@ public:
   void IncrementPlayCount(const CFileItem &item);
   bool CleanupOrphanedItems();
 
+  /*! \brief Check the song and album counters of the artists against the library
+   The counters are kept up to date by triggers. They're rebuilt if any of them is off.
+   \return true if the counters were up to date, false otherwise.
+   */
+  bool CheckNavCounts();
+
   /////////////////////////////////////////////////
   // VIEWS
   /////////////////////////////////////////////////
@@ -485,6 +491,7 @@ protected:
   virtual int GetSchemaVersion() const;
 
   const char *GetBaseDBName() const { return "MyMusic"; };
+  bool ReportsChanges() const { return true; };
 
 
 private:
@@ -509,6 +516,7 @@ private:
   bool CleanupArtists();
   bool CleanupGenres();
   virtual void UpdateTables(int version);
+  void RebuildNavCounts();
   bool SearchArtists(const CStdString& search, CFileItemList &artists);
   bool SearchAlbums(const CStdString& search, CFileItemList &albums);
   bool SearchSongs(const CStdString& strSearch, CFileItemList &songs);
@@ -27,6 +27,7 @@
 #include "filesystem/MusicDatabaseDirectory/DirectoryNode.h"
 #include "Util.h"
 #include "utils/md5.h"
+#include "utils/ChangeJournal.h"
 #include "GUIInfoManager.h"
 #include "utils/Variant.h"
 #include "NfoFile.h"
@@ -71,6 +72,7 @@ CMusicInfoScanner::CMusicInfoScanner() : CThread("MusicInfoScanner"), m_fileCoun
   m_currentItem=0;
   m_itemCount=0;
   m_flags = 0;
+  m_changedDirs = 0;
 }
 
 CMusicInfoScanner::~CMusicInfoScanner()
@@ -117,6 +119,13 @@ void CMusicInfoScanner::Process()
       m_bCanInterrupt = false;
       m_needsCleanup = false;
 
+      // local sources are watched, so that unchanged folders can be skipped on later scans
+      if (g_advancedSettings.m_changeJournal)
+      {
+        for (std::set<std::string>::const_iterator it = m_pathsToScan.begin(); it != m_pathsToScan.end(); ++it)
+          CChangeJournal::Get().Watch(*it);
+      }
+
       bool commit = true;
       for (std::set<std::string>::const_iterator it = m_pathsToScan.begin(); it != m_pathsToScan.end(); it++)
       {
@@ -396,6 +405,19 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
   if (CUtil::ExcludeFileOrFolder(strDirectory, regexps))
     return true;
 
+  // a folder found unchanged on its last scan is skipped with its subfolders if nothing changed below it since
+  unsigned int cursor = CChangeJournal::Get().GetCursor();
+  std::map<std::string, unsigned int>::const_iterator scanned = m_journalCursors.find(strDirectory);
+  if (!(m_flags & SCAN_RESCAN) && scanned != m_journalCursors.end() &&
+      !CChangeJournal::Get().HasChanged(strDirectory, scanned->second))
+  {
+    CLog::Log(LOGDEBUG, "%s Skipping dir '%s' due to no change (journal)", __FUNCTION__, strDirectory.c_str());
+    if (m_handle)
+      OnDirectoryScanned(strDirectory);
+    return true;
+  }
+  unsigned int changedDirs = m_changedDirs;
+
   // load subfolder
   CFileItemList items;
   CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_musicExtensions + "|.jpg|.tbn|.lrc|.cdg");
@@ -416,6 +438,7 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
   CStdString dbHash;
   if ((m_flags & SCAN_RESCAN) || !m_musicDatabase.GetPathHash(strDirectory, dbHash) || dbHash != hash)
   { // path has changed - rescan
+    m_changedDirs++;
     if (dbHash.empty())
       CLog::Log(LOGDEBUG, "%s Scanning dir '%s' as not in the database", __FUNCTION__, strDirectory.c_str());
     else
@@ -468,6 +491,10 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
     }
   }
 
+  if (!m_bStop && m_changedDirs == changedDirs)
+    m_journalCursors[strDirectory] = cursor;
+  else
+    m_journalCursors.erase(strDirectory);
   return !m_bStop;
 }
 
@@ -217,6 +217,8 @@ protected:
 
   std::set<std::string> m_pathsToScan;
   int m_flags;
+  std::map<std::string, unsigned int> m_journalCursors;  ///< position of the change journal each folder was last found unchanged at
+  unsigned int m_changedDirs;                            ///< folders scanned that weren't found unchanged
   CThread m_fileCountReader;
 };
 }
@@ -61,6 +61,7 @@
 #include "guilib/LocalizeStrings.h"
 #include "utils/TimeUtils.h"
 #include "utils/log.h"
+#include "utils/ScraperCache.h"
 #include "utils/URIUtils.h"
 #include "video/VideoInfoTag.h"
 #include "utils/StringUtils.h"
@@ -393,6 +394,7 @@ void CGUIWindowMusicBase::ShowArtistInfo(const CFileItem *pItem, bool bShowInfo
       if (pDlgArtistInfo->NeedRefresh())
       {
         m_musicdatabase.ClearArtistLastScrapedTime(params.GetArtistId());
+        CScraperCache::Get().Revalidate();
         continue;
       } 
       else if (pDlgArtistInfo->HasUpdatedThumb()) 
@@ -472,6 +474,7 @@ bool CGUIWindowMusicBase::ShowAlbumInfo(const CFileItem *pItem, bool bShowInfo /
       if (pDlgAlbumInfo->NeedRefresh())
       {
         m_musicdatabase.ClearAlbumLastScrapedTime(params.GetAlbumId());
+        CScraperCache::Get().Revalidate();
         continue;
       }
       else if (pDlgAlbumInfo->HasUpdatedThumb())
@@ -24,8 +24,11 @@
 #include "Util.h"
 #include "XBDateTime.h"
 #include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/Base64.h"
 #include "utils/log.h"
 #include "utils/Mime.h"
@@ -39,6 +42,14 @@
 #pragma comment(lib, "libmicrohttpd.dll.lib")
 #endif
 
+#if defined(TARGET_POSIX) && (MHD_VERSION >= 0x00090600)
+// serve local files through MHD_create_response_from_fd_at_offset()
+// which lets libmicrohttpd use sendfile()
+#define WEBSERVER_USE_SENDFILE
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
 #define MAX_POST_BUFFER_SIZE 2048
 
 #define PAGE_FILE_NOT_FOUND "<html><head><title>File not found</title></head><body>File not found</body></html>"
@@ -63,6 +74,8 @@ typedef struct {
 } HttpFileDownloadContext;
 
 vector<IHTTPRequestHandler *> CWebServer::m_requestHandlers;
+map<string, CWebServer::HandlerStatistics> CWebServer::m_handlerStatistics;
+CCriticalSection CWebServer::m_statisticsSection;
 
 CWebServer::CWebServer()
 {
@@ -293,6 +306,76 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
   if (handler == NULL)
     return SendErrorResponse(request.connection, MHD_HTTP_INTERNAL_SERVER_ERROR, request.method);
 
+  // make sure a single request handler can't occupy all the available
+  // threads and starve the requests for all the other handlers
+  string handlerName = handler->GetName();
+  if (!BeginHandlerRequest(handlerName))
+  {
+    CLog::Log(LOGWARNING, "WebServer: rejected request for %s because too many %s requests are being handled", request.url.c_str(), handlerName.c_str());
+    delete handler;
+    return SendErrorResponse(request.connection, MHD_HTTP_SERVICE_UNAVAILABLE, request.method);
+  }
+
+  unsigned int startTime = XbmcThreads::SystemClockMillis();
+  int ret = ExecuteRequest(handler, request);
+  EndHandlerRequest(handlerName, XbmcThreads::SystemClockMillis() - startTime);
+
+  return ret;
+}
+
+bool CWebServer::BeginHandlerRequest(const std::string &handlerName)
+{
+  CSingleLock lock(m_statisticsSection);
+  HandlerStatistics &statistics = m_handlerStatistics[handlerName];
+
+  unsigned int limit = g_advancedSettings.m_webserverHandlerLimit;
+  if (limit > 0 && statistics.active >= limit)
+  {
+    statistics.rejected++;
+    return false;
+  }
+
+  statistics.active++;
+  return true;
+}
+
+void CWebServer::EndHandlerRequest(const std::string &handlerName, unsigned int duration)
+{
+  CSingleLock lock(m_statisticsSection);
+  HandlerStatistics &statistics = m_handlerStatistics[handlerName];
+
+  if (statistics.active > 0)
+    statistics.active--;
+  statistics.requests++;
+  statistics.totalTime += duration;
+  if (duration > statistics.maximumTime)
+    statistics.maximumTime = duration;
+}
+
+void CWebServer::GetStatistics(CVariant &statistics)
+{
+  statistics["threadpoolsize"] = g_advancedSettings.m_webserverThreadPoolSize;
+  statistics["connectionlimit"] = g_advancedSettings.m_webserverConnectionLimit;
+  statistics["handlerlimit"] = g_advancedSettings.m_webserverHandlerLimit;
+  statistics["handlers"] = CVariant(CVariant::VariantTypeArray);
+
+  CSingleLock lock(m_statisticsSection);
+  for (map<string, HandlerStatistics>::const_iterator it = m_handlerStatistics.begin(); it != m_handlerStatistics.end(); ++it)
+  {
+    CVariant handler(CVariant::VariantTypeObject);
+    handler["name"] = it->first;
+    handler["active"] = it->second.active;
+    handler["requests"] = it->second.requests;
+    handler["rejected"] = it->second.rejected;
+    handler["averagetime"] = it->second.requests > 0 ? (double)it->second.totalTime / it->second.requests : 0.0;
+    handler["maximumtime"] = it->second.maximumTime;
+
+    statistics["handlers"].push_back(handler);
+  }
+}
+
+int CWebServer::ExecuteRequest(IHTTPRequestHandler *handler, const HTTPRequest &request)
+{
   int ret = handler->HandleHTTPRequest(request);
   if (ret == MHD_NO)
   {
@@ -520,11 +603,26 @@ int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, co
         // set the initial write position
         context->writePosition = context->ranges.begin()->first;
 
-        // create the response object
-        response = MHD_create_response_from_callback(totalLength,
-                                                     2048,
-                                                     &CWebServer::ContentReaderCallback, context,
-                                                     &CWebServer::ContentReaderFreeCallback);
+        // single ranges of local files can be handed to libmicrohttpd as a
+        // file descriptor so we don't have to copy the data through CFile
+        if (context->rangeCount == 1)
+          response = CreateFileDescriptorResponse(strURL, context->ranges.front());
+
+        if (response != NULL)
+        {
+          // the CFile instance isn't needed to serve the data anymore
+          getData = false;
+          delete context;
+          context = NULL;
+        }
+        else
+        {
+          // create the response object
+          response = MHD_create_response_from_callback(totalLength,
+                                                       2048,
+                                                       &CWebServer::ContentReaderCallback, context,
+                                                       &CWebServer::ContentReaderFreeCallback);
+        }
       }
 
       if (response == NULL)
@@ -593,6 +691,51 @@ int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, co
   return MHD_YES;
 }
 
+struct MHD_Response* CWebServer::CreateFileDescriptorResponse(const std::string &strURL, const HttpRange &range)
+{
+#ifdef WEBSERVER_USE_SENDFILE
+  // only plain files on a local filesystem can be served from a file
+  // descriptor, everything else (network shares, archives, stacks etc)
+  // has to go through the VFS
+  if (URIUtils::IsStack(strURL))
+    return NULL;
+
+  std::string localPath = CSpecialProtocol::TranslatePath(strURL);
+  CURL url(localPath);
+  if (!url.GetProtocol().empty())
+    return NULL;
+
+  int fd = open(localPath.c_str(), O_RDONLY);
+  if (fd < 0)
+    return NULL;
+
+  // make sure the requested range is still valid for the file
+  struct stat statBuffer;
+  if (fstat(fd, &statBuffer) != 0 || !S_ISREG(statBuffer.st_mode) ||
+      range.first < 0 || range.second < range.first || range.second >= (int64_t)statBuffer.st_size)
+  {
+    close(fd);
+    return NULL;
+  }
+
+  // libmicrohttpd takes ownership of the file descriptor and closes it
+  // when the response is destroyed
+  struct MHD_Response *response = MHD_create_response_from_fd_at_offset(range.second - range.first + 1, fd, range.first);
+  if (response == NULL)
+  {
+    close(fd);
+    return NULL;
+  }
+
+#ifdef WEBSERVER_DEBUG
+  CLog::Log(LOGDEBUG, "webserver [OUT] serving %s (%" PRId64 " - %" PRId64 ") from file descriptor", localPath.c_str(), range.first, range.second);
+#endif
+  return response;
+#else
+  return NULL;
+#endif
+}
+
 int CWebServer::CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response)
 {
   size_t payloadSize = 0;
@@ -757,29 +900,48 @@ void CWebServer::ContentReaderFreeCallback(void *cls)
 struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
 {
   unsigned int timeout = 60 * 60 * 24;
+  unsigned int connectionLimit = g_advancedSettings.m_webserverConnectionLimit;
+
+#if (MHD_VERSION >= 0x00040002)
+  unsigned int threadPoolSize = g_advancedSettings.m_webserverThreadPoolSize;
+#if (MHD_VERSION < 0x00090B01)
+  // one thread per connection is unreliable with these versions so always
+  // use the main thread with a thread pool
+  if (threadPoolSize == 0)
+    threadPoolSize = 4;
+#endif
 
-  return MHD_start_daemon(flags |
-#if (MHD_VERSION >= 0x00040002) && (MHD_VERSION < 0x00090B01)
-                          // use main thread for each connection, can only handle one request at a
-                          // time [unless you set the thread pool size]
-                          MHD_USE_SELECT_INTERNALLY
-#else
-                          // one thread per connection
-                          // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
-                          // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
-                          MHD_USE_THREAD_PER_CONNECTION
+  if (threadPoolSize > 0)
+  {
+    // a fixed number of threads each handling their share of the connections
+#if defined(TARGET_LINUX) && (MHD_VERSION >= 0x00093300)
+    flags |= MHD_USE_EPOLL_LINUX_ONLY;
+#endif
+    CLog::Log(LOGDEBUG, "WebServer: using a thread pool of %u threads", threadPoolSize);
+    return MHD_start_daemon(flags | MHD_USE_SELECT_INTERNALLY,
+                            port,
+                            NULL,
+                            NULL,
+                            &CWebServer::AnswerToConnection,
+                            this,
+                            MHD_OPTION_THREAD_POOL_SIZE, threadPoolSize,
+                            MHD_OPTION_CONNECTION_LIMIT, connectionLimit,
+                            MHD_OPTION_CONNECTION_TIMEOUT, timeout,
+                            MHD_OPTION_URI_LOG_CALLBACK, &CWebServer::UriRequestLogger, this,
+                            MHD_OPTION_END);
+  }
 #endif
-                          ,
+
+  // one thread per connection
+  // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
+  // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
+  return MHD_start_daemon(flags | MHD_USE_THREAD_PER_CONNECTION,
                           port,
                           NULL,
                           NULL,
                           &CWebServer::AnswerToConnection,
                           this,
-
-#if (MHD_VERSION >= 0x00040002) && (MHD_VERSION < 0x00090B01)
-                          MHD_OPTION_THREAD_POOL_SIZE, 4,
-#endif
-                          MHD_OPTION_CONNECTION_LIMIT, 512,
+                          MHD_OPTION_CONNECTION_LIMIT, connectionLimit,
                           MHD_OPTION_CONNECTION_TIMEOUT, timeout,
                           MHD_OPTION_URI_LOG_CALLBACK, &CWebServer::UriRequestLogger, this,
                           MHD_OPTION_END);
@@ -28,6 +28,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <map>
 #include <vector>
 
 #include "interfaces/json-rpc/ITransportLayer.h"
@@ -65,6 +66,8 @@ public:
   static int GetRequestHeaderValues(struct MHD_Connection *connection, enum MHD_ValueKind kind, std::map<std::string, std::string> &headerValues);
   static int GetRequestHeaderValues(struct MHD_Connection *connection, enum MHD_ValueKind kind, std::multimap<std::string, std::string> &headerValues);
 
+  static void GetStatistics(CVariant &statistics);
+
 private:
   struct MHD_Daemon* StartMHD(unsigned int flags, int port);
   static int AskForAuthentication (struct MHD_Connection *connection);
@@ -100,9 +103,13 @@ private:
                              unsigned int size);
 #endif
   static int HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &request);
+  static int ExecuteRequest(IHTTPRequestHandler *handler, const HTTPRequest &request);
+  static bool BeginHandlerRequest(const std::string &handlerName);
+  static void EndHandlerRequest(const std::string &handlerName, unsigned int duration);
   static void ContentReaderFreeCallback (void *cls);
   static int CreateRedirect(struct MHD_Connection *connection, const std::string &strURL, struct MHD_Response *&response);
   static int CreateFileDownloadResponse(struct MHD_Connection *connection, const std::string &strURL, HTTPMethod methodType, struct MHD_Response *&response, int &responseCode);
+  static struct MHD_Response* CreateFileDescriptorResponse(const std::string &strURL, const HttpRange &range);
   static int CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response);
   static int CreateMemoryDownloadResponse(struct MHD_Connection *connection, void *data, size_t size, bool free, bool copy, struct MHD_Response *&response);
 
@@ -126,6 +133,19 @@ private:
   CCriticalSection m_critSection;
   static std::vector<IHTTPRequestHandler *> m_requestHandlers;
 
+  typedef struct HandlerStatistics
+  {
+    HandlerStatistics() : active(0), requests(0), rejected(0), totalTime(0), maximumTime(0) { }
+
+    unsigned int active;
+    uint64_t requests;
+    uint64_t rejected;
+    uint64_t totalTime;
+    unsigned int maximumTime;
+  } HandlerStatistics;
+  static std::map<std::string, HandlerStatistics> m_handlerStatistics;
+  static CCriticalSection m_statisticsSection;
+
   typedef struct ConnectionHandler
   {
     IHTTPRequestHandler *requestHandler;
@@ -21,7 +21,11 @@
 #include "HTTPImageHandler.h"
 #include "network/WebServer.h"
 #include "URL.h"
+#include "TextureCache.h"
+#include "TextureDatabase.h"
+#include "filesystem/File.h"
 #include "filesystem/ImageFile.h"
+#include "utils/StringUtils.h"
 
 using namespace std;
 
@@ -36,6 +40,33 @@ int CHTTPImageHandler::HandleHTTPRequest(const HTTPRequest &request)
   {
     m_path = request.url.substr(7);
 
+    // resized versions of an image can be requested with the "width" and
+    // "height" arguments. They are cached by the texture cache just like
+    // any other transformed image
+    map<string, string> arguments;
+    if (CWebServer::GetRequestHeaderValues(request.connection, MHD_GET_ARGUMENT_KIND, arguments) > 0)
+    {
+      CStdString resized = AddTransformOptions(m_path, arguments);
+      if (resized != m_path)
+      {
+        CTextureDetails details;
+        if (CTextureCache::Get().HasCachedImage(resized) &&
+            CTextureCache::Get().CacheImage(resized, details) && !details.file.empty())
+          return ServeCachedImage(request, details);
+
+        // resizing would hold up the webserver thread and all connections it
+        // serves, so it's left to the job manager and the original is served
+        // until the resized image is cached
+        CTextureCache::Get().BackgroundCacheImage(resized);
+      }
+    }
+
+    // serve cached images directly so that clients can revalidate them
+    CTextureDetails details;
+    if (StringUtils::StartsWith(m_path, "image://") &&
+        CTextureCache::Get().CacheImage(m_path, details) && !details.file.empty())
+      return ServeCachedImage(request, details);
+
     XFILE::CImageFile imageFile;
     if (imageFile.Exists(m_path))
     {
@@ -56,3 +87,108 @@ int CHTTPImageHandler::HandleHTTPRequest(const HTTPRequest &request)
 
   return MHD_YES;
 }
+
+int CHTTPImageHandler::ServeCachedImage(const HTTPRequest &request, const CTextureDetails &details)
+{
+  m_path = CTextureCache::GetCachedPath(details.file);
+
+  string etag = GetETag(m_path, details);
+  if (!etag.empty())
+  {
+    m_responseHeaderFields.insert(pair<string, string>("ETag", etag));
+
+    if (MatchesETag(CWebServer::GetRequestHeaderValue(request.connection, MHD_HEADER_KIND, "If-None-Match"), etag))
+    {
+      m_responseCode = MHD_HTTP_NOT_MODIFIED;
+      m_responseType = HTTPError;
+      return MHD_YES;
+    }
+  }
+
+  m_responseCode = MHD_HTTP_OK;
+  m_responseType = HTTPFileDownload;
+  return MHD_YES;
+}
+
+CStdString CHTTPImageHandler::AddTransformOptions(const CStdString &path, const map<string, string> &arguments)
+{
+  CStdString options;
+  for (map<string, string>::const_iterator argument = arguments.begin(); argument != arguments.end(); ++argument)
+  {
+    if (argument->first != "width" && argument->first != "height")
+      continue;
+
+    // only accept positive sizes
+    if (argument->second.empty() || argument->second.find_first_not_of("0123456789") != string::npos ||
+        strtoul(argument->second.c_str(), NULL, 10) == 0)
+      continue;
+
+    if (!options.empty())
+      options += "&";
+    options += argument->first + "=" + StringUtils::Format("%u", GetSizeBucket(strtoul(argument->second.c_str(), NULL, 10)));
+  }
+
+  if (options.empty())
+    return path;
+
+  CStdString image = path;
+  CStdString type;
+  if (StringUtils::StartsWith(path, "image://"))
+  {
+    CURL url(path);
+    image = url.GetHostName();
+    type = url.GetUserName();
+
+    // keep any existing transformations
+    CStdString existingOptions = url.GetOptions().empty() ? "" : url.GetOptions().substr(1);
+    StringUtils::TrimRight(existingOptions, "/");
+    if (!existingOptions.empty())
+      options = existingOptions + "&" + options;
+  }
+
+  return CTextureUtils::GetWrappedImageURL(image, type, options);
+}
+
+unsigned int CHTTPImageHandler::GetSizeBucket(unsigned long size)
+{
+  // sizes are rounded up to a few steps so that clients can't fill the
+  // texture cache with a variant for every size
+  static const unsigned int buckets[] = { 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1280, 1920 };
+  static const size_t count = sizeof(buckets) / sizeof(buckets[0]);
+  for (size_t i = 0; i < count; i++)
+  {
+    if (size <= buckets[i])
+      return buckets[i];
+  }
+  return buckets[count - 1];
+}
+
+string CHTTPImageHandler::GetETag(const CStdString &cachedPath, const CTextureDetails &details)
+{
+  // the cached file keeps its name when the image is recached so we need
+  // to include its modification time and size. The texture id isn't used
+  // as it's only known once the image has been added to the database
+  struct __stat64 statBuffer;
+  if (XFILE::CFile::Stat(cachedPath, &statBuffer) != 0)
+    return "";
+
+  CStdString hash = details.hash;
+  StringUtils::Replace(hash, "\"", "");
+  return StringUtils::Format("\"%s-%" PRIx64 "-%" PRIx64 "\"", hash.c_str(), (uint64_t)statBuffer.st_mtime, (uint64_t)statBuffer.st_size);
+}
+
+bool CHTTPImageHandler::MatchesETag(const string &ifNoneMatch, const string &etag)
+{
+  if (ifNoneMatch.empty() || etag.empty())
+    return false;
+
+  vector<string> etags = StringUtils::Split(ifNoneMatch, ",");
+  for (vector<string>::iterator it = etags.begin(); it != etags.end(); ++it)
+  {
+    StringUtils::Trim(*it);
+    if (*it == "*" || *it == etag)
+      return true;
+  }
+
+  return false;
+}
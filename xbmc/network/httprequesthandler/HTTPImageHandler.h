@@ -23,6 +23,8 @@
 
 #include "utils/StdString.h"
 
+class CTextureDetails;
+
 class CHTTPImageHandler : public IHTTPRequestHandler
 {
 public:
@@ -35,7 +37,14 @@ public:
   virtual std::string GetHTTPResponseFile() const { return m_path; }
 
   virtual int GetPriority() const { return 2; }
+  virtual std::string GetName() const { return "image"; }
 
 private:
+  int ServeCachedImage(const HTTPRequest &request, const CTextureDetails &details);
+  static CStdString AddTransformOptions(const CStdString &path, const std::map<std::string, std::string> &arguments);
+  static unsigned int GetSizeBucket(unsigned long size);
+  static std::string GetETag(const CStdString &cachedPath, const CTextureDetails &details);
+  static bool MatchesETag(const std::string &ifNoneMatch, const std::string &etag);
+
   CStdString m_path;
 };
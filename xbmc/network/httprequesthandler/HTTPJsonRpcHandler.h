@@ -35,6 +35,7 @@ public:
   virtual size_t GetHTTPResonseDataLength() const { return m_response.size(); }
 
   virtual int GetPriority() const { return 2; }
+  virtual std::string GetName() const { return "jsonrpc"; }
 
 protected:
 #if (MHD_VERSION >= 0x00040001)
@@ -78,6 +78,8 @@ public:
 
   // The higher the more important
   virtual int GetPriority() const { return 0; }
+  // Identifies the handler in the webserver's statistics
+  virtual std::string GetName() const = 0;
 
   void AddPostField(const std::string &key, const std::string &value);
 #if (MHD_VERSION >= 0x00040001)
@@ -0,0 +1,312 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "SmartPlaylistCache.h"
+#include "dbwrappers/Database.h"
+#include "dbwrappers/sqlitedataset.h"
+#include "interfaces/AnnouncementManager.h"
+#include "threads/SingleLock.h"
+#include "utils/DatabaseUtils.h"
+#include "utils/log.h"
+#include "utils/md5.h"
+#include "utils/StringUtils.h"
+#include "utils/Variant.h"
+
+// playlists whose results are kept per database
+#define SMARTPLAYLISTCACHE_MAX_PLAYLISTS    50
+// changes kept for playlists that haven't been used since
+#define SMARTPLAYLISTCACHE_MAX_CHANGES      1000
+// changed items checked one by one, the playlist is run in full above that
+#define SMARTPLAYLISTCACHE_MAX_INCREMENTAL  100
+
+using namespace ANNOUNCEMENT;
+
+CSmartPlaylistChanges::CSmartPlaylistChanges()
+{
+  m_sequence = 0;
+  m_dropped = 0;
+  m_read = 0;
+}
+
+void CSmartPlaylistChanges::AddDatabase(const std::string &database, AnnouncementFlag library)
+{
+  CSingleLock lock(m_critSection);
+  m_databases[database] = library;
+}
+
+void CSmartPlaylistChanges::OnWrite(const std::string &database, const std::string &table, int id)
+{
+  CSingleLock lock(m_critSection);
+  std::map<std::string, AnnouncementFlag>::const_iterator it = m_databases.find(database);
+  if (it == m_databases.end())
+    return;
+
+  // the stored results themselves, and the art no rule selects on
+  if (table == "smartplaylist" || table == "smartplaylistlink" || table == "art")
+    return;
+
+  static const char *items[] = { MediaTypeMovie, MediaTypeTvShow, MediaTypeEpisode, MediaTypeMusicVideo,
+                                 MediaTypeSong, MediaTypeAlbum, MediaTypeArtist };
+  for (unsigned int i = 0; i < sizeof(items) / sizeof(items[0]); i++)
+  {
+    if (table == items[i])
+    {
+      AddItemChange(table, id);
+      return;
+    }
+  }
+
+  // e.g. the files with their play counts, the bookmarks or the genres linked to the items
+  AddLibraryChange(it->second);
+}
+
+void CSmartPlaylistChanges::AddItemChange(const MediaType &mediaType, int id)
+{
+  CSingleLock lock(m_critSection);
+  AddChange(mediaType, id);
+
+  // the views of these types contain details of the changed item
+  if (mediaType == MediaTypeEpisode)
+    AddChange(MediaTypeTvShow, 0);
+  else if (mediaType == MediaTypeTvShow)
+    AddChange(MediaTypeEpisode, 0);
+  else if (mediaType == MediaTypeSong)
+  {
+    AddChange(MediaTypeAlbum, 0);
+    AddChange(MediaTypeArtist, 0);
+  }
+  else if (mediaType == MediaTypeAlbum)
+  {
+    AddChange(MediaTypeSong, 0);
+    AddChange(MediaTypeArtist, 0);
+  }
+  else if (mediaType == MediaTypeArtist)
+  {
+    AddChange(MediaTypeSong, 0);
+    AddChange(MediaTypeAlbum, 0);
+  }
+}
+
+void CSmartPlaylistChanges::AddLibraryChange(AnnouncementFlag library)
+{
+  CSingleLock lock(m_critSection);
+  if (library == VideoLibrary)
+  {
+    AddChange(MediaTypeMovie, 0);
+    AddChange(MediaTypeTvShow, 0);
+    AddChange(MediaTypeEpisode, 0);
+    AddChange(MediaTypeMusicVideo, 0);
+  }
+  else
+  {
+    AddChange(MediaTypeSong, 0);
+    AddChange(MediaTypeAlbum, 0);
+    AddChange(MediaTypeArtist, 0);
+  }
+}
+
+void CSmartPlaylistChanges::AddChange(const MediaType &mediaType, int id)
+{
+  // every playlist of the type is run in full already, or the item is checked already
+  std::map<MediaType, unsigned int>::const_iterator full = m_full.find(mediaType);
+  if (full != m_full.end() && full->second > m_read)
+    return;
+  if (id > 0 && !m_changes.empty() && m_changes.back().sequence > m_read &&
+      m_changes.back().mediaType == mediaType && m_changes.back().id == id)
+    return;
+
+  Change change;
+  change.sequence = ++m_sequence;
+  change.mediaType = mediaType;
+  change.id = id;
+  m_changes.push_back(change);
+  if (id <= 0)
+    m_full[mediaType] = change.sequence;
+
+  while (m_changes.size() > SMARTPLAYLISTCACHE_MAX_CHANGES)
+  {
+    m_dropped = m_changes.front().sequence;
+    m_changes.pop_front();
+  }
+}
+
+bool CSmartPlaylistChanges::GetChanges(const MediaType &mediaType, unsigned int &sequence, std::set<int> &ids)
+{
+  CSingleLock lock(m_critSection);
+  bool complete = sequence >= m_dropped;
+  for (std::deque<Change>::const_reverse_iterator it = m_changes.rbegin(); it != m_changes.rend() && it->sequence > sequence; ++it)
+  {
+    if (it->mediaType != mediaType)
+      continue;
+    if (it->id <= 0)
+      complete = false;
+    else
+      ids.insert(it->id);
+  }
+
+  sequence = m_read = m_sequence;
+  return complete;
+}
+
+CSmartPlaylistCache::CSmartPlaylistCache()
+{
+  m_useCounter = 0;
+  CAnnouncementManager::Get().AddAnnouncer(this);
+  dbiplus::SqliteDatabase::setChangeHandler(OnWrite);
+}
+
+CSmartPlaylistCache::~CSmartPlaylistCache()
+{
+  dbiplus::SqliteDatabase::setChangeHandler(NULL);
+  CAnnouncementManager::Get().RemoveAnnouncer(this);
+}
+
+CSmartPlaylistCache &CSmartPlaylistCache::Get()
+{
+  static CSmartPlaylistCache sSmartPlaylistCache;
+  return sSmartPlaylistCache;
+}
+
+std::string CSmartPlaylistCache::GetWhereClause(CDatabase &db, const std::string &database, const MediaType &mediaType, const std::string &where)
+{
+  std::string idField = DatabaseUtils::GetField(FieldId, mediaType, DatabaseQueryPartWhere);
+  if (where.empty() || idField.find('.') == std::string::npos)
+    return where;
+
+  std::string hash = XBMC::XBMC_MD5::GetMD5(mediaType + where);
+
+  CSingleLock lock(m_critSection);
+  std::map<std::string, PlaylistMap>::iterator playlists = m_databases.find(database);
+  if (playlists == m_databases.end())
+  {
+    // results stored by an earlier run miss the changes made since
+    if (!db.ExecuteQuery("DELETE FROM smartplaylistlink") ||
+        !db.ExecuteQuery("DELETE FROM smartplaylist"))
+      return where;
+    playlists = m_databases.insert(std::make_pair(database, PlaylistMap())).first;
+    bool music = mediaType == MediaTypeSong || mediaType == MediaTypeAlbum || mediaType == MediaTypeArtist;
+    m_changes.AddDatabase(database, music ? AudioLibrary : VideoLibrary);
+  }
+
+  std::set<int> ids;
+  bool full = true;
+  PlaylistMap::iterator playlist = playlists->second.find(hash);
+  if (playlist == playlists->second.end())
+  {
+    if (playlists->second.size() >= SMARTPLAYLISTCACHE_MAX_PLAYLISTS)
+    {
+      PlaylistMap::iterator oldest = playlists->second.begin();
+      for (PlaylistMap::iterator it = playlists->second.begin(); it != playlists->second.end(); ++it)
+      {
+        if (it->second.lastUsed < oldest->second.lastUsed)
+          oldest = it;
+      }
+      Remove(db, oldest->second);
+      playlists->second.erase(oldest);
+    }
+
+    Playlist entry;
+    entry.id = -1;
+    entry.hash = hash;
+    entry.sequence = 0;
+    if (db.ExecuteQuery(db.PrepareSQL("INSERT INTO smartplaylist (idPlaylist, strHash, media_type) VALUES (NULL, '%s', '%s')", hash.c_str(), mediaType.c_str())))
+      entry.id = atoi(db.GetSingleValue(db.PrepareSQL("SELECT idPlaylist FROM smartplaylist WHERE strHash = '%s'", hash.c_str())).c_str());
+    if (entry.id <= 0)
+      return where;
+
+    playlist = playlists->second.insert(std::make_pair(hash, entry)).first;
+    m_changes.GetChanges(mediaType, playlist->second.sequence, ids);
+  }
+  else
+  {
+    full = !m_changes.GetChanges(mediaType, playlist->second.sequence, ids) || ids.size() > SMARTPLAYLISTCACHE_MAX_INCREMENTAL;
+  }
+  playlist->second.lastUsed = ++m_useCounter;
+
+  if ((full || !ids.empty()) &&
+      !Refresh(db, playlist->second, idField, where, full ? NULL : &ids))
+  {
+    CLog::Log(LOGWARNING, "%s - unable to store the results of smart playlist %s", __FUNCTION__, hash.c_str());
+    Remove(db, playlist->second);
+    playlists->second.erase(playlist);
+    return where;
+  }
+
+  return db.PrepareSQL("%s IN (SELECT idMedia FROM smartplaylistlink WHERE idPlaylist = %i)", idField.c_str(), playlist->second.id);
+}
+
+bool CSmartPlaylistCache::Refresh(CDatabase &db, const Playlist &playlist, const std::string &idField, const std::string &where, const std::set<int> *ids)
+{
+  std::string table = idField.substr(0, idField.find('.'));
+  if (ids == NULL)
+  {
+    return db.ExecuteQuery(db.PrepareSQL("DELETE FROM smartplaylistlink WHERE idPlaylist = %i", playlist.id)) &&
+           db.ExecuteQuery(db.PrepareSQL("INSERT INTO smartplaylistlink (idPlaylist, idMedia) SELECT %i, %s FROM %s", playlist.id, idField.c_str(), table.c_str()) +
+                           " WHERE (" + where + ")");
+  }
+
+  std::string list;
+  for (std::set<int>::const_iterator it = ids->begin(); it != ids->end(); ++it)
+  {
+    if (!list.empty())
+      list += ",";
+    list += StringUtils::Format("%i", *it);
+  }
+
+  // removed items and items no longer matching drop out, matching ones are added back
+  return db.ExecuteQuery(db.PrepareSQL("DELETE FROM smartplaylistlink WHERE idPlaylist = %i", playlist.id) + " AND idMedia IN (" + list + ")") &&
+         db.ExecuteQuery(db.PrepareSQL("INSERT INTO smartplaylistlink (idPlaylist, idMedia) SELECT %i, %s FROM %s", playlist.id, idField.c_str(), table.c_str()) +
+                         " WHERE " + idField + " IN (" + list + ") AND (" + where + ")");
+}
+
+void CSmartPlaylistCache::Remove(CDatabase &db, const Playlist &playlist)
+{
+  db.ExecuteQuery(db.PrepareSQL("DELETE FROM smartplaylistlink WHERE idPlaylist = %i", playlist.id));
+  db.ExecuteQuery(db.PrepareSQL("DELETE FROM smartplaylist WHERE idPlaylist = %i", playlist.id));
+}
+
+void CSmartPlaylistCache::OnWrite(const char *host, const char *database, const char *table, int64_t rowid)
+{
+  Get().m_changes.OnWrite(std::string(host) + database, table, (int)rowid);
+}
+
+void CSmartPlaylistCache::Announce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+{
+  if (flag != VideoLibrary && flag != AudioLibrary)
+    return;
+
+  if (strcmp(message, "OnUpdate") != 0 && strcmp(message, "OnRemove") != 0)
+  {
+    if (strcmp(message, "OnScanFinished") == 0 || strcmp(message, "OnCleanFinished") == 0)
+      m_changes.AddLibraryChange(flag);
+    return;
+  }
+
+  const CVariant &item = data.isMember("item") ? data["item"] : data;
+  MediaType mediaType = item.isMember("type") ? MediaTypes::FromString(item["type"].asString()) : MediaTypeNone;
+  int id = item.isMember("id") ? (int)item["id"].asInteger() : 0;
+  if (mediaType == MediaTypeNone || id <= 0)
+    m_changes.AddLibraryChange(flag);
+  else
+    m_changes.AddItemChange(mediaType, id);
+}
@@ -0,0 +1,159 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <deque>
+#include <map>
+#include <set>
+#include <stdint.h>
+#include <string>
+
+#include "interfaces/IAnnouncer.h"
+#include "media/MediaType.h"
+#include "threads/CriticalSection.h"
+
+class CDatabase;
+
+/*!
+ \brief The changes made to the libraries, in the order they were made.
+
+ Changes come from the library announcements and from the rows written to the
+ databases the smart playlists are run on, as not every change is announced, e.g.
+ play counts and resume points aren't. The writes are reported by sqlite, changes
+ made by other processes, e.g. to a shared MySQL database, can't be followed.
+ */
+class CSmartPlaylistChanges
+{
+public:
+  CSmartPlaylistChanges();
+
+  /*! \brief Follow the writes to a database.
+   \param database a name identifying the database, its host and name.
+   \param library the library kept in the database, VideoLibrary or AudioLibrary.
+   */
+  void AddDatabase(const std::string &database, ANNOUNCEMENT::AnnouncementFlag library);
+
+  /*! \brief Record a row written to a database.
+   Writes to databases not followed with AddDatabase are ignored.
+   \param database a name identifying the database, its host and name.
+   \param table the table the row was written to.
+   \param id the rowid of the row.
+   */
+  void OnWrite(const std::string &database, const std::string &table, int id);
+
+  /*! \brief Record a change of an item, and of the items whose details include it,
+   e.g. the tvshow of an episode.
+   \param mediaType the type of the item.
+   \param id the id of the item, 0 if all items of the type may have changed.
+   */
+  void AddItemChange(const MediaType &mediaType, int id);
+
+  /*! \brief Record that all items of a library may have changed.
+   */
+  void AddLibraryChange(ANNOUNCEMENT::AnnouncementFlag library);
+
+  /*! \brief Get the items changed since a playlist was last used.
+   \param mediaType the type of the items of the playlist.
+   \param sequence [in/out] the last change the results of the playlist include, set to the current change.
+   \param ids [out] the items that changed.
+   \return false if the results need to be stored in full, true otherwise.
+   */
+  bool GetChanges(const MediaType &mediaType, unsigned int &sequence, std::set<int> &ids);
+
+private:
+  struct Change
+  {
+    unsigned int sequence;
+    MediaType mediaType;
+    int id;                 ///< 0 if all items of the type may have changed
+  };
+
+  void AddChange(const MediaType &mediaType, int id);
+
+  std::map<std::string, ANNOUNCEMENT::AnnouncementFlag> m_databases;
+  std::deque<Change> m_changes;
+  std::map<MediaType, unsigned int> m_full; ///< last change of all items, per type
+  unsigned int m_sequence;
+  unsigned int m_dropped;   ///< last change no longer in m_changes
+  unsigned int m_read;      ///< last change returned by GetChanges
+  CCriticalSection m_critSection;
+};
+
+/*!
+ \brief Keeps the results of smart playlists in the database they're run on.
+
+ The ids of the items matching a smart playlist are stored in the smartplaylistlink
+ table, keyed by a hash of the playlist's WHERE clause. Listing the playlist again
+ then only needs to look up the stored ids instead of running the rules. Playlists
+ included by a rule are part of the WHERE clause, so changing them changes the hash.
+
+ The library announcements and the writes to the database are followed to keep the
+ results up to date. Items that were updated or removed are checked against the
+ rules again on the next use of a playlist. Changes that can't be traced to single
+ items, like a finished scan or a changed play count, cause the playlists of the
+ affected media types to be run again in full.
+
+ Changes made to the database by other processes aren't seen, so the results
+ must only be used for databases that aren't shared.
+ */
+class CSmartPlaylistCache : public ANNOUNCEMENT::IAnnouncer
+{
+public:
+  static CSmartPlaylistCache &Get();
+
+  /*! \brief Get a WHERE clause selecting the stored results of a smart playlist.
+   The results are stored when the playlist is first used, and brought up to date
+   with the changes made since its last use.
+   \param db the database to run the playlist on.
+   \param database a name identifying the database, e.g. its host and name.
+   \param mediaType the type of the items the playlist selects.
+   \param where the WHERE clause of the playlist.
+   \return the WHERE clause selecting the stored results, the given one if they can't be stored.
+   */
+  std::string GetWhereClause(CDatabase &db, const std::string &database, const MediaType &mediaType, const std::string &where);
+
+  virtual void Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+
+private:
+  CSmartPlaylistCache();
+  CSmartPlaylistCache(const CSmartPlaylistCache&);
+  CSmartPlaylistCache const& operator=(CSmartPlaylistCache const&);
+  virtual ~CSmartPlaylistCache();
+
+  struct Playlist
+  {
+    int id;
+    std::string hash;
+    unsigned int sequence;  ///< last change the results include
+    unsigned int lastUsed;
+  };
+  typedef std::map<std::string, Playlist> PlaylistMap;
+
+  static void OnWrite(const char *host, const char *database, const char *table, int64_t rowid);
+
+  static bool Refresh(CDatabase &db, const Playlist &playlist, const std::string &idField, const std::string &where, const std::set<int> *ids);
+  static void Remove(CDatabase &db, const Playlist &playlist);
+
+  std::map<std::string, PlaylistMap> m_databases;
+  unsigned int m_useCounter;
+  CCriticalSection m_critSection;
+
+  CSmartPlaylistChanges m_changes;
+};
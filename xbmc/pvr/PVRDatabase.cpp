@@ -768,15 +768,32 @@ bool CPVRDatabase::PersistGroupMembers(CPVRChannelGroup &group)
 
   if (group.m_members.size() > 0)
   {
+    /* load the stored members of this group at once, so we only have to write the ones that changed */
+    set<pair<int, int> > storedMembers;
+    if (group.GroupID() > 0 &&
+        ResultQuery(PrepareSQL("SELECT idChannel, iChannelNumber FROM map_channelgroups_channels WHERE idGroup = %u", group.GroupID())))
+    {
+      try
+      {
+        while (!m_pDS->eof())
+        {
+          storedMembers.insert(make_pair(m_pDS->fv("idChannel").get_asInt(), m_pDS->fv("iChannelNumber").get_asInt()));
+          m_pDS->next();
+        }
+        m_pDS->close();
+      }
+      catch (...)
+      {
+        CLog::Log(LOGERROR, "PVR - %s - couldn't load the members of group '%s' from the database", __FUNCTION__, group.GroupName().c_str());
+        storedMembers.clear();
+      }
+    }
+
     for (unsigned int iChannelPtr = 0; iChannelPtr < group.m_members.size(); iChannelPtr++)
     {
       PVRChannelGroupMember member = group.m_members.at(iChannelPtr);
 
-      CStdString strWhereClause = PrepareSQL("idChannel = %u AND idGroup = %u AND iChannelNumber = %u",
-          member.channel->ChannelID(), group.GroupID(), member.iChannelNumber);
-
-      CStdString strValue = GetSingleValue("map_channelgroups_channels", "idChannel", strWhereClause);
-      if (strValue.empty())
+      if (storedMembers.find(make_pair(member.channel->ChannelID(), (int)member.iChannelNumber)) == storedMembers.end())
       {
         strQuery = PrepareSQL("REPLACE INTO map_channelgroups_channels ("
             "idGroup, idChannel, iChannelNumber) "
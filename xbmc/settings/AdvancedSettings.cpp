@@ -26,6 +26,7 @@
 #include "network/DNSNameCache.h"
 #include "filesystem/File.h"
 #include "utils/LangCodeExpander.h"
+#include "utils/RegExpCache.h"
 #include "LangInfo.h"
 #include "profiles/ProfilesManager.h"
 #include "settings/lib/Setting.h"
@@ -164,6 +165,9 @@ void CAdvancedSettings::Initialize()
   m_DXVAForceProcessorRenderer = true;
   m_DXVANoDeintProcForProgressive = false;
   m_videoFpsDetect = 1;
+  m_videoProbeCache = true;
+  m_videoSoftwareVblank = 0.0f;
+  m_videoThreadingRules.clear();
   m_videoBusyDialogDelay_ms = 500;
   m_stagefrightConfig.useAVCcodec = -1;
   m_stagefrightConfig.useVC1codec = -1;
@@ -282,6 +286,7 @@ void CAdvancedSettings::Initialize()
   m_bVideoLibraryImportWatchedState = false;
   m_bVideoLibraryImportResumePoint = false;
   m_bVideoScannerIgnoreErrors = false;
+  m_iVideoScannerPrefetchJobs = 2;
   m_iVideoLibraryDateAdded = 1; // prefer mtime over ctime and current time
 
   m_iTuxBoxStreamtsPort = 31339;
@@ -369,11 +374,19 @@ void CAdvancedSettings::Initialize()
   // the following setting determines the readRate of a player data
   // as multiply of the default data read rate
   m_readBufferFactor = 1.0f;
+  // number of parallel connections used to fill the cache of large http files, 1 disables it
+  m_cacheConnections = 1;
   m_addonPackageFolderSize = 200;
 
   m_jsonOutputCompact = true;
   m_jsonTcpPort = 9090;
 
+  m_webserverThreadPoolSize = 0;
+  m_webserverConnectionLimit = 512;
+  m_webserverHandlerLimit = 0;
+
+  m_pythonInterpreterPool = 1;
+
   m_enableMultimediaKeys = false;
 
   m_canWindowed = true;
@@ -385,6 +398,10 @@ void CAdvancedSettings::Initialize()
 
   m_databaseMusic.Reset();
   m_databaseVideo.Reset();
+  m_databaseConnections = 4;
+  m_smartPlaylistCache = false;
+  m_changeJournal = true;
+  m_scraperCacheTime = 3600;
 
   m_pictureExtensions = ".png|.jpg|.jpeg|.bmp|.gif|.ico|.tif|.tiff|.tga|.pcx|.cbz|.zip|.cbr|.rar|.dng|.nef|.cr2|.crw|.orf|.arw|.erf|.3fr|.dcr|.x3f|.mef|.raf|.mrw|.pef|.sr2|.rss";
   m_musicExtensions = ".nsv|.m4a|.flac|.aac|.strm|.pls|.rm|.rma|.mpa|.wav|.wma|.ogg|.mp3|.mp2|.m3u|.mod|.amf|.669|.dmf|.dsm|.far|.gdm|.imf|.it|.m15|.med|.okt|.s3m|.stm|.sfx|.ult|.uni|.xm|.sid|.ac3|.dts|.cue|.aif|.aiff|.wpl|.ape|.mac|.mpc|.mp+|.mpp|.shn|.zip|.rar|.wv|.nsf|.spc|.gym|.adx|.dsp|.adp|.ymf|.ast|.afc|.hps|.xsp|.xwav|.waa|.wvs|.wam|.gcm|.idsp|.mpdsp|.mss|.spt|.rsd|.mid|.kar|.sap|.cmc|.cmr|.dmc|.mpt|.mpd|.rmt|.tmc|.tm8|.tm2|.oga|.url|.pxml|.tta|.rss|.cm3|.cms|.dlt|.brstm|.wtv|.mka|.tak|.m4b";
@@ -436,6 +453,9 @@ bool CAdvancedSettings::Load()
   if (!m_discStubExtensions.empty())
     m_videoExtensions += "|" + m_discStubExtensions;
 
+  // the expressions compiled from the old settings are of no use anymore
+  CRegExpCache::Get().Clear();
+
   return true;
 }
 
@@ -700,11 +720,54 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement,"dxvanodeintforprogressive", m_DXVANoDeintProcForProgressive);
     //0 = disable fps detect, 1 = only detect on timestamps with uniform spacing, 2 detect on all timestamps
     XMLUtils::GetInt(pElement, "fpsdetect", m_videoFpsDetect, 0, 2);
+    // remember the stream layout of probed files to speed up opening them again
+    XMLUtils::GetBoolean(pElement, "probecache", m_videoProbeCache);
+    // drive the reference clock from a timer instead of the display, e.g. for headless testing
+    XMLUtils::GetFloat(pElement, "softwarevblank", m_videoSoftwareVblank, 0.0f, 240.0f);
 
     // controls the delay, in milliseconds, until
     // the busy dialog is shown when starting video playback.
     XMLUtils::GetInt(pElement, "busydialogdelayms", m_videoBusyDialogDelay_ms, 0, 1000);
 
+    // explicit threading of the ffmpeg video decoders, the first matching rule is used
+    TiXmlElement* pVideoThreading = pElement->FirstChildElement("threading");
+    if (pVideoThreading)
+    {
+      m_videoThreadingRules.clear();
+      TiXmlElement* pThreadingRule = pVideoThreading->FirstChildElement("rule");
+      while (pThreadingRule)
+      {
+        VideoThreadingRule rule;
+        rule.minheight = 0;
+        rule.maxheight = 0;
+        rule.threads = 0;
+
+        CStdString type;
+        XMLUtils::GetString(pThreadingRule, "codec", rule.codec);
+        XMLUtils::GetInt(pThreadingRule, "minheight", rule.minheight, 0, 8192);
+        XMLUtils::GetInt(pThreadingRule, "maxheight", rule.maxheight, 0, 8192);
+        XMLUtils::GetInt(pThreadingRule, "threads", rule.threads, 0, 16);
+        XMLUtils::GetString(pThreadingRule, "type", type);
+
+        bool valid = true;
+        if (type.Equals("frame"))
+          rule.type = VIDEO_THREADING_FRAME;
+        else if (type.Equals("slice"))
+          rule.type = VIDEO_THREADING_SLICE;
+        else if (type.Equals("none"))
+          rule.type = VIDEO_THREADING_NONE;
+        else
+          valid = false;
+
+        if (valid && (rule.maxheight == 0 || rule.maxheight >= rule.minheight))
+          m_videoThreadingRules.push_back(rule);
+        else
+          CLog::Log(LOGWARNING, "Ignoring malformed video threading <rule> entry, codec:%s type:%s", rule.codec.c_str(), type.c_str());
+
+        pThreadingRule = pThreadingRule->NextSiblingElement("rule");
+      }
+    }
+
     // Store global display latency settings
     TiXmlElement* pVideoLatency = pElement->FirstChildElement("latency");
     if (pVideoLatency)
@@ -776,6 +839,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   if (pElement)
   {
     XMLUtils::GetBoolean(pElement, "ignoreerrors", m_bVideoScannerIgnoreErrors);
+    XMLUtils::GetInt(pElement, "prefetchjobs", m_iVideoScannerPrefetchJobs, 0, 8);
   }
 
   // Backward-compatibility of ExternalPlayer config
@@ -802,6 +866,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetUInt(pElement, "cachemembuffersize", m_cacheMemBufferSize);
     XMLUtils::GetUInt(pElement, "buffermode", m_networkBufferMode, 0, 3);
     XMLUtils::GetFloat(pElement, "readbufferfactor", m_readBufferFactor);
+    XMLUtils::GetUInt(pElement, "cacheconnections", m_cacheConnections, 1, 8);
   }
 
   pElement = pRootElement->FirstChildElement("jsonrpc");
@@ -811,6 +876,18 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetUInt(pElement, "tcpport", m_jsonTcpPort);
   }
 
+  pElement = pRootElement->FirstChildElement("webserver");
+  if (pElement)
+  {
+    XMLUtils::GetUInt(pElement, "threadpoolsize", m_webserverThreadPoolSize, 0, 64);
+    XMLUtils::GetUInt(pElement, "connectionlimit", m_webserverConnectionLimit, 1, 4096);
+    XMLUtils::GetUInt(pElement, "handlerlimit", m_webserverHandlerLimit, 0, 1024);
+  }
+
+  pElement = pRootElement->FirstChildElement("python");
+  if (pElement)
+    XMLUtils::GetUInt(pElement, "interpreterpool", m_pythonInterpreterPool, 0, 4);
+
   pElement = pRootElement->FirstChildElement("samba");
   if (pElement)
   {
@@ -1168,6 +1245,11 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetString(pDatabase, "ciphers", m_databaseEpg.ciphers);
   }
 
+  XMLUtils::GetUInt(pRootElement, "databaseconnections", m_databaseConnections, 0, 16);
+  XMLUtils::GetBoolean(pRootElement, "smartplaylistcache", m_smartPlaylistCache);
+  XMLUtils::GetBoolean(pRootElement, "changejournal", m_changeJournal);
+  XMLUtils::GetUInt(pRootElement, "scrapercachetime", m_scraperCacheTime, 0, 30 * 24 * 3600);
+
   pElement = pRootElement->FirstChildElement("enablemultimediakeys");
   if (pElement)
   {
@@ -97,6 +97,23 @@ struct RefreshVideoLatency
   float delay;
 };
 
+enum VideoThreadingType
+{
+  VIDEO_THREADING_NONE = 0,
+  VIDEO_THREADING_SLICE,
+  VIDEO_THREADING_FRAME
+};
+
+struct VideoThreadingRule
+{
+  std::string codec;  // ffmpeg decoder name, empty to match all decoders
+  int minheight;
+  int maxheight;      // 0 for no limit
+
+  VideoThreadingType type;
+  int threads;        // 0 to use one thread per cpu
+};
+
 struct StagefrightConfig
 {
   int useAVCcodec;
@@ -194,8 +211,11 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_DXVAForceProcessorRenderer;
     bool m_DXVANoDeintProcForProgressive;
     int  m_videoFpsDetect;
+    bool m_videoProbeCache;
+    float m_videoSoftwareVblank;
     int  m_videoBusyDialogDelay_ms;
     bool m_videoDisableSWMultithreading;
+    std::vector<VideoThreadingRule> m_videoThreadingRules;
     StagefrightConfig m_stagefrightConfig;
     bool m_mediacodecForceSoftwareRendring;
 
@@ -284,6 +304,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_bVideoLibraryImportResumePoint;
 
     bool m_bVideoScannerIgnoreErrors;
+    int m_iVideoScannerPrefetchJobs;
     int m_iVideoLibraryDateAdded;
 
     std::vector<CStdString> m_vecTokens; // cleaning strings tied to language
@@ -374,6 +395,10 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     DatabaseSettings m_databaseVideo; // advanced video database setup
     DatabaseSettings m_databaseTV;    // advanced tv database setup
     DatabaseSettings m_databaseEpg;   /*!< advanced EPG database setup */
+    unsigned int m_databaseConnections; // idle connections kept per database, 0 = disabled
+    bool m_smartPlaylistCache; // keep the results of smart playlists in local databases
+    bool m_changeJournal; // watch local sources so unchanged folders are skipped by the scanners
+    unsigned int m_scraperCacheTime; // seconds scraper responses are used without asking the site again, 0 = disabled
 
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
@@ -383,10 +408,17 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     unsigned int m_cacheMemBufferSize;
     unsigned int m_networkBufferMode;
     float m_readBufferFactor;
+    unsigned int m_cacheConnections;
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
 
+    unsigned int m_webserverThreadPoolSize; // 0 = one thread per connection
+    unsigned int m_webserverConnectionLimit;
+    unsigned int m_webserverHandlerLimit;   // concurrent requests per request handler, 0 = unlimited
+
+    unsigned int m_pythonInterpreterPool;   // python interpreters kept ready for scripts, 0 = disabled
+
     bool m_enableMultimediaKeys;
     std::vector<CStdString> m_settingsFiles;
     void ParseSettingsFile(const CStdString &file);
@@ -390,6 +390,70 @@ std::string CSettings::GetString(const std::string &id) const
   return m_settingsManager->GetString(id);
 }
 
+bool CSettings::GetBool(const CSettingHandle &handle) const
+{
+  CSetting *setting = GetSetting(handle, SettingTypeBool);
+  if (setting == NULL)
+    return false;
+
+  return ((CSettingBool*)setting)->GetValue();
+}
+
+int CSettings::GetInt(const CSettingHandle &handle) const
+{
+  CSetting *setting = GetSetting(handle, SettingTypeInteger);
+  if (setting == NULL)
+    return 0;
+
+  return ((CSettingInt*)setting)->GetValue();
+}
+
+double CSettings::GetNumber(const CSettingHandle &handle) const
+{
+  CSetting *setting = GetSetting(handle, SettingTypeNumber);
+  if (setting == NULL)
+    return 0.0;
+
+  return ((CSettingNumber*)setting)->GetValue();
+}
+
+std::string CSettings::GetString(const CSettingHandle &handle) const
+{
+  CSetting *setting = GetSetting(handle, SettingTypeString);
+  if (setting == NULL)
+    return "";
+
+  return ((CSettingString*)setting)->GetValue();
+}
+
+CSetting* CSettings::GetSetting(const CSettingHandle &handle, int type) const
+{
+  // clearing the settings changes the generation but keeps the cleared settings allocated
+  unsigned int generation = m_settingsManager->GetGeneration();
+  {
+    CSingleLock lock(handle.m_critical);
+    if (handle.m_generation == generation)
+      return handle.m_setting;
+  }
+
+  // resolve outside of the handle's lock as the settings manager may be locked by a reader of the handle
+  CSetting *setting = m_settingsManager->GetSetting(handle.m_id);
+  // an unknown setting may still be registered later on
+  if (setting == NULL)
+    return NULL;
+
+  if (setting->GetType() != type)
+  {
+    CLog::Log(LOGWARNING, "CSettings: setting \"%s\" has an unexpected type", handle.m_id);
+    setting = NULL;
+  }
+
+  CSingleLock lock(handle.m_critical);
+  handle.m_setting = setting;
+  handle.m_generation = generation;
+  return setting;
+}
+
 bool CSettings::SetString(const std::string &id, const std::string &value)
 {
   return m_settingsManager->SetString(id, value);
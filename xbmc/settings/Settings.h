@@ -38,6 +38,40 @@ class CSettingsManager;
 class TiXmlElement;
 class TiXmlNode;
 
+/*!
+ \brief Reference to a setting which is only looked up once.
+
+ Looking up a setting by its identifier locks the settings manager and searches
+ its map. Code which reads a setting very often (e.g. per frame or per packet)
+ should keep a static handle instead. The handle remembers the setting it was
+ resolved to and only looks it up again after the settings have been cleared.
+
+ Reads through a handle are not lock-free: they take the handle's own short
+ lock and the setting's reader lock, but skip the settings manager's lock and
+ map lookup. A read racing
+ CSettingsManager::Clear() may return the value of the cleared setting, which
+ stays allocated until the settings manager is destroyed.
+ \sa CSettings
+ */
+class CSettingHandle
+{
+public:
+  explicit CSettingHandle(const char *id)
+    : m_id(id), m_setting(NULL), m_generation(0)
+  { }
+
+  const char* GetId() const { return m_id; }
+
+private:
+  friend class CSettings;
+
+  const char *m_id;
+  // the setting and the generation it was resolved in are only changed together
+  mutable CSetting *m_setting;
+  mutable unsigned int m_generation;
+  mutable CCriticalSection m_critical;
+};
+
 /*!
  \brief Wrapper around CSettingsManager responsible for properly setting up
  the settings manager and registering all the callbacks, handlers and custom
@@ -192,6 +226,34 @@ public:
    \return String value of the setting with the given identifier
    */
   std::string GetString(const std::string &id) const;
+  /*!
+   \brief Gets the boolean value of the setting referenced by the given handle.
+
+   \param handle Setting handle
+   \return Boolean value of the referenced setting
+   */
+  bool GetBool(const CSettingHandle &handle) const;
+  /*!
+   \brief Gets the integer value of the setting referenced by the given handle.
+
+   \param handle Setting handle
+   \return Integer value of the referenced setting
+   */
+  int GetInt(const CSettingHandle &handle) const;
+  /*!
+   \brief Gets the real number value of the setting referenced by the given handle.
+
+   \param handle Setting handle
+   \return Real number value of the referenced setting
+   */
+  double GetNumber(const CSettingHandle &handle) const;
+  /*!
+   \brief Gets the string value of the setting referenced by the given handle.
+
+   \param handle Setting handle
+   \return String value of the referenced setting
+   */
+  std::string GetString(const CSettingHandle &handle) const;
   /*!
    \brief Gets the values of the list setting with the given identifier.
 
@@ -274,6 +336,8 @@ private:
   void InitializeISettingCallbacks();
   bool Reset();
 
+  CSetting* GetSetting(const CSettingHandle &handle, int type) const;
+
   bool m_initialized;
   CSettingsManager *m_settingsManager;
   CCriticalSection m_critical;
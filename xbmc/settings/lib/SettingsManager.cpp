@@ -28,7 +28,8 @@
 
 
 CSettingsManager::CSettingsManager()
-  : m_initialized(false), m_loaded(false)
+  : m_initialized(false), m_loaded(false),
+    m_generation(1)
 { }
 
 CSettingsManager::~CSettingsManager()
@@ -41,6 +42,10 @@ CSettingsManager::~CSettingsManager()
   m_settingControlCreators.clear();
 
   Clear();
+
+  for (std::vector<CSettingSection*>::iterator section = m_retiredSections.begin(); section != m_retiredSections.end(); ++section)
+    delete *section;
+  m_retiredSections.clear();
 }
 
 bool CSettingsManager::Initialize(const TiXmlElement *root)
@@ -161,9 +166,11 @@ void CSettingsManager::Clear()
   CExclusiveLock lock(m_critical);
   Unload();
 
+  m_generation++;
   m_settings.clear();
+  // setting handles may still be reading the settings of the previous generation
   for (SettingSectionMap::iterator section = m_sections.begin(); section != m_sections.end(); ++section)
-    delete section->second;
+    m_retiredSections.push_back(section->second);
   m_sections.clear();
 
   OnSettingsCleared();
@@ -128,6 +128,17 @@ public:
    being executed.
    */
   void SetLoaded() { m_loaded = true; }
+  /*!
+   \brief Gets the generation of the registered settings.
+
+   The generation changes whenever the registered settings are cleared, so a
+   setting pointer obtained from GetSetting() refers to a registered setting as
+   long as the generation is the same. Cleared settings are kept until the
+   settings manager is destroyed, so the pointer stays safe to read after that.
+
+   \return Generation of the registered settings
+   */
+  unsigned int GetGeneration() const { return m_generation; }
 
   void AddSection(CSettingSection *section);
 
@@ -429,11 +440,13 @@ private:
 
   bool m_initialized;
   bool m_loaded;
+  volatile unsigned int m_generation;
 
   typedef std::map<std::string, Setting> SettingMap;
   SettingMap m_settings;
   typedef std::map<std::string, CSettingSection*> SettingSectionMap;
   SettingSectionMap m_sections;
+  std::vector<CSettingSection*> m_retiredSections; ///< sections of cleared generations
 
   typedef std::map<std::string, ISettingCreator*> SettingCreatorMap;
   SettingCreatorMap m_settingCreators;
@@ -0,0 +1,35 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoCodecFFmpeg.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestDVDVideoCodecFFmpeg, AllowFrameThreading)
+{
+  EXPECT_TRUE(CDVDVideoCodecFFmpeg::AllowFrameThreading(false, false, VS_DECODEMETHOD_SOFTWARE));
+  EXPECT_FALSE(CDVDVideoCodecFFmpeg::AllowFrameThreading(false, false, VS_DECODEMETHOD_HARDWARE));
+
+  // hi10p is opened for software decoding
+  EXPECT_TRUE(CDVDVideoCodecFFmpeg::AllowFrameThreading(true, true, VS_DECODEMETHOD_HARDWARE));
+
+  // hevc has no hardware path, frame threading is kept with the default decoding method
+  EXPECT_TRUE(CDVDVideoCodecFFmpeg::AllowFrameThreading(false, true, VS_DECODEMETHOD_HARDWARE));
+}
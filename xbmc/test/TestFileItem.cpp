@@ -21,6 +21,8 @@
 #include "FileItem.h"
 #include "URL.h"
 #include "settings/AdvancedSettings.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
 
 #include "gtest/gtest.h"
 
@@ -136,3 +138,63 @@ const TestFileData BaseMovies[] = {{ "c:\\dir\\filename.avi", false, "c:\\dir\\f
                                    { "/home/user/movies/movie_name/BDMV/index.bdmv", true, "/home/user/movies/movie_name/" }};
 
 INSTANTIATE_TEST_CASE_P(BaseNameMovies, TestFileItemBasePath, ValuesIn(BaseMovies));
+
+class TestFileItemStack : public AdvancedSettingsResetBase
+{
+public:
+  void Add(CFileItemList &items, const std::string &path)
+  {
+    CFileItemPtr item(new CFileItem(path, false));
+    item->SetLabel(URIUtils::GetFileName(path));
+    items.Add(item);
+  }
+};
+
+TEST_F(TestFileItemStack, StackFiles)
+{
+  const char *files[] = { "/movies/Alien.avi",
+                          "/movies/Aliens.avi",
+                          "/movies/Film-parta.avi",
+                          "/movies/Film-partb.avi",
+                          "/movies/Movie cd1.avi",
+                          "/movies/Movie cd1.nfo",
+                          "/movies/Movie cd2.avi",
+                          "/movies/Other part1.mkv",
+                          "/movies/Other part2.mkv",
+                          "/movies/Other part3.mkv",
+                          "/movies/Sequel cd1.avi",
+                          "/movies/Sequel cd2.mkv" };
+  const char *stacked[] = { "/movies/Alien.avi",
+                            "/movies/Aliens.avi",
+                            "stack:///movies/Film-parta.avi , /movies/Film-partb.avi",
+                            "stack:///movies/Movie cd1.avi , /movies/Movie cd2.avi",
+                            "/movies/Movie cd1.nfo",
+                            "stack:///movies/Other part1.mkv , /movies/Other part2.mkv , /movies/Other part3.mkv",
+                            "/movies/Sequel cd1.avi",
+                            "/movies/Sequel cd2.mkv" };
+
+  CFileItemList items("/movies/");
+  for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+    Add(items, files[i]);
+  items.Stack();
+
+  ASSERT_EQ(sizeof(stacked) / sizeof(stacked[0]), (size_t)items.Size());
+  for (int i = 0; i < items.Size(); i++)
+    EXPECT_EQ(std::string(stacked[i]), items[i]->GetPath());
+}
+
+TEST_F(TestFileItemStack, StackFilesPairs)
+{
+  // every movie of a flat folder is stacked with its own second part
+  CFileItemList items("/movies/");
+  for (int i = 0; i < 2000; i++)
+  {
+    Add(items, StringUtils::Format("/movies/Movie %04i cd1.avi", i));
+    Add(items, StringUtils::Format("/movies/Movie %04i cd2.avi", i));
+  }
+  items.Stack();
+
+  ASSERT_EQ(2000, items.Size());
+  EXPECT_EQ("stack:///movies/Movie 0000 cd1.avi , /movies/Movie 0000 cd2.avi", items[0]->GetPath());
+  EXPECT_EQ("stack:///movies/Movie 1999 cd1.avi , /movies/Movie 1999 cd2.avi", items[1999]->GetPath());
+}
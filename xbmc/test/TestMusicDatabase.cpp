@@ -0,0 +1,116 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "music/MusicDatabase.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+
+namespace
+{
+// a music database in the temp folder, created and opened without the database manager
+class CTestMusicDatabase : public CMusicDatabase
+{
+public:
+  CTestMusicDatabase()
+  {
+    m_settings.type = "sqlite3";
+    m_settings.host = CSpecialProtocol::TranslatePath("special://temp/");
+    m_settings.name = "TestMusicDatabase";
+  }
+
+  bool Create()
+  {
+    Remove();
+    return Update(m_settings);
+  }
+
+  void Remove()
+  {
+    Close();
+    XFILE::CFile::Delete(URIUtils::AddFileToFolder(m_settings.host, m_settings.name + StringUtils::Format("%d.db", GetSchemaVersion())));
+  }
+
+  int GetCount(int idArtist, const char *mediaType)
+  {
+    return atoi(GetSingleValue("navcount", "iCount", PrepareSQL("idNav = %i AND nav_type = 'artist' AND media_type = '%s'", idArtist, mediaType)).c_str());
+  }
+
+private:
+  DatabaseSettings m_settings;
+};
+
+class TestMusicDatabase : public testing::Test
+{
+protected:
+  TestMusicDatabase()
+  {
+    created = db.Create();
+  }
+
+  ~TestMusicDatabase()
+  {
+    db.Remove();
+  }
+
+  CTestMusicDatabase db;
+  bool created;
+};
+}
+
+TEST_F(TestMusicDatabase, NavCounts)
+{
+  ASSERT_TRUE(created);
+  int a = db.AddArtist("Artist A", "");
+  int b = db.AddArtist("Artist B", "");
+  ASSERT_GT(a, 0);
+  ASSERT_GT(b, 0);
+  EXPECT_EQ(0, db.GetCount(a, "song"));
+
+  // the links of song 1 and album 1 are added again, as when they're scanned again
+  EXPECT_TRUE(db.AddSongArtist(a, 1, "Artist A", " & ", false, 0));
+  EXPECT_TRUE(db.AddSongArtist(b, 1, "Artist B", "", true, 1));
+  EXPECT_TRUE(db.AddSongArtist(a, 2, "Artist A", "", false, 0));
+  EXPECT_TRUE(db.AddSongArtist(a, 1, "Artist A", " feat. ", false, 0));
+  EXPECT_TRUE(db.AddAlbumArtist(a, 1, "Artist A", "", false, 0));
+  EXPECT_TRUE(db.AddAlbumArtist(a, 1, "Artist A", "", false, 0));
+  EXPECT_EQ(2, db.GetCount(a, "song"));
+  EXPECT_EQ(1, db.GetCount(b, "song"));
+  EXPECT_EQ(1, db.GetCount(a, "album"));
+  EXPECT_EQ(0, db.GetCount(b, "album"));
+  EXPECT_TRUE(db.CheckNavCounts());
+
+  db.DeleteSongArtistsBySong(1);
+  db.DeleteAlbumArtistsByAlbum(1);
+  EXPECT_EQ(1, db.GetCount(a, "song"));
+  EXPECT_EQ(0, db.GetCount(b, "song"));
+  EXPECT_EQ(0, db.GetCount(a, "album"));
+
+  // the counters kept by the triggers are those rebuilt from the links
+  EXPECT_TRUE(db.CheckNavCounts());
+  EXPECT_EQ(1, db.GetCount(a, "song"));
+  EXPECT_EQ(0, db.GetCount(b, "song"));
+}
@@ -0,0 +1,222 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "playlists/SmartPlaylistCache.h"
+#include "dbwrappers/sqlitedataset.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+
+using namespace ANNOUNCEMENT;
+
+namespace
+{
+// the rows reported to the change handler
+std::vector<std::pair<std::string, int64_t> > changes;
+
+void OnChange(const char *host, const char *database, const char *table, int64_t rowid)
+{
+  changes.push_back(std::make_pair(std::string(table), rowid));
+}
+
+class TestSmartPlaylistCache : public testing::Test
+{
+protected:
+  TestSmartPlaylistCache() : sequence(0)
+  {
+    log.AddDatabase("videos", VideoLibrary);
+    log.AddDatabase("music", AudioLibrary);
+  }
+
+  // whether all playlists of the type need to be run again, with the changed items of the type
+  bool Full(const MediaType &mediaType, std::set<int> &ids)
+  {
+    unsigned int last = sequence;
+    ids.clear();
+    return !log.GetChanges(mediaType, last, ids);
+  }
+
+  // mark the changes made so far as seen by every playlist
+  void Seen()
+  {
+    std::set<int> ids;
+    log.GetChanges(MediaTypeNone, sequence, ids);
+  }
+
+  CSmartPlaylistChanges log;
+  unsigned int sequence;
+};
+}
+
+TEST_F(TestSmartPlaylistCache, Items)
+{
+  std::set<int> ids;
+  Seen();
+
+  log.OnWrite("videos", "movie", 5);
+  log.OnWrite("videos", "movie", 7);
+  EXPECT_FALSE(Full(MediaTypeMovie, ids));
+  EXPECT_EQ(2U, ids.size());
+  EXPECT_EQ(1U, ids.count(5));
+  EXPECT_EQ(1U, ids.count(7));
+  EXPECT_FALSE(Full(MediaTypeTvShow, ids));
+  EXPECT_TRUE(ids.empty());
+
+  // the stored results and writes to databases not followed don't change anything
+  Seen();
+  log.OnWrite("videos", "smartplaylistlink", 1);
+  log.OnWrite("videos", "art", 1);
+  log.OnWrite("textures", "texture", 1);
+  EXPECT_FALSE(Full(MediaTypeMovie, ids));
+  EXPECT_TRUE(ids.empty());
+}
+
+TEST_F(TestSmartPlaylistCache, Library)
+{
+  std::set<int> ids;
+  Seen();
+
+  // a play count or resume point, which isn't announced
+  log.OnWrite("videos", "files", 3);
+  EXPECT_TRUE(Full(MediaTypeMovie, ids));
+  EXPECT_TRUE(Full(MediaTypeEpisode, ids));
+  EXPECT_TRUE(Full(MediaTypeMusicVideo, ids));
+  EXPECT_FALSE(Full(MediaTypeSong, ids));
+
+  Seen();
+  log.OnWrite("music", "song_genre", 3);
+  EXPECT_TRUE(Full(MediaTypeSong, ids));
+  EXPECT_TRUE(Full(MediaTypeAlbum, ids));
+  EXPECT_FALSE(Full(MediaTypeMovie, ids));
+
+  // a table the rows of which weren't reported one by one
+  Seen();
+  log.OnWrite("videos", "movie", 0);
+  EXPECT_TRUE(Full(MediaTypeMovie, ids));
+  EXPECT_FALSE(Full(MediaTypeTvShow, ids));
+}
+
+TEST_F(TestSmartPlaylistCache, Dependencies)
+{
+  std::set<int> ids;
+  Seen();
+
+  // the views of tvshows include the watched episodes
+  log.OnWrite("videos", "episode", 2);
+  EXPECT_FALSE(Full(MediaTypeEpisode, ids));
+  EXPECT_EQ(1U, ids.count(2));
+  EXPECT_TRUE(Full(MediaTypeTvShow, ids));
+  EXPECT_FALSE(Full(MediaTypeMovie, ids));
+
+  Seen();
+  log.AddItemChange(MediaTypeTvShow, 4);
+  EXPECT_TRUE(Full(MediaTypeEpisode, ids));
+
+  // songs, albums and artists show details of each other
+  Seen();
+  log.OnWrite("music", "song", 9);
+  EXPECT_FALSE(Full(MediaTypeSong, ids));
+  EXPECT_EQ(1U, ids.count(9));
+  EXPECT_TRUE(Full(MediaTypeAlbum, ids));
+  EXPECT_TRUE(Full(MediaTypeArtist, ids));
+
+  Seen();
+  log.AddItemChange(MediaTypeAlbum, 1);
+  EXPECT_TRUE(Full(MediaTypeSong, ids));
+  EXPECT_TRUE(Full(MediaTypeArtist, ids));
+}
+
+TEST_F(TestSmartPlaylistCache, Dropped)
+{
+  std::set<int> ids;
+  Seen();
+
+  // a playlist not used while too many items changed is run again in full
+  for (int i = 1; i <= 2000; i++)
+    log.OnWrite("videos", "movie", i);
+  EXPECT_TRUE(Full(MediaTypeMovie, ids));
+
+  Seen();
+  log.OnWrite("videos", "movie", 1);
+  EXPECT_FALSE(Full(MediaTypeMovie, ids));
+  EXPECT_EQ(1U, ids.size());
+}
+
+TEST_F(TestSmartPlaylistCache, SqliteChanges)
+{
+  std::string folder = CSpecialProtocol::TranslatePath("special://temp/");
+  std::string name = "TestSmartPlaylistCache.db";
+  XFILE::CFile::Delete(URIUtils::AddFileToFolder(folder, name));
+
+  changes.clear();
+  dbiplus::SqliteDatabase::setChangeHandler(OnChange);
+  {
+    dbiplus::SqliteDatabase db;
+    db.setHostName(folder.c_str());
+    db.setDatabase(name.c_str());
+    db.setReportChanges(true);
+    ASSERT_EQ(DB_CONNECTION_OK, db.connect(true));
+    std::auto_ptr<dbiplus::Dataset> ds(db.CreateDataset());
+    ds->exec("CREATE TABLE movie (idMovie integer primary key, c00 text)");
+    ds->exec("INSERT INTO movie (idMovie, c00) VALUES (1, 'a')");
+    ASSERT_EQ(1U, changes.size());
+    EXPECT_EQ("movie", changes[0].first);
+    EXPECT_EQ(1, changes[0].second);
+
+    // changes made in a transaction are reported once it's committed
+    changes.clear();
+    db.start_transaction();
+    ds->exec("UPDATE movie SET c00 = 'b' WHERE idMovie = 1");
+    ds->exec("INSERT INTO movie (idMovie, c00) VALUES (2, 'c')");
+    EXPECT_TRUE(changes.empty());
+    db.commit_transaction();
+    EXPECT_EQ(2U, changes.size());
+
+    // only the tables are reported for large transactions
+    changes.clear();
+    db.start_transaction();
+    for (int i = 3; i < 2000; i++)
+      ds->exec(StringUtils::Format("INSERT INTO movie (idMovie, c00) VALUES (%i, 'd')", i));
+    db.commit_transaction();
+    ASSERT_EQ(1U, changes.size());
+    EXPECT_EQ("movie", changes[0].first);
+    EXPECT_EQ(0, changes[0].second);
+    db.disconnect();
+  }
+  {
+    // connections of other databases aren't followed
+    dbiplus::SqliteDatabase db;
+    db.setHostName(folder.c_str());
+    db.setDatabase(name.c_str());
+    ASSERT_EQ(DB_CONNECTION_OK, db.connect(false));
+    std::auto_ptr<dbiplus::Dataset> ds(db.CreateDataset());
+    changes.clear();
+    ds->exec("INSERT INTO movie (idMovie, c00) VALUES (2000, 'e')");
+    EXPECT_TRUE(changes.empty());
+    db.disconnect();
+  }
+  dbiplus::SqliteDatabase::setChangeHandler(NULL);
+  XFILE::CFile::Delete(URIUtils::AddFileToFolder(folder, name));
+}
@@ -0,0 +1,144 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "video/VideoReferenceClock.h"
+
+#include "gtest/gtest.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+namespace
+{
+// host counter in microseconds, a 59.94 Hz display which reports 60 Hz
+const int64_t frequency = 1000000;
+const double  nominal   = 1000000.0 / 60.0;
+const double  period    = 1001000.0 / 60.0;
+
+class TestVblankPLL : public testing::Test
+{
+protected:
+  TestVblankPLL() : vblank(0)
+  {
+    srand(1);
+    pll.Reset(frequency, nominal);
+  }
+
+  // time of the given vblank as seen by the clock thread, up to 500 microseconds late
+  int64_t Observe(int64_t number)
+  {
+    return Exact(number) + rand() % 500;
+  }
+
+  int64_t Exact(int64_t number)
+  {
+    return (int64_t)(period * number);
+  }
+
+  // feed the following vblanks, returning the largest distance of the estimates from the vblanks
+  double Run(int count)
+  {
+    double maxError = 0.0;
+    for (int i = 0; i < count; i++)
+    {
+      vblank++;
+      int64_t estimate = pll.Update(Observe(vblank), 1);
+      if (pll.IsLocked())
+        maxError = std::max(maxError, fabs((double)(estimate - Exact(vblank))));
+    }
+    return maxError;
+  }
+
+  CVblankPLL pll;
+  int64_t vblank;
+};
+}
+
+TEST_F(TestVblankPLL, LockIn)
+{
+  Run(40);
+  ASSERT_TRUE(pll.IsLocked());
+
+  // the period is learned from the vblanks rather than taken from the refreshrate
+  Run(2000);
+  EXPECT_TRUE(pll.IsLocked());
+  EXPECT_NEAR(period, pll.GetPeriod(), 1.0);
+  EXPECT_LT(Run(100), 500.0);
+}
+
+TEST_F(TestVblankPLL, NoLockOnWrongRate)
+{
+  // the refreshrate is reported as 50 Hz, too far off to trust the vblanks
+  pll.Reset(frequency, 1000000.0 / 50.0);
+  Run(200);
+  EXPECT_FALSE(pll.IsLocked());
+}
+
+TEST_F(TestVblankPLL, MissedVblank)
+{
+  Run(1000);
+  ASSERT_TRUE(pll.IsLocked());
+  double locked = pll.GetPeriod();
+
+  // a vblank is not reported, the next one is counted as one vblank
+  vblank += 2;
+  int passed;
+  int64_t estimate = pll.Update(Observe(vblank), 1, &passed);
+  EXPECT_EQ(2, passed);
+  EXPECT_TRUE(pll.IsLocked());
+  EXPECT_NEAR((double)Exact(vblank), (double)estimate, 1000.0);
+  EXPECT_DOUBLE_EQ(locked, pll.GetPeriod());
+
+  EXPECT_LT(Run(100), 500.0);
+  EXPECT_TRUE(pll.IsLocked());
+}
+
+TEST_F(TestVblankPLL, DuplicateVblank)
+{
+  Run(1000);
+  ASSERT_TRUE(pll.IsLocked());
+  double locked = pll.GetPeriod();
+
+  // the last vblank is reported twice
+  int passed;
+  int64_t estimate = pll.Update(Observe(vblank), 1, &passed);
+  EXPECT_EQ(0, passed);
+  EXPECT_TRUE(pll.IsLocked());
+  EXPECT_NEAR((double)Exact(vblank), (double)estimate, 1000.0);
+  EXPECT_DOUBLE_EQ(locked, pll.GetPeriod());
+
+  EXPECT_LT(Run(100), 500.0);
+  EXPECT_TRUE(pll.IsLocked());
+}
+
+TEST_F(TestVblankPLL, Unlock)
+{
+  Run(1000);
+  ASSERT_TRUE(pll.IsLocked());
+
+  // the vblanks keep arriving between the expected ones, the loop starts over
+  int64_t time = Exact(vblank);
+  for (int i = 0; i < 4; i++)
+  {
+    time += (int64_t)(period * 1.5);
+    pll.Update(time, 1);
+  }
+  EXPECT_FALSE(pll.IsLocked());
+}
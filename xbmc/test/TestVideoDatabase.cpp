@@ -0,0 +1,155 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "video/VideoDatabase.h"
+#include "FileItem.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+
+namespace
+{
+// a video database in the temp folder, created and opened without the database manager
+class CTestVideoDatabase : public CVideoDatabase
+{
+public:
+  using CVideoDatabase::AddGenre;
+  using CVideoDatabase::AddGenreToMovie;
+  using CVideoDatabase::RemoveFromLinkTable;
+
+  CTestVideoDatabase()
+  {
+    m_settings.type = "sqlite3";
+    m_settings.host = CSpecialProtocol::TranslatePath("special://temp/");
+    m_settings.name = "TestVideoDatabase";
+  }
+
+  bool Create()
+  {
+    Remove();
+    return Update(m_settings);
+  }
+
+  void Remove()
+  {
+    Close();
+    XFILE::CFile::Delete(URIUtils::AddFileToFolder(m_settings.host, m_settings.name + StringUtils::Format("%d.db", GetSchemaVersion())));
+  }
+
+  int GetCount(int idGenre, const char *field)
+  {
+    return atoi(GetSingleValue("navcount", field, PrepareSQL("idNav = %i AND nav_type = 'genre' AND media_type = 'movie'", idGenre)).c_str());
+  }
+
+  // removes a movie in the order of CleanDatabase(): its file first, then the movie and its links
+  void CleanMovie(int idMovie)
+  {
+    CStdString idFile = GetSingleValue("movie", "idFile", PrepareSQL("idMovie = %i", idMovie));
+    ExecuteQuery(PrepareSQL("DELETE FROM files WHERE idFile = %s", idFile.c_str()));
+    ExecuteQuery(PrepareSQL("DELETE FROM movie WHERE idMovie = %i", idMovie));
+    ExecuteQuery(PrepareSQL("DELETE FROM genrelinkmovie WHERE idMovie = %i", idMovie));
+  }
+
+private:
+  DatabaseSettings m_settings;
+};
+
+class TestVideoDatabase : public testing::Test
+{
+protected:
+  TestVideoDatabase()
+  {
+    created = db.Create();
+  }
+
+  ~TestVideoDatabase()
+  {
+    db.Remove();
+  }
+
+  CTestVideoDatabase db;
+  bool created;
+};
+}
+
+TEST_F(TestVideoDatabase, NavCounts)
+{
+  ASSERT_TRUE(created);
+  int a = db.AddMovie("/videos/a.mkv");
+  int b = db.AddMovie("/videos/b.mkv");
+  int drama = db.AddGenre("Drama");
+  int comedy = db.AddGenre("Comedy");
+  ASSERT_GT(a, 0);
+  ASSERT_GT(b, 0);
+  ASSERT_GT(drama, 0);
+  ASSERT_GT(comedy, 0);
+
+  db.AddGenreToMovie(a, drama);
+  db.AddGenreToMovie(b, drama);
+  db.AddGenreToMovie(a, comedy);
+  EXPECT_EQ(2, db.GetCount(drama, "iCount"));
+  EXPECT_EQ(1, db.GetCount(comedy, "iCount"));
+  EXPECT_EQ(0, db.GetCount(drama, "iWatched"));
+
+  // watching it again doesn't count it twice
+  CFileItem item("/videos/a.mkv", false);
+  db.SetPlayCount(item, 1);
+  db.SetPlayCount(item, 2);
+  EXPECT_EQ(1, db.GetCount(drama, "iWatched"));
+  EXPECT_EQ(1, db.GetCount(comedy, "iWatched"));
+
+  db.RemoveFromLinkTable("genrelinkmovie", "idGenre", comedy, "idMovie", a);
+  EXPECT_EQ(0, db.GetCount(comedy, "iCount"));
+  EXPECT_EQ(0, db.GetCount(comedy, "iWatched"));
+
+  db.SetPlayCount(item, 0);
+  EXPECT_EQ(0, db.GetCount(drama, "iWatched"));
+  db.SetPlayCount(item, 1);
+
+  db.DeleteMovie(b);
+  EXPECT_EQ(1, db.GetCount(drama, "iCount"));
+  EXPECT_EQ(1, db.GetCount(drama, "iWatched"));
+
+  // the counters kept by the triggers are those rebuilt from the links
+  EXPECT_TRUE(db.CheckNavCounts());
+}
+
+TEST_F(TestVideoDatabase, NavCountsCleanup)
+{
+  ASSERT_TRUE(created);
+  int a = db.AddMovie("/videos/a.mkv");
+  int b = db.AddMovie("/videos/b.mkv");
+  int drama = db.AddGenre("Drama");
+  db.AddGenreToMovie(a, drama);
+  db.AddGenreToMovie(b, drama);
+  CFileItem item("/videos/a.mkv", false);
+  db.SetPlayCount(item, 1);
+
+  db.CleanMovie(a);
+  EXPECT_EQ(1, db.GetCount(drama, "iCount"));
+  EXPECT_EQ(0, db.GetCount(drama, "iWatched"));
+  EXPECT_TRUE(db.CheckNavCounts());
+}
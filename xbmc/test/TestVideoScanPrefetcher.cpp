@@ -0,0 +1,178 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "video/VideoScanPrefetcher.h"
+#include "FileItem.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+
+#include "gtest/gtest.h"
+
+using namespace VIDEO;
+
+// friend of CVideoScanPrefetcher, walks its states without jobs
+class TestVideoScanPrefetcher : public testing::Test
+{
+public:
+  TestVideoScanPrefetcher()
+  {
+    prefetcher.Start(std::set<CStdString>(), false, 1, std::map<CStdString, unsigned int>());
+    generation = prefetcher.m_generation;
+  }
+
+  std::string Begin(const std::string &directory)
+  {
+    switch (prefetcher.Begin(generation, directory, CVideoScanPrefetcher::Listing))
+    {
+    case CVideoScanPrefetcher::Claimed: return "claimed";
+    case CVideoScanPrefetcher::Taken:   return "taken";
+    default:                            return "abort";
+    }
+  }
+
+  // finish a listing of the given number of files
+  void Finish(const std::string &directory, int files)
+  {
+    CFileItemList *items = new CFileItemList;
+    for (int i = 0; i < files; i++)
+      items->Add(CFileItemPtr(new CFileItem(directory + "file.mkv", false)));
+    prefetcher.Finish(generation, directory, CVideoScanPrefetcher::Listing, "", items);
+  }
+
+  bool Get(const std::string &directory, CFileItemList &items)
+  {
+    return prefetcher.Get(directory, CVideoScanPrefetcher::Listing, NULL, &items);
+  }
+
+  unsigned int GetRequested()
+  {
+    CSingleLock lock(prefetcher.m_critSection);
+    return prefetcher.m_requested;
+  }
+
+  CVideoScanPrefetchJob *CreateJob()
+  {
+    return new CVideoScanPrefetchJob(&prefetcher, generation, "smb://server/movies/");
+  }
+
+  CVideoScanPrefetcher prefetcher;
+  unsigned int generation;
+};
+
+namespace
+{
+// the scanner, asking for a listing
+class CGetThread : public CThread
+{
+public:
+  CGetThread(TestVideoScanPrefetcher &test, const std::string &directory)
+    : CThread("TestVideoScanPrefetcher"), m_test(test), m_directory(directory), m_result(false), m_done(false) {}
+
+  virtual void Process()
+  {
+    m_result = m_test.Get(m_directory, m_items);
+    m_done = true;
+  }
+
+  TestVideoScanPrefetcher &m_test;
+  std::string m_directory;
+  CFileItemList m_items;
+  volatile bool m_result;
+  volatile bool m_done;
+};
+
+// deletes a job after a while, as a worker does once the job's done
+class CDeleteThread : public CThread
+{
+public:
+  CDeleteThread(CJob *job) : CThread("TestVideoScanPrefetcher"), m_job(job), m_deleted(false) {}
+
+  virtual void Process()
+  {
+    XbmcThreads::ThreadSleep(100);
+    m_deleted = true;
+    delete m_job;
+  }
+
+  CJob *m_job;
+  volatile bool m_deleted;
+};
+}
+
+TEST_F(TestVideoScanPrefetcher, Claim)
+{
+  CFileItemList items;
+  EXPECT_EQ("claimed", Begin("/movies/a/"));
+  EXPECT_EQ("taken", Begin("/movies/a/"));
+  Finish("/movies/a/", 2);
+  EXPECT_EQ("taken", Begin("/movies/a/"));
+
+  // the listing is handed to the scanner once
+  EXPECT_TRUE(Get("/movies/a/", items));
+  EXPECT_EQ(2, items.Size());
+  items.Clear();
+  EXPECT_FALSE(Get("/movies/a/", items));
+  EXPECT_EQ("abort", Begin("/movies/a/"));
+}
+
+TEST_F(TestVideoScanPrefetcher, Passed)
+{
+  // the scanner got to the folder before a job, the jobs leave it
+  CFileItemList items;
+  EXPECT_FALSE(Get("/movies/b/", items));
+  EXPECT_EQ("abort", Begin("/movies/b/"));
+  EXPECT_FALSE(Get("/movies/b/", items));
+}
+
+TEST_F(TestVideoScanPrefetcher, Wait)
+{
+  EXPECT_EQ("claimed", Begin("/movies/c/"));
+
+  // the scanner waits for the job busy with the folder
+  CGetThread scanner(*this, "/movies/c/");
+  scanner.Create();
+  while (GetRequested() == 0)
+    XbmcThreads::ThreadSleep(1);
+  EXPECT_FALSE(scanner.m_done);
+
+  Finish("/movies/c/", 1);
+  scanner.StopThread(true);
+  EXPECT_TRUE(scanner.m_result);
+  EXPECT_EQ(1, scanner.m_items.Size());
+}
+
+TEST_F(TestVideoScanPrefetcher, Stop)
+{
+  CFileItemList items;
+  EXPECT_EQ("claimed", Begin("/movies/d/"));
+  EXPECT_EQ("claimed", Begin("/movies/e/"));
+  Finish("/movies/e/", 1);
+
+  // stopping waits for the jobs, and drops what they got
+  CDeleteThread worker(CreateJob());
+  worker.Create();
+  prefetcher.Stop();
+  EXPECT_TRUE(worker.m_deleted);
+  worker.StopThread(true);
+
+  EXPECT_FALSE(Get("/movies/e/", items));
+  EXPECT_EQ("abort", Begin("/movies/d/"));
+  Finish("/movies/d/", 1);
+}
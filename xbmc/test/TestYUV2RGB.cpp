@@ -0,0 +1,98 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoRenderers/YUV2RGB.h"
+
+#include "gtest/gtest.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+// odd sizes so the scalar tail is used next to the SIMD blocks
+const int width   = 37;
+const int height  = 11;
+const int cwidth  = (width + 1) / 2;
+const int cheight = (height + 1) / 2;
+
+int Reference(int y, int u, int v, int component)
+{
+  double luma = 1.164383 * (y - 16);
+  double value;
+  if (component == 0)
+    value = luma + 2.017232 * (u - 128);
+  else if (component == 1)
+    value = luma - 0.391762 * (u - 128) - 0.812968 * (v - 128);
+  else
+    value = luma + 1.596027 * (v - 128);
+  int result = (int)floor(value + 0.5);
+  return result < 0 ? 0 : (result > 255 ? 255 : result);
+}
+
+class TestYUV2RGB : public testing::Test
+{
+protected:
+  TestYUV2RGB()
+    : y(width * height), u(cwidth * cheight), v(cwidth * cheight), uv(cwidth * cheight * 2)
+  {
+    srand(1);
+    for (size_t i = 0; i < y.size(); i++)
+      y[i] = rand() & 0xff;
+    for (size_t i = 0; i < u.size(); i++)
+    {
+      uv[i * 2]     = u[i] = rand() & 0xff;
+      uv[i * 2 + 1] = v[i] = rand() & 0xff;
+    }
+  }
+
+  std::vector<uint8_t> y, u, v, uv;
+};
+}
+
+TEST_F(TestYUV2RGB, YUV420ToBGRA)
+{
+  std::vector<uint8_t> out(width * height * 4);
+  CYUV2RGB::YUV420ToBGRA(&out[0], width * 4, &y[0], &u[0], &v[0], width, cwidth, width, height);
+
+  for (int row = 0; row < height; row++)
+  {
+    for (int x = 0; x < width; x++)
+    {
+      const uint8_t *pixel = &out[(row * width + x) * 4];
+      int chroma = (row / 2) * cwidth + x / 2;
+      for (int c = 0; c < 3; c++)
+        EXPECT_NEAR(Reference(y[row * width + x], u[chroma], v[chroma], c), pixel[c], 1);
+      EXPECT_EQ(0xff, pixel[3]);
+    }
+  }
+}
+
+TEST_F(TestYUV2RGB, NV12MatchesYUV420)
+{
+  std::vector<uint8_t> planar(width * height * 4);
+  std::vector<uint8_t> nv12(width * height * 4);
+  CYUV2RGB::YUV420ToBGRA(&planar[0], width * 4, &y[0], &u[0], &v[0], width, cwidth, width, height);
+  CYUV2RGB::NV12ToBGRA(&nv12[0], width * 4, &y[0], &uv[0], width, cwidth * 2, width, height);
+
+  EXPECT_EQ(0, memcmp(&planar[0], &nv12[0], planar.size()));
+}
@@ -0,0 +1,341 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+
+#include <string.h>
+
+#ifdef HAVE_INOTIFY
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "ChangeJournal.h"
+#include "URL.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#ifdef HAVE_INOTIFY
+#define CHANGEJOURNAL_EVENTS (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB | \
+                              IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_DONT_FOLLOW)
+#endif
+
+#ifdef HAVE_INOTIFY
+// the scanners follow links to folders, changes made behind them can't be watched from here
+static bool IsLinkToFolder(const std::string &path)
+{
+  struct stat st;
+  return lstat(path.c_str(), &st) == 0 && S_ISLNK(st.st_mode) &&
+         stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+#endif
+
+CChangeJournal::CChangeJournal() : CThread("ChangeJournal")
+{
+  m_fd = -1;
+  m_sequence = 0;
+  m_overflow = 0;
+}
+
+CChangeJournal::~CChangeJournal()
+{
+  Stop();
+}
+
+CChangeJournal &CChangeJournal::Get()
+{
+  static CChangeJournal sChangeJournal;
+  return sChangeJournal;
+}
+
+bool CChangeJournal::Watch(const std::string &path)
+{
+#ifdef HAVE_INOTIFY
+  // only folders of the local filesystem are watched, not those of any vfs
+  CURL url(path);
+  if (!url.GetProtocol().empty() || !StringUtils::StartsWith(path, "/"))
+    return false;
+
+  std::string folder(path);
+  URIUtils::AddSlashAtEnd(folder);
+
+  CSingleLock lock(m_critSection);
+  for (std::map<std::string, unsigned int>::const_iterator it = m_roots.begin(); it != m_roots.end(); ++it)
+  {
+    if (StringUtils::StartsWith(folder, it->first))
+      return true;
+  }
+
+  if (m_fd < 0)
+  {
+    m_fd = inotify_init();
+    if (m_fd < 0)
+    {
+      CLog::Log(LOGWARNING, "%s - unable to initialize inotify (%s)", __FUNCTION__, strerror(errno));
+      return false;
+    }
+    fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+  }
+
+  if (!AddWatches(folder, false))
+  {
+    RemoveWatches(folder);
+    CLog::Log(LOGDEBUG, "%s - unable to watch %s, changes are found by hashing", __FUNCTION__, folder.c_str());
+    return false;
+  }
+
+  // changes made before the watches were added aren't known
+  m_roots[folder] = ++m_sequence;
+  CLog::Log(LOGDEBUG, "%s - watching %s", __FUNCTION__, folder.c_str());
+
+  if (!IsRunning())
+    Create();
+  return true;
+#else
+  return false;
+#endif
+}
+
+unsigned int CChangeJournal::GetCursor()
+{
+  CSingleLock lock(m_critSection);
+  // changes already made must fall before the cursor
+  ReadEvents();
+  return m_sequence;
+}
+
+bool CChangeJournal::HasChanged(const std::string &path, unsigned int cursor)
+{
+  std::string folder(path);
+  URIUtils::AddSlashAtEnd(folder);
+
+  CSingleLock lock(m_critSection);
+  ReadEvents();
+  if (m_overflow > cursor)
+    return true;
+
+  bool watched = false;
+  for (std::map<std::string, unsigned int>::const_iterator it = m_roots.begin(); it != m_roots.end() && !watched; ++it)
+    watched = StringUtils::StartsWith(folder, it->first) && it->second <= cursor;
+  if (!watched)
+    return true;
+
+  for (std::map<std::string, unsigned int>::const_iterator it = m_changes.lower_bound(folder);
+       it != m_changes.end() && StringUtils::StartsWith(it->first, folder); ++it)
+  {
+    if (it->second > cursor)
+      return true;
+  }
+  return false;
+}
+
+void CChangeJournal::MarkChanged(const std::string &path)
+{
+  std::string folder(path);
+  URIUtils::AddSlashAtEnd(folder);
+
+  CSingleLock lock(m_critSection);
+  AddChange(folder);
+}
+
+void CChangeJournal::Stop()
+{
+  StopThread();
+
+  CSingleLock lock(m_critSection);
+#ifdef HAVE_INOTIFY
+  if (m_fd >= 0)
+    close(m_fd);
+#endif
+  m_fd = -1;
+  m_watches.clear();
+  m_folders.clear();
+  m_roots.clear();
+}
+
+void CChangeJournal::Process()
+{
+#ifdef HAVE_INOTIFY
+  // events are read as they come, so the kernel's queue doesn't overflow between scans
+  while (!m_bStop)
+  {
+    struct pollfd pfd;
+    pfd.fd = m_fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, 500) > 0)
+    {
+      CSingleLock lock(m_critSection);
+      ReadEvents();
+    }
+  }
+#endif
+}
+
+void CChangeJournal::ReadEvents()
+{
+#ifdef HAVE_INOTIFY
+  if (m_fd < 0)
+    return;
+
+  char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  ssize_t length;
+  while ((length = read(m_fd, buffer, sizeof(buffer))) > 0)
+  {
+    const struct inotify_event *event;
+    for (char *ptr = buffer; ptr < buffer + length; ptr += sizeof(struct inotify_event) + event->len)
+    {
+      event = (const struct inotify_event *)ptr;
+      if (event->mask & IN_Q_OVERFLOW)
+      {
+        CLog::Log(LOGDEBUG, "%s - events were lost, all folders are considered changed", __FUNCTION__);
+        m_overflow = ++m_sequence;
+        continue;
+      }
+
+      std::map<int, std::string>::iterator watch = m_watches.find(event->wd);
+      if (watch == m_watches.end())
+        continue;
+      std::string folder = watch->second;
+      AddChange(folder);
+
+      if ((event->mask & IN_MOVE_SELF) && m_roots.find(folder) != m_roots.end())
+      {
+        // the watches keep following the moved folders, under paths no longer known
+        RemoveRoot(folder);
+        continue;
+      }
+
+      if (event->mask & IN_IGNORED)
+      {
+        // the folder was removed or unmounted, a root can't be watched any longer
+        m_watches.erase(watch);
+        m_folders.erase(folder);
+        if (m_roots.find(folder) != m_roots.end())
+          RemoveRoot(folder);
+        continue;
+      }
+
+      if ((event->mask & IN_ISDIR) && event->len > 0)
+      {
+        std::string child = folder + event->name + "/";
+        AddChange(child);
+        if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+          RemoveWatches(child);
+        else if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && !AddWatches(child, true))
+          RemoveRoot(child);
+      }
+      else if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && event->len > 0 && IsLinkToFolder(folder + event->name))
+        RemoveRoot(folder);
+    }
+  }
+#endif
+}
+
+bool CChangeJournal::AddWatches(const std::string &folder, bool changed)
+{
+#ifdef HAVE_INOTIFY
+  if (changed)
+    AddChange(folder);
+  if (m_folders.find(folder) != m_folders.end())
+    return true;
+
+  int wd = inotify_add_watch(m_fd, folder.c_str(), CHANGEJOURNAL_EVENTS);
+  if (wd < 0)
+  {
+    // most likely the limit of fs.inotify.max_user_watches was reached
+    if (errno == ENOSPC)
+      CLog::Log(LOGWARNING, "%s - the inotify watch limit was reached adding %s", __FUNCTION__, folder.c_str());
+    return false;
+  }
+  m_watches[wd] = folder;
+  m_folders[folder] = wd;
+
+  DIR *dir = opendir(folder.c_str());
+  if (dir == NULL)
+    return false;
+
+  bool result = true;
+  struct dirent *entry;
+  while (result && (entry = readdir(dir)) != NULL)
+  {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+      continue;
+
+    std::string child = folder + entry->d_name;
+    struct stat st;
+    if (lstat(child.c_str(), &st) != 0)
+      continue;
+
+    if (S_ISLNK(st.st_mode))
+      result = !IsLinkToFolder(child);
+    else if (S_ISDIR(st.st_mode))
+      result = AddWatches(child + "/", changed);
+  }
+  closedir(dir);
+  return result;
+#else
+  return false;
+#endif
+}
+
+void CChangeJournal::RemoveWatches(const std::string &folder)
+{
+#ifdef HAVE_INOTIFY
+  std::map<std::string, int>::iterator it = m_folders.lower_bound(folder);
+  while (it != m_folders.end() && StringUtils::StartsWith(it->first, folder))
+  {
+    inotify_rm_watch(m_fd, it->second);
+    m_watches.erase(it->second);
+    m_folders.erase(it++);
+  }
+#endif
+}
+
+void CChangeJournal::RemoveRoot(const std::string &folder)
+{
+  // roots nested in another one share its watches, so the outermost root is removed along with all roots in it
+  std::string outer(folder);
+  for (std::map<std::string, unsigned int>::const_iterator it = m_roots.begin(); it != m_roots.end(); ++it)
+  {
+    if (StringUtils::StartsWith(outer, it->first))
+      outer = it->first;
+  }
+
+  std::map<std::string, unsigned int>::iterator it = m_roots.lower_bound(outer);
+  while (it != m_roots.end() && StringUtils::StartsWith(it->first, outer))
+  {
+    CLog::Log(LOGDEBUG, "%s - no longer watching %s", __FUNCTION__, it->first.c_str());
+    m_roots.erase(it++);
+  }
+  RemoveWatches(outer);
+}
+
+void CChangeJournal::AddChange(const std::string &folder)
+{
+  m_changes[folder] = ++m_sequence;
+}
@@ -0,0 +1,101 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <string>
+
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+
+/*!
+ \brief Keeps track of the changes made below local folders, so scanners can skip unchanged ones.
+
+ Local folders are watched recursively through inotify. Every change made in a watched folder,
+ like a file being added, removed, renamed or written, is numbered in sequence. A scanner takes
+ the cursor of the journal before it looks at a folder, and can ask on its next scan whether
+ anything changed below the folder since, without listing it.
+
+ Changes are only known while a folder is watched. For folders that can't be watched (network
+ shares, platforms without inotify, too many folders for the watch limit) or that weren't watched
+ at the time of the cursor, like after a restart, HasChanged always returns true and the scanners
+ fall back to comparing the hashes of the folders.
+ */
+class CChangeJournal : public CThread
+{
+public:
+  static CChangeJournal &Get();
+
+  /*! \brief Start watching a local folder and all folders below it.
+   \param path the folder to watch.
+   \return true if the folder is watched, false if it can't be.
+   */
+  bool Watch(const std::string &path);
+
+  /*! \brief Get the current position of the journal, to be passed to HasChanged later.
+   */
+  unsigned int GetCursor();
+
+  /*! \brief Check whether anything changed below a folder since a position of the journal.
+   \param path the folder to check.
+   \param cursor the position of the journal the folder was last looked at.
+   \return false if the folder was watched at that position and nothing changed below it since, true otherwise.
+   */
+  bool HasChanged(const std::string &path, unsigned int cursor);
+
+  /*! \brief Record a change to a folder not made on the filesystem, e.g. to its scan settings.
+   \param path the folder that changed.
+   */
+  void MarkChanged(const std::string &path);
+
+  /*! \brief Stop watching all folders and stop the thread reading the events, on shutdown.
+   The folders watched later are journaled from scratch.
+   */
+  void Stop();
+
+protected:
+  virtual void Process();
+
+private:
+  CChangeJournal();
+  CChangeJournal(const CChangeJournal&);
+  CChangeJournal const& operator=(CChangeJournal const&);
+  virtual ~CChangeJournal();
+
+  void ReadEvents();
+  /*! \brief Watch a folder and all folders below it.
+   \param folder the folder to watch.
+   \param changed whether the folders are new to the watched tree and recorded as changed, as their content may
+                  have been added before they're watched, or was moved in with them.
+   */
+  bool AddWatches(const std::string &folder, bool changed);
+  void RemoveWatches(const std::string &folder);
+  void RemoveRoot(const std::string &folder);
+  void AddChange(const std::string &folder);
+
+  int m_fd;
+  std::map<int, std::string> m_watches;           ///< folder of each inotify watch
+  std::map<std::string, int> m_folders;           ///< inotify watch of each folder
+  std::map<std::string, unsigned int> m_roots;    ///< folders passed to Watch and the position they're watched from
+  std::map<std::string, unsigned int> m_changes;  ///< position of the last change in each folder
+  unsigned int m_sequence;
+  unsigned int m_overflow;                        ///< position at which events were last lost
+  CCriticalSection m_critSection;
+};
@@ -149,6 +149,8 @@ public:
   static bool IsJitSupported(void);
 
 private:
+  friend class CRegExpSet;
+
   int PrivateRegFind(size_t bufferLen, const char *str, unsigned int startoffset = 0, int maxNumberOfCharsToTest = -1);
   void InitValues(bool caseless = false, CRegExp::utf8Mode utf8 = asciiOnly);
   static bool requireUtf8(const std::string& regexp);
@@ -0,0 +1,279 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RegExpCache.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+#define REGEXPCACHE_MAX_ENTRIES  32
+// sets kept per list, one for each thread using the list at the same time
+#define REGEXPCACHE_MAX_IDLE     4
+
+CRegExpSet::CRegExpSet(const std::vector<std::string> &patterns, bool caseless, CRegExp::utf8Mode utf8)
+{
+  for (std::vector<std::string>::const_iterator it = patterns.begin(); it != patterns.end(); ++it)
+  {
+    CRegExp *expression = new CRegExp(caseless, utf8);
+    if (!expression->RegComp(*it, CRegExp::StudyWithJitComp))
+    {
+      CLog::Log(LOGERROR, "%s: Invalid RegExp:'%s'", __FUNCTION__, it->c_str());
+      delete expression;
+      expression = NULL;
+    }
+    m_expressions.push_back(expression);
+  }
+
+  Combine(caseless, utf8);
+}
+
+CRegExpSet::~CRegExpSet()
+{
+  for (std::vector<CRegExp*>::iterator it = m_expressions.begin(); it != m_expressions.end(); ++it)
+    delete *it;
+  for (std::vector<Combined>::iterator it = m_combined.begin(); it != m_combined.end(); ++it)
+    delete it->expression;
+}
+
+bool CRegExpSet::CanCombine(const std::string &pattern)
+{
+  // the expression is wrapped in a group and put after others, so anything
+  // referring to group numbers or to the start of the pattern has to stay on its own
+  static const char *constructs[] = { "(*", "(?(", "(?R", "(?&", "(?P=", "(?P>", "\\Q", "\\g", "\\k" };
+  for (size_t i = 0; i < sizeof(constructs) / sizeof(constructs[0]); i++)
+  {
+    if (pattern.find(constructs[i]) != std::string::npos)
+      return false;
+  }
+
+  for (size_t pos = 0; pos + 1 < pattern.size(); pos++)
+  {
+    char next = pattern[pos + 1];
+    if (pattern[pos] == '\\' && next >= '1' && next <= '9')
+      return false;
+    if (pattern[pos] == '(' && next == '?' && pos + 2 < pattern.size() &&
+        ((pattern[pos + 2] >= '0' && pattern[pos + 2] <= '9') || pattern[pos + 2] == '+' || pattern[pos + 2] == '-'))
+      return false;
+  }
+  return true;
+}
+
+void CRegExpSet::Combine(bool caseless, CRegExp::utf8Mode utf8)
+{
+  // expressions needing UTF-8 mode can only be combined with each other
+  std::vector<size_t> candidates[2];
+  for (size_t i = 0; i < m_expressions.size(); i++)
+  {
+    if (!m_expressions[i])
+      continue;
+
+    const std::string &pattern = m_expressions[i]->GetPattern();
+    if (!CanCombine(pattern))
+    {
+      m_separate.push_back(i);
+      continue;
+    }
+    bool needUtf8 = utf8 == CRegExp::forceUtf8 || (utf8 == CRegExp::autoUtf8 && CRegExp::requireUtf8(pattern));
+    candidates[needUtf8 ? 1 : 0].push_back(i);
+  }
+
+  for (int mode = 0; mode < 2; mode++)
+  {
+    Combined combined;
+    std::string pattern;
+    int groups = 0;
+    for (std::vector<size_t>::const_iterator it = candidates[mode].begin(); it != candidates[mode].end(); ++it)
+    {
+      int captures = m_expressions[*it]->GetCaptureTotal();
+      if (captures < 0 || captures + 1 > CRegExp::m_MaxNumOfBackrefrences)
+      {
+        m_separate.push_back(*it);
+        continue;
+      }
+      // the match data of an expression has room for a limited number of groups
+      if (groups + captures + 1 > CRegExp::m_MaxNumOfBackrefrences)
+      {
+        AddCombined(combined, pattern, caseless, utf8);
+        combined.groups.clear();
+        pattern.clear();
+        groups = 0;
+      }
+      pattern += pattern.empty() ? "(" : "|(";
+      pattern += m_expressions[*it]->GetPattern() + ")";
+      combined.groups.push_back(std::make_pair(*it, groups + 1));
+      groups += captures + 1;
+    }
+    AddCombined(combined, pattern, caseless, utf8);
+  }
+}
+
+void CRegExpSet::AddCombined(Combined &combined, const std::string &pattern, bool caseless, CRegExp::utf8Mode utf8)
+{
+  if (combined.groups.empty())
+    return;
+
+  if (combined.groups.size() > 1)
+  {
+    combined.expression = new CRegExp(caseless, utf8);
+    if (combined.expression->RegComp(pattern, CRegExp::StudyWithJitComp))
+    {
+      m_combined.push_back(combined);
+      return;
+    }
+    delete combined.expression;
+  }
+
+  for (std::vector<std::pair<size_t, int> >::const_iterator it = combined.groups.begin(); it != combined.groups.end(); ++it)
+    m_separate.push_back(it->first);
+}
+
+int CRegExpSet::FindAny(const std::string &str)
+{
+  for (std::vector<Combined>::iterator it = m_combined.begin(); it != m_combined.end(); ++it)
+  {
+    if (it->expression->RegFind(str) < 0)
+      continue;
+
+    for (std::vector<std::pair<size_t, int> >::const_iterator group = it->groups.begin(); group != it->groups.end(); ++group)
+    {
+      if (group->second <= it->expression->GetSubCount() && it->expression->GetSubStart(group->second) >= 0)
+        return group->first;
+    }
+  }
+
+  for (std::vector<size_t>::const_iterator it = m_separate.begin(); it != m_separate.end(); ++it)
+  {
+    if (m_expressions[*it]->RegFind(str) >= 0)
+      return *it;
+  }
+  return -1;
+}
+
+CRegExpCache::CRegExpCache()
+{
+  m_generation = 0;
+  m_useCounter = 0;
+}
+
+CRegExpCache::~CRegExpCache()
+{
+  Clear();
+}
+
+CRegExpCache &CRegExpCache::Get()
+{
+  static CRegExpCache sRegExpCache;
+  return sRegExpCache;
+}
+
+std::string CRegExpCache::GetKey(const std::vector<std::string> &patterns, bool caseless, CRegExp::utf8Mode utf8)
+{
+  std::string key;
+  key += caseless ? 'i' : 'c';
+  key += (char)('1' + utf8);
+  for (std::vector<std::string>::const_iterator it = patterns.begin(); it != patterns.end(); ++it)
+  {
+    key += '\0';
+    key += *it;
+  }
+  return key;
+}
+
+CRegExpSet *CRegExpCache::Acquire(const CStdStringArray &patterns, bool caseless, CRegExp::utf8Mode utf8)
+{
+  return Acquire(std::vector<std::string>(patterns.begin(), patterns.end()), caseless, utf8);
+}
+
+CRegExpSet *CRegExpCache::Acquire(const std::vector<std::string> &patterns, bool caseless, CRegExp::utf8Mode utf8)
+{
+  Lease lease;
+  lease.key = GetKey(patterns, caseless, utf8);
+  {
+    CSingleLock lock(m_critSection);
+    lease.generation = m_generation;
+
+    Entry &entry = m_entries[lease.key];
+    entry.lastUsed = ++m_useCounter;
+    if (!entry.idle.empty())
+    {
+      CRegExpSet *set = entry.idle.back();
+      entry.idle.pop_back();
+      m_leases[set] = lease;
+      return set;
+    }
+  }
+
+  // compiling takes a while, don't hold up the other users
+  CRegExpSet *set = new CRegExpSet(patterns, caseless, utf8);
+
+  CSingleLock lock(m_critSection);
+  m_leases[set] = lease;
+  if (m_entries.size() > REGEXPCACHE_MAX_ENTRIES)
+    Evict();
+  return set;
+}
+
+void CRegExpCache::Release(CRegExpSet *set)
+{
+  if (!set)
+    return;
+
+  CSingleLock lock(m_critSection);
+  std::map<CRegExpSet*, Lease>::iterator lease = m_leases.find(set);
+  if (lease != m_leases.end())
+  {
+    std::map<std::string, Entry>::iterator entry = m_entries.find(lease->second.key);
+    bool keep = lease->second.generation == m_generation && entry != m_entries.end() &&
+                entry->second.idle.size() < REGEXPCACHE_MAX_IDLE;
+    m_leases.erase(lease);
+    if (keep)
+    {
+      entry->second.idle.push_back(set);
+      return;
+    }
+  }
+  delete set;
+}
+
+void CRegExpCache::Clear()
+{
+  CSingleLock lock(m_critSection);
+  for (std::map<std::string, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    for (std::vector<CRegExpSet*>::iterator set = it->second.idle.begin(); set != it->second.idle.end(); ++set)
+      delete *set;
+  }
+  m_entries.clear();
+  m_generation++;
+}
+
+void CRegExpCache::Evict()
+{
+  std::map<std::string, Entry>::iterator oldest = m_entries.begin();
+  for (std::map<std::string, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    if (it->second.lastUsed < oldest->second.lastUsed)
+      oldest = it;
+  }
+
+  // sets of the list that are in use are deleted on release
+  for (std::vector<CRegExpSet*>::iterator set = oldest->second.idle.begin(); set != oldest->second.idle.end(); ++set)
+    delete *set;
+  m_entries.erase(oldest);
+}
@@ -0,0 +1,148 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include "threads/CriticalSection.h"
+#include "utils/RegExp.h"
+#include "utils/StdString.h"
+
+/*!
+ \brief A list of regular expressions, compiled once.
+
+ The expressions are studied and JIT compiled where PCRE supports it. A pattern that
+ fails to compile keeps its slot, so the indices of the set follow the pattern list.
+
+ The expressions keep the state of their last match, so a set must only be used by
+ one thread at a time. CRegExpCache hands out a set to one user at a time.
+ */
+class CRegExpSet
+{
+public:
+  CRegExpSet(const std::vector<std::string> &patterns, bool caseless, CRegExp::utf8Mode utf8);
+  ~CRegExpSet();
+
+  size_t Size() const { return m_expressions.size(); }
+
+  /*! \brief Get an expression of the set.
+   \param index the position of the pattern in the list the set was created from.
+   \return the compiled expression, NULL if the pattern is invalid.
+   */
+  CRegExp *Get(size_t index) const { return m_expressions[index]; }
+
+  /*! \brief Find an expression matching a string.
+   Expressions that can be combined are matched in a single pass over the string, so
+   when several match, the one returned isn't necessarily the first in the list.
+   \param str the string to match.
+   \return the index of a matching expression, -1 if none matches.
+   */
+  int FindAny(const std::string &str);
+
+private:
+  CRegExpSet(const CRegExpSet&);
+  CRegExpSet const& operator=(CRegExpSet const&);
+
+  struct Combined
+  {
+    CRegExp *expression;
+    std::vector<std::pair<size_t, int> > groups; ///< index of an expression and the group wrapping it
+  };
+
+  void Combine(bool caseless, CRegExp::utf8Mode utf8);
+  void AddCombined(Combined &combined, const std::string &pattern, bool caseless, CRegExp::utf8Mode utf8);
+  static bool CanCombine(const std::string &pattern);
+
+  std::vector<CRegExp*> m_expressions;
+  std::vector<Combined> m_combined;
+  std::vector<size_t> m_separate; ///< expressions matched on their own
+};
+
+/*!
+ \brief Keeps compiled regular expression sets for the lists in advancedsettings.
+
+ Sets are looked up by their patterns and options. A set is taken out of the cache
+ while it's used and put back when released, so several threads may use the same
+ list at once, each with its own set.
+ */
+class CRegExpCache
+{
+public:
+  static CRegExpCache &Get();
+
+  CRegExpSet *Acquire(const std::vector<std::string> &patterns, bool caseless = true, CRegExp::utf8Mode utf8 = CRegExp::autoUtf8);
+  CRegExpSet *Acquire(const CStdStringArray &patterns, bool caseless = true, CRegExp::utf8Mode utf8 = CRegExp::autoUtf8);
+  void Release(CRegExpSet *set);
+
+  /*! \brief Drop all sets, e.g. when the expressions in the settings changed.
+   Sets in use are deleted when they're released.
+   */
+  void Clear();
+
+private:
+  CRegExpCache();
+  CRegExpCache(const CRegExpCache&);
+  CRegExpCache const& operator=(CRegExpCache const&);
+  ~CRegExpCache();
+
+  struct Entry
+  {
+    std::vector<CRegExpSet*> idle;
+    unsigned int lastUsed;
+  };
+
+  struct Lease
+  {
+    std::string key;
+    unsigned int generation;
+  };
+
+  static std::string GetKey(const std::vector<std::string> &patterns, bool caseless, CRegExp::utf8Mode utf8);
+  void Evict();
+
+  std::map<std::string, Entry> m_entries;
+  std::map<CRegExpSet*, Lease> m_leases;
+  unsigned int m_generation;
+  unsigned int m_useCounter;
+  CCriticalSection m_critSection;
+};
+
+/*!
+ \brief Holds a set of the cache for the lifetime of the object.
+ */
+class CCachedRegExpSet
+{
+public:
+  CCachedRegExpSet(const CStdStringArray &patterns, bool caseless = true, CRegExp::utf8Mode utf8 = CRegExp::autoUtf8)
+    : m_set(CRegExpCache::Get().Acquire(patterns, caseless, utf8)) {}
+  CCachedRegExpSet(const std::vector<std::string> &patterns, bool caseless = true, CRegExp::utf8Mode utf8 = CRegExp::autoUtf8)
+    : m_set(CRegExpCache::Get().Acquire(patterns, caseless, utf8)) {}
+  ~CCachedRegExpSet() { CRegExpCache::Get().Release(m_set); }
+
+  CRegExpSet *operator->() const { return m_set; }
+  CRegExpSet &operator*() const { return *m_set; }
+
+private:
+  CCachedRegExpSet(const CCachedRegExpSet&);
+  CCachedRegExpSet const& operator=(CCachedRegExpSet const&);
+
+  CRegExpSet *m_set;
+};
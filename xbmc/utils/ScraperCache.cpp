@@ -0,0 +1,367 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <limits.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "ScraperCache.h"
+#include "FileItem.h"
+#include "URL.h"
+#include "XBDateTime.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "utils/HttpHeader.h"
+#include "utils/log.h"
+#include "utils/md5.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+using namespace XFILE;
+
+struct CScraperCache::Request
+{
+  Request() : done(true), waiting(0), success(false) {}
+
+  CEvent done;
+  unsigned int waiting;
+  bool success;
+  Response response;
+};
+
+CScraperCache::CScraperCache(const std::string &folder)
+{
+  m_folder = folder;
+  URIUtils::AddSlashAtEnd(m_folder);
+  m_pruned = 0;
+  m_revalidated = 0;
+}
+
+CScraperCache::~CScraperCache()
+{
+  for (std::map<std::string, Request*>::iterator it = m_requests.begin(); it != m_requests.end(); ++it)
+    delete it->second;
+}
+
+CScraperCache &CScraperCache::Get()
+{
+  static CScraperCache sScraperCache(URIUtils::AddFileToFolder(g_advancedSettings.m_cachePath, "scrapers/http"));
+  return sScraperCache;
+}
+
+std::string CScraperCache::GetKey(const std::string &url, bool post, const std::string &postData)
+{
+  XBMC::XBMC_MD5 md5;
+  md5.append(url);
+  if (post)
+  {
+    md5.append("\npost\n");
+    md5.append(postData);
+  }
+  CStdString key;
+  md5.getDigest(key);
+  return key;
+}
+
+bool CScraperCache::Load(const std::string &key, Response &response) const
+{
+  std::string path = URIUtils::AddFileToFolder(m_folder, key);
+  if (!CFile::Exists(path))
+    return false;
+
+  CFile file;
+  auto_buffer buffer;
+  if (file.LoadFile(path, buffer) == 0)
+    return false;
+
+  std::string content(buffer.get(), buffer.length());
+  size_t end = content.find("\n\n");
+  if (end == std::string::npos)
+    return false;
+
+  size_t length = std::string::npos;
+  std::vector<std::string> lines = StringUtils::Split(content.substr(0, end), "\n");
+  for (std::vector<std::string>::const_iterator it = lines.begin(); it != lines.end(); ++it)
+  {
+    size_t pos = it->find(": ");
+    if (pos == std::string::npos)
+      continue;
+
+    std::string name = it->substr(0, pos);
+    std::string value = it->substr(pos + 2);
+    if (name == "url")
+      response.url = value;
+    else if (name == "time")
+      response.time = (time_t)strtoll(value.c_str(), NULL, 10);
+    else if (name == "length")
+      length = (size_t)strtoul(value.c_str(), NULL, 10);
+    else if (name == "mimetype")
+      response.mimeType = value;
+    else if (name == "charset")
+      response.charset = value;
+    else if (name == "etag")
+      response.etag = value;
+    else if (name == "lastmodified")
+      response.lastModified = value;
+    else if (name == "maxage")
+      response.maxAge = (int)strtol(value.c_str(), NULL, 10);
+  }
+
+  response.data = content.substr(end + 2);
+  // the file may have been left partly written
+  return response.data.size() == length;
+}
+
+bool CScraperCache::Save(const std::string &key, const Response &response)
+{
+  if (!CDirectory::Exists(m_folder))
+  {
+    CDirectory::Create(URIUtils::GetParentPath(m_folder));
+    CDirectory::Create(m_folder);
+  }
+
+  std::string header = StringUtils::Format("url: %s\ntime: %lld\nlength: %u\nmimetype: %s\ncharset: %s\netag: %s\nlastmodified: %s\nmaxage: %d\n\n",
+                                           response.url.c_str(), (long long)response.time, (unsigned int)response.data.size(),
+                                           response.mimeType.c_str(), response.charset.c_str(),
+                                           response.etag.c_str(), response.lastModified.c_str(), response.maxAge);
+
+  CFile file;
+  std::string path = URIUtils::AddFileToFolder(m_folder, key);
+  if (!file.OpenForWrite(path, true))
+  {
+    CLog::Log(LOGDEBUG, "%s - unable to write %s", __FUNCTION__, path.c_str());
+    return false;
+  }
+
+  bool result = file.Write(header.data(), header.size()) == (int)header.size() &&
+                file.Write(response.data.data(), response.data.size()) == (int)response.data.size();
+  file.Close();
+  return result;
+}
+
+// the number of seconds the site allows a response to be used for, -1 if it didn't say
+static int GetMaxAge(const CHttpHeader &header, time_t now)
+{
+  int maxAge = -1;
+  bool noCache = false;
+  std::vector<std::string> directives = StringUtils::Split(header.GetValue("cache-control"), ",");
+  for (std::vector<std::string>::iterator it = directives.begin(); it != directives.end(); ++it)
+  {
+    StringUtils::Trim(*it);
+    StringUtils::ToLower(*it);
+    if (*it == "no-cache")
+      noCache = true;
+    else if (StringUtils::StartsWith(*it, "max-age="))
+      maxAge = std::max(0, (int)strtol(it->c_str() + 8, NULL, 10));
+  }
+  if (noCache)
+    return 0;
+  if (maxAge >= 0)
+    return maxAge;
+
+  std::string expires = header.GetValue("expires");
+  if (expires.empty())
+    return -1;
+
+  // dates that can't be parsed, such as 0, mean the response has already expired
+  CDateTime expiry, date;
+  if (!expiry.SetFromRFC1123DateTime(expires))
+    return 0;
+
+  // the expiry is relative to the clock of the site
+  time_t expiryTime, dateTime = now;
+  expiry.GetAsTime(expiryTime);
+  if (date.SetFromRFC1123DateTime(header.GetValue("date")))
+    date.GetAsTime(dateTime);
+  return expiryTime > dateTime ? (int)std::min(expiryTime - dateTime, (time_t)INT_MAX) : 0;
+}
+
+static bool Receive(const std::string &url, time_t now, IScraperRequest &request, CScraperCache::Response &response)
+{
+  std::string data;
+  if (!request.Perform(data))
+    return false;
+
+  const CHttpHeader &header = request.GetHttpHeader();
+  response.url = url;
+  response.data = data;
+  response.mimeType = header.GetMimeType();
+  response.charset = header.GetCharset();
+  response.etag = header.GetValue("etag");
+  response.lastModified = header.GetValue("last-modified");
+  response.maxAge = GetMaxAge(header, now);
+  response.time = now;
+  return true;
+}
+
+bool CScraperCache::Fetch(const std::string &key, const std::string &url, unsigned int cacheTime, time_t now,
+                          IScraperRequest &request, Response &response)
+{
+  if (cacheTime == 0)
+    return Receive(url, now, request, response);
+
+  Response cached;
+  bool found = Load(key, cached) && cached.url == url;
+
+  // sites may ask for their responses to be revalidated sooner
+  time_t lifetime = cacheTime;
+  if (cached.maxAge >= 0 && cached.maxAge < lifetime)
+    lifetime = cached.maxAge;
+
+  time_t revalidated;
+  {
+    CSingleLock lock(m_critSection);
+    revalidated = m_revalidated;
+  }
+
+  if (found && cached.time <= now && now - cached.time < lifetime && cached.time >= revalidated)
+  {
+    CLog::Log(LOGDEBUG, "%s - using cached response for %s", __FUNCTION__, CURL::GetRedacted(url).c_str());
+    response = cached;
+    return true;
+  }
+
+  // ask the site whether the cached response is still valid
+  bool revalidate = found && (!cached.etag.empty() || !cached.lastModified.empty());
+  if (revalidate)
+  {
+    if (!cached.etag.empty())
+      request.SetRequestHeader("If-None-Match", cached.etag);
+    if (!cached.lastModified.empty())
+      request.SetRequestHeader("If-Modified-Since", cached.lastModified);
+  }
+
+  // the scrapers reuse their request for the following URLs
+  bool success = Receive(url, now, request, response);
+  if (revalidate)
+  {
+    request.RemoveRequestHeader("If-None-Match");
+    request.RemoveRequestHeader("If-Modified-Since");
+  }
+  if (!success)
+    return false;
+
+  if (revalidate && request.GetResponseCode() == 304)
+  {
+    CLog::Log(LOGDEBUG, "%s - cached response for %s is still valid", __FUNCTION__, CURL::GetRedacted(url).c_str());
+    cached.time = response.time;
+    if (response.maxAge >= 0)
+      cached.maxAge = response.maxAge;
+    response = cached;
+  }
+  else if (request.GetHttpHeader().GetValue("cache-control").find("no-store") != std::string::npos)
+    return true;
+
+  Save(key, response);
+  return true;
+}
+
+void CScraperCache::Revalidate()
+{
+  CSingleLock lock(m_critSection);
+  m_revalidated = time(NULL);
+}
+
+void CScraperCache::Prune(unsigned int age)
+{
+  {
+    // scrapers clear their cache before each item
+    CSingleLock lock(m_critSection);
+    time_t now = time(NULL);
+    if (m_pruned <= now && now - m_pruned < 3600)
+      return;
+    m_pruned = now;
+  }
+
+  if (!CDirectory::Exists(m_folder))
+    return;
+
+  CFileItemList items;
+  CDirectory::GetDirectory(m_folder, items, "", DIR_FLAG_NO_FILE_DIRS);
+  CDateTime expired = CDateTime::GetCurrentDateTime() - CDateTimeSpan(0, 0, 0, age);
+  for (int i = 0; i < items.Size(); ++i)
+  {
+    if (!items[i]->m_bIsFolder && items[i]->m_dateTime <= expired)
+      CFile::Delete(items[i]->GetPath());
+  }
+}
+
+bool CScraperCache::Join(const std::string &key, Response &response)
+{
+  CSingleLock lock(m_critSection);
+  while (true)
+  {
+    std::map<std::string, Request*>::iterator it = m_requests.find(key);
+    if (it == m_requests.end())
+    {
+      m_requests.insert(std::make_pair(key, new Request));
+      return false;
+    }
+
+    Request *request = it->second;
+    request->waiting++;
+    lock.Leave();
+    request->done.Wait();
+    lock.Enter();
+
+    bool success = request->success;
+    if (success)
+      response = request->response;
+    if (--request->waiting == 0)
+      delete request;
+    if (success)
+      return true;
+
+    // the other thread's request failed, e.g. as it was cancelled, so try on our own
+  }
+}
+
+unsigned int CScraperCache::GetWaiting(const std::string &key)
+{
+  CSingleLock lock(m_critSection);
+  std::map<std::string, Request*>::const_iterator it = m_requests.find(key);
+  return it != m_requests.end() ? it->second->waiting : 0;
+}
+
+void CScraperCache::Leave(const std::string &key, bool success, const Response &response)
+{
+  CSingleLock lock(m_critSection);
+  std::map<std::string, Request*>::iterator it = m_requests.find(key);
+  if (it == m_requests.end())
+    return;
+
+  Request *request = it->second;
+  m_requests.erase(it);
+  if (request->waiting == 0)
+  {
+    delete request;
+    return;
+  }
+
+  // the last of the waiting threads deletes the request
+  request->success = success;
+  if (success)
+    request->response = response;
+  request->done.Set();
+}
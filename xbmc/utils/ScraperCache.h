@@ -0,0 +1,147 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <string>
+#include <time.h>
+
+#include "threads/CriticalSection.h"
+
+class CHttpHeader;
+class TestScraperCache;
+
+/*!
+ \brief A request to the site a scraper response is fetched from, made by CScraperCache::Fetch.
+
+ CScraperUrl makes the requests with the CCurlFile of the scraper.
+ */
+class IScraperRequest
+{
+public:
+  virtual ~IScraperRequest() {}
+
+  virtual void SetRequestHeader(const std::string &header, const std::string &value) = 0;
+  virtual void RemoveRequestHeader(const std::string &header) = 0;
+
+  /*! \brief Make the request, with the request headers set.
+   \param data the body of the response.
+   \return false if the request failed.
+   */
+  virtual bool Perform(std::string &data) = 0;
+  virtual long GetResponseCode() = 0;
+  virtual const CHttpHeader &GetHttpHeader() = 0;
+};
+
+/*!
+ \brief On-disk cache of the responses the scrapers get from the sites they scrape.
+
+ Responses are kept as they were received, keyed by their URL and post data, along with
+ the headers needed to decode and revalidate them. Fetch uses a response without
+ asking the site for scrapercachetime seconds after it was fetched, or for less if the
+ site said so with Cache-Control or Expires. Once that has passed, the site is asked
+ whether it changed, if it sent an ETag or Last-Modified.
+
+ Requests for the same URL made on several threads at once are coalesced, the first
+ thread fetches the response and the others wait for it.
+ */
+class CScraperCache
+{
+public:
+  struct Response
+  {
+    Response() : time(0), maxAge(-1) {}
+
+    std::string url;
+    std::string data;           ///< the body as received, before it's unpacked or converted
+    std::string mimeType;
+    std::string charset;        ///< the charset reported by the server
+    std::string etag;
+    std::string lastModified;
+    time_t time;                ///< when the response was fetched or last revalidated
+    int maxAge;                 ///< the number of seconds the site allows the response to be used for, -1 if it didn't say
+  };
+
+  /*! \brief Create a cache keeping its responses in the given folder.
+   */
+  CScraperCache(const std::string &folder);
+  ~CScraperCache();
+
+  /*! \brief Get the cache below the cache path used by CScraperUrl.
+   */
+  static CScraperCache &Get();
+
+  static std::string GetKey(const std::string &url, bool post, const std::string &postData);
+
+  bool Load(const std::string &key, Response &response) const;
+  bool Save(const std::string &key, const Response &response);
+
+  /*! \brief Get the response to a request, from the cache while it's fresh, otherwise from the site.
+   A cached response with an ETag or Last-Modified is revalidated with the site rather than fetched again.
+   \param key the key of the request.
+   \param url the URL of the request, kept with the response.
+   \param cacheTime the number of seconds a response is used without asking the site, 0 to not cache it.
+   \param now the current time.
+   \param request the request to make to the site.
+   \param response the response.
+   \return false if the request to the site failed.
+   */
+  bool Fetch(const std::string &key, const std::string &url, unsigned int cacheTime, time_t now,
+             IScraperRequest &request, Response &response);
+
+  /*! \brief Have the responses cached so far revalidated with the site before they're used again.
+   Called when the user asks for the details of an item to be fetched again.
+   */
+  void Revalidate();
+
+  /*! \brief Delete the responses fetched or revalidated more than the given number of seconds ago.
+   Does nothing if the cache was pruned within the last hour.
+   */
+  void Prune(unsigned int age);
+
+  /*! \brief Wait for a request for the same key made on another thread.
+   \param key the key of the request.
+   \param response the response the other thread received.
+   \return true if another thread received the response, false if the caller is to fetch it and call Leave.
+   */
+  bool Join(const std::string &key, Response &response);
+
+  /*! \brief Pass the result of a request to the threads waiting for it in Join.
+   */
+  void Leave(const std::string &key, bool success, const Response &response);
+
+private:
+  friend class ::TestScraperCache;
+
+  CScraperCache(const CScraperCache&);
+  CScraperCache const& operator=(CScraperCache const&);
+
+  struct Request;
+
+  /*! \brief Get the number of threads waiting in Join for a request.
+   */
+  unsigned int GetWaiting(const std::string &key);
+
+  std::string m_folder;
+  time_t m_pruned;
+  time_t m_revalidated;
+  std::map<std::string, Request*> m_requests;
+  CCriticalSection m_critSection;
+};
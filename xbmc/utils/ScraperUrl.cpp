@@ -31,6 +31,7 @@
 #include "URIUtils.h"
 #include "utils/XBMCTinyXML.h"
 #include "utils/Mime.h"
+#include "utils/ScraperCache.h"
 
 #include <cstring>
 #include <sstream>
@@ -198,6 +199,38 @@ unsigned int CScraperUrl::GetMaxSeasonThumb() const
   return maxSeason;
 }
 
+namespace
+{
+// the requests of the scraper cache, made with the CCurlFile of the scraper
+class CCurlScraperRequest : public IScraperRequest
+{
+public:
+  CCurlScraperRequest(const CURL &url, bool post, const CStdString &postData, XFILE::CCurlFile &http)
+    : m_url(url), m_post(post), m_postData(postData), m_http(http) {}
+
+  virtual void SetRequestHeader(const std::string &header, const std::string &value) { m_http.SetRequestHeader(header, value); }
+  virtual void RemoveRequestHeader(const std::string &header)                        { m_http.RemoveRequestHeader(header); }
+
+  virtual bool Perform(std::string &data)
+  {
+    CStdString strHTML;
+    if (m_post ? !m_http.Post(m_url.Get(), m_postData, strHTML) : !m_http.Get(m_url.Get(), strHTML))
+      return false;
+    data = strHTML;
+    return true;
+  }
+
+  virtual long GetResponseCode()                 { return m_http.GetResponseCode(); }
+  virtual const CHttpHeader &GetHttpHeader()     { return m_http.GetHttpHeader(); }
+
+private:
+  const CURL &m_url;
+  bool m_post;
+  const CStdString &m_postData;
+  XFILE::CCurlFile &m_http;
+};
+}
+
 bool CScraperUrl::Get(const SUrlEntry& scrURL, std::string& strHTML, XFILE::CCurlFile& http, const CStdString& cacheContext)
 {
   CURL url(scrURL.m_url);
@@ -223,24 +256,34 @@ bool CScraperUrl::Get(const SUrlEntry& scrURL, std::string& strHTML, XFILE::CCur
     }
   }
 
-  CStdString strHTML1(strHTML);
-
+  CStdString strOptions;
   if (scrURL.m_post)
   {
-    CStdString strOptions = url.GetOptions();
+    strOptions = url.GetOptions();
     strOptions = strOptions.substr(1);
     url.SetOptions("");
+  }
 
-    if (!http.Post(url.Get(), strOptions, strHTML1))
+  // requests for the same URL made at once, e.g. for the episodes of a show, are only made once
+  CScraperCache::Response response;
+  std::string key = CScraperCache::GetKey(url.Get(), scrURL.m_post, strOptions);
+  if (!CScraperCache::Get().Join(key, response))
+  {
+    // only responses from the web are cached, and not those to posts, which sites don't expect to be reused
+    unsigned int cacheTime = g_advancedSettings.m_scraperCacheTime;
+    if (scrURL.m_post || (!url.GetProtocol().Equals("http") && !url.GetProtocol().Equals("https")))
+      cacheTime = 0;
+
+    CCurlScraperRequest request(url, scrURL.m_post, strOptions, http);
+    bool success = CScraperCache::Get().Fetch(key, url.Get(), cacheTime, time(NULL), request, response);
+    CScraperCache::Get().Leave(key, success, response);
+    if (!success)
       return false;
   }
-  else
-    if (!http.Get(url.Get(), strHTML1))
-      return false;
 
-  strHTML = strHTML1;
+  strHTML = response.data;
 
-  std::string mimeType(http.GetMimeType());
+  std::string mimeType(response.mimeType);
   CMime::EFileType ftype = CMime::GetFileTypeFromMime(mimeType);
   if (ftype == CMime::FileTypeUnknown)
     ftype = CMime::GetFileTypeFromContent(strHTML);
@@ -259,7 +302,7 @@ bool CScraperUrl::Get(const SUrlEntry& scrURL, std::string& strHTML, XFILE::CCur
       CLog::Log(LOGWARNING, "%s: \"%s\" looks like archive, but cannot be unpacked", __FUNCTION__, scrURL.m_url.c_str());
   }
 
-  std::string reportedCharset(http.GetServerReportedCharset());
+  std::string reportedCharset(response.charset);
   if (ftype == CMime::FileTypeHtml)
   {
     std::string realHtmlCharset, converted;
@@ -0,0 +1,128 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+
+#include "TrigramIndex.h"
+#include "utils/StringUtils.h"
+
+static bool SimilaritySortFunction(const std::pair<double, int> &left, const std::pair<double, int> &right)
+{
+  if (left.first != right.first)
+    return left.first > right.first;
+  return left.second < right.second;
+}
+
+void CTrigramIndex::GetTrigrams(const std::string &str, std::vector<unsigned int> &trigrams)
+{
+  // the padding gives the start and the end of a word more weight, and short strings trigrams at all
+  std::string padded = "  " + str + " ";
+
+  trigrams.clear();
+  trigrams.reserve(padded.size() - 2);
+  for (size_t i = 0; i + 2 < padded.size(); i++)
+    trigrams.push_back(((unsigned char)padded[i] << 16) | ((unsigned char)padded[i + 1] << 8) | (unsigned char)padded[i + 2]);
+
+  std::sort(trigrams.begin(), trigrams.end());
+  trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+void CTrigramIndex::Add(const std::string &str)
+{
+  int index = (int)m_strings.size();
+  m_strings.push_back(str);
+
+  std::vector<unsigned int> trigrams;
+  GetTrigrams(str, trigrams);
+  m_trigramCounts.push_back(trigrams.size());
+  for (std::vector<unsigned int>::const_iterator it = trigrams.begin(); it != trigrams.end(); ++it)
+    m_postings[*it].push_back(index);
+}
+
+void CTrigramIndex::Clear()
+{
+  m_strings.clear();
+  m_trigramCounts.clear();
+  m_postings.clear();
+}
+
+void CTrigramIndex::FindCandidates(const std::string &query, size_t count, std::vector<int> &candidates) const
+{
+  candidates.clear();
+
+  std::vector<unsigned int> trigrams;
+  GetTrigrams(query, trigrams);
+
+  // count the trigrams each string shares with the query
+  std::vector<unsigned int> shared(m_strings.size(), 0);
+  for (std::vector<unsigned int>::const_iterator it = trigrams.begin(); it != trigrams.end(); ++it)
+  {
+    std::map<unsigned int, std::vector<int> >::const_iterator posting = m_postings.find(*it);
+    if (posting == m_postings.end())
+      continue;
+    const std::vector<int> &strings = posting->second;
+    for (size_t i = 0; i < strings.size(); i++)
+      shared[strings[i]]++;
+  }
+
+  // rank the strings by the dice coefficient of their trigrams
+  std::vector<std::pair<double, int> > scores;
+  for (size_t i = 0; i < shared.size(); i++)
+  {
+    if (shared[i] > 0)
+      scores.push_back(std::make_pair(2.0 * shared[i] / (trigrams.size() + m_trigramCounts[i]), (int)i));
+  }
+
+  count = std::min(count, scores.size());
+  std::partial_sort(scores.begin(), scores.begin() + count, scores.end(), SimilaritySortFunction);
+  for (size_t i = 0; i < count; i++)
+    candidates.push_back(scores[i].second);
+}
+
+int CTrigramIndex::FindBestMatch(const std::string &query, double &matchscore, size_t candidates /* = 16 */) const
+{
+  std::vector<int> indices;
+  if (m_strings.size() <= candidates)
+  {
+    for (size_t i = 0; i < m_strings.size(); i++)
+      indices.push_back((int)i);
+  }
+  else
+  {
+    FindCandidates(query, candidates, indices);
+    // equal scores go to the first string in the list, as with a full comparison
+    std::sort(indices.begin(), indices.end());
+  }
+
+  int best = -1;
+  matchscore = 0;
+  for (std::vector<int>::const_iterator it = indices.begin(); it != indices.end(); ++it)
+  {
+    const std::string &str = m_strings[*it];
+    int maxlength = std::max(query.length(), str.length());
+    double score = StringUtils::CompareFuzzy(query, str) / maxlength;
+    if (score > matchscore)
+    {
+      matchscore = score;
+      best = *it;
+    }
+  }
+  return best;
+}
@@ -0,0 +1,70 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+/*!
+ \brief Finds the strings of a list that are similar to a query, without comparing it to each of them.
+
+ The strings are indexed by the trigrams (three byte sequences) they contain. The strings sharing
+ the most trigrams with a query are taken as candidates and only those are compared with fstrcmp,
+ which takes time proportional to the product of the lengths of the strings it compares.
+
+ Strings are compared as they are, callers wanting a case insensitive match lower both sides.
+ */
+class CTrigramIndex
+{
+public:
+  /*! \brief Add a string to the index.
+   \param str the string to add, it gets the index of the number of strings added before it.
+   */
+  void Add(const std::string &str);
+  void Clear();
+
+  size_t Size() const { return m_strings.size(); }
+  const std::string &Get(size_t index) const { return m_strings[index]; }
+
+  /*! \brief Get the strings sharing the most trigrams with a query.
+   \param query the string to look for.
+   \param count the maximum number of strings to return.
+   \param candidates [out] the indices of the strings, the most similar first.
+   */
+  void FindCandidates(const std::string &query, size_t count, std::vector<int> &candidates) const;
+
+  /*! \brief Find the string matching a query best, as StringUtils::FindBestMatch does.
+   Only the candidates of the index are compared, a list no larger than that is compared in full.
+   A close match shares most of its trigrams with the query and is found, a poor one may be missed.
+   \param query the string to look for.
+   \param matchscore [out] the score of the best match, 0 if there's none.
+   \param candidates the number of candidates to compare.
+   \return the index of the best match, -1 if none is found.
+   */
+  int FindBestMatch(const std::string &query, double &matchscore, size_t candidates = 16) const;
+
+private:
+  static void GetTrigrams(const std::string &str, std::vector<unsigned int> &trigrams);
+
+  std::vector<std::string> m_strings;
+  std::vector<unsigned int> m_trigramCounts;                ///< number of distinct trigrams of each string
+  std::map<unsigned int, std::vector<int> > m_postings;     ///< strings containing each trigram
+};
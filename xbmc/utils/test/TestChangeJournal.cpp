@@ -0,0 +1,172 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+
+#ifdef HAVE_INOTIFY
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/ChangeJournal.h"
+#include "utils/URIUtils.h"
+
+class TestChangeJournal : public testing::Test
+{
+protected:
+  TestChangeJournal()
+  {
+    root = URIUtils::AddFileToFolder(CSpecialProtocol::TranslatePath("special://temp/"), "TestChangeJournal/");
+    outside = URIUtils::AddFileToFolder(CSpecialProtocol::TranslatePath("special://temp/"), "TestChangeJournalOutside/");
+    Remove(root);
+    Remove(outside);
+    XFILE::CDirectory::Create(root);
+    XFILE::CDirectory::Create(root + "a");
+    XFILE::CDirectory::Create(root + "b");
+  }
+
+  ~TestChangeJournal()
+  {
+    // the folders of the next test are watched from scratch
+    CChangeJournal::Get().Stop();
+    Remove(root);
+    Remove(outside);
+  }
+
+  void Touch(const std::string &path)
+  {
+    XFILE::CFile file;
+    if (file.OpenForWrite(root + path, true))
+    {
+      file.Write("x", 1);
+      file.Close();
+    }
+  }
+
+  void Remove(const std::string &folder)
+  {
+    CFileItemList items;
+    XFILE::CDirectory::GetDirectory(folder, items);
+    for (int i = 0; i < items.Size(); i++)
+    {
+      if (items[i]->m_bIsFolder)
+        Remove(items[i]->GetPath());
+      else
+        XFILE::CFile::Delete(items[i]->GetPath());
+    }
+    XFILE::CDirectory::Remove(folder);
+  }
+
+  std::string root;
+  std::string outside;
+};
+
+TEST_F(TestChangeJournal, NotWatched)
+{
+  unsigned int cursor = CChangeJournal::Get().GetCursor();
+  EXPECT_FALSE(CChangeJournal::Get().Watch("smb://server/share/"));
+  EXPECT_TRUE(CChangeJournal::Get().HasChanged("smb://server/share/", cursor));
+
+  // changes made before a folder was watched aren't known
+  ASSERT_TRUE(CChangeJournal::Get().Watch(root));
+  EXPECT_TRUE(CChangeJournal::Get().HasChanged(root, cursor));
+}
+
+TEST_F(TestChangeJournal, HasChanged)
+{
+  ASSERT_TRUE(CChangeJournal::Get().Watch(root));
+
+  unsigned int cursor = CChangeJournal::Get().GetCursor();
+  EXPECT_FALSE(CChangeJournal::Get().HasChanged(root, cursor));
+
+  Touch("a/movie.mkv");
+  EXPECT_TRUE(CChangeJournal::Get().HasChanged(root, cursor));
+  EXPECT_TRUE(CChangeJournal::Get().HasChanged(root + "a", cursor));
+  EXPECT_FALSE(CChangeJournal::Get().HasChanged(root + "b/", cursor));
+
+  // folders created later are watched as well
+  XFILE::CDirectory::Create(root + "b/c");
+  cursor = CChangeJournal::Get().GetCursor();
+  Touch("b/c/movie.mkv");
+  EXPECT_TRUE(CChangeJournal::Get().HasChanged(root + "b/", cursor));
+  EXPECT_FALSE(CChangeJournal::Get().HasChanged(root + "a/", cursor));
+
+  cursor = CChangeJournal::Get().GetCursor();
+  CChangeJournal::Get().MarkChanged(root + "a");
+  EXPECT_TRUE(CChangeJournal::Get().HasChanged(root + "a/", cursor));
+}
+
+TEST_F(TestChangeJournal, MovedIn)
+{
+  XFILE::CDirectory::Create(outside);
+  XFILE::CDirectory::Create(outside + "show");
+  XFILE::CDirectory::Create(outside + "show/season 1");
+  XFILE::CFile file;
+  ASSERT_TRUE(file.OpenForWrite(outside + "show/season 1/episode.mkv", true));
+  file.Close();
+
+  ASSERT_TRUE(CChangeJournal::Get().Watch(root));
+  unsigned int cursor = CChangeJournal::Get().GetCursor();
+
+  // the folders of a tree moved in are all new to the scanners
+  ASSERT_TRUE(XFILE::CFile::Rename(outside + "show", root + "b/show"));
+  EXPECT_TRUE(CChangeJournal::Get().HasChanged(root + "b/show/season 1/", cursor));
+  EXPECT_FALSE(CChangeJournal::Get().HasChanged(root + "a/", cursor));
+
+  cursor = CChangeJournal::Get().GetCursor();
+  EXPECT_FALSE(CChangeJournal::Get().HasChanged(root + "b/show/season 1/", cursor));
+  Touch("b/show/season 1/episode.mkv");
+  EXPECT_TRUE(CChangeJournal::Get().HasChanged(root + "b/show/season 1/", cursor));
+}
+
+TEST_F(TestChangeJournal, NestedRoots)
+{
+  // a music source inside a video source
+  XFILE::CDirectory::Create(root + "a/c");
+  ASSERT_TRUE(CChangeJournal::Get().Watch(root + "a/"));
+  ASSERT_TRUE(CChangeJournal::Get().Watch(root));
+  unsigned int cursor = CChangeJournal::Get().GetCursor();
+  EXPECT_FALSE(CChangeJournal::Get().HasChanged(root + "a/", cursor));
+
+  // a link to a folder below the inner root stops the watching of both
+  ASSERT_EQ(0, symlink((root + "b").c_str(), (root + "a/c/link").c_str()));
+  cursor = CChangeJournal::Get().GetCursor();
+  Touch("a/movie.mkv");
+  Touch("b/movie.mkv");
+  EXPECT_TRUE(CChangeJournal::Get().HasChanged(root + "a/", cursor));
+  EXPECT_TRUE(CChangeJournal::Get().HasChanged(root + "b/", cursor));
+  EXPECT_TRUE(CChangeJournal::Get().HasChanged(root, cursor));
+  unlink((root + "a/c/link").c_str());
+}
+
+TEST_F(TestChangeJournal, Removed)
+{
+  ASSERT_TRUE(CChangeJournal::Get().Watch(root));
+  unsigned int cursor = CChangeJournal::Get().GetCursor();
+
+  Remove(root);
+  EXPECT_TRUE(CChangeJournal::Get().HasChanged(root, CChangeJournal::Get().GetCursor()));
+  EXPECT_TRUE(CChangeJournal::Get().HasChanged(root, cursor));
+}
+#endif
@@ -0,0 +1,79 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include "utils/RegExpCache.h"
+
+static std::vector<std::string> Patterns(const char *first, const char *second, const char *third)
+{
+  std::vector<std::string> patterns;
+  patterns.push_back(first);
+  patterns.push_back(second);
+  patterns.push_back(third);
+  return patterns;
+}
+
+TEST(TestRegExpCache, FindAny)
+{
+  CRegExpSet set(Patterns("-trailer", "(^|[/\\\\])sample([/\\\\]|$)", "\\.(tmp|part)$"), true, CRegExp::autoUtf8);
+
+  EXPECT_EQ(0, set.FindAny("/movies/Movie-TRAILER.mkv"));
+  EXPECT_EQ(1, set.FindAny("/movies/Sample/movie.mkv"));
+  EXPECT_EQ(2, set.FindAny("/movies/movie.part"));
+  EXPECT_EQ(-1, set.FindAny("/movies/movie.mkv"));
+}
+
+TEST(TestRegExpCache, FindAnyBackReference)
+{
+  // a back reference can't be moved into a combined expression
+  CRegExpSet set(Patterns("(a)(b)", "(x)\\1", "(y)(z)"), true, CRegExp::autoUtf8);
+
+  EXPECT_EQ(1, set.FindAny("__xx__"));
+  EXPECT_EQ(-1, set.FindAny("__xy__"));
+  EXPECT_EQ(2, set.FindAny("__yz__"));
+  EXPECT_EQ(0, set.FindAny("__ab__"));
+}
+
+TEST(TestRegExpCache, InvalidPattern)
+{
+  CRegExpSet set(Patterns("abc", "(unbalanced", "def"), true, CRegExp::autoUtf8);
+
+  ASSERT_EQ(3U, set.Size());
+  EXPECT_TRUE(set.Get(0) != NULL);
+  EXPECT_TRUE(set.Get(1) == NULL);
+  EXPECT_EQ(2, set.FindAny("xdefx"));
+}
+
+TEST(TestRegExpCache, Acquire)
+{
+  std::vector<std::string> patterns = Patterns("one", "two", "three");
+
+  CRegExpSet *first = CRegExpCache::Get().Acquire(patterns);
+  CRegExpSet *second = CRegExpCache::Get().Acquire(patterns);
+  EXPECT_NE(first, second);
+
+  CRegExpCache::Get().Release(first);
+  CRegExpSet *third = CRegExpCache::Get().Acquire(patterns);
+  EXPECT_EQ(first, third);
+
+  CRegExpCache::Get().Release(second);
+  CRegExpCache::Get().Release(third);
+}
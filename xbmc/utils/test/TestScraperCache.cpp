@@ -0,0 +1,414 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/ScraperCache.h"
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/Thread.h"
+#include "utils/HttpHeader.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+class TestScraperCache : public testing::Test
+{
+protected:
+  TestScraperCache()
+  {
+    folder = URIUtils::AddFileToFolder(CSpecialProtocol::TranslatePath("special://temp/"), "TestScraperCache");
+  }
+
+  ~TestScraperCache()
+  {
+    CFileItemList items;
+    XFILE::CDirectory::GetDirectory(folder, items);
+    for (int i = 0; i < items.Size(); i++)
+      XFILE::CFile::Delete(items[i]->GetPath());
+    XFILE::CDirectory::Remove(folder);
+  }
+
+  // wait for the given number of threads to wait in Join
+  void WaitForJoin(CScraperCache &cache, const std::string &key, unsigned int waiting)
+  {
+    while (cache.GetWaiting(key) < waiting)
+      XbmcThreads::ThreadSleep(1);
+  }
+
+  std::string folder;
+};
+
+class CJoinThread : public CThread
+{
+public:
+  CJoinThread(CScraperCache &cache, const std::string &key)
+    : CThread("TestScraperCache"), m_cache(cache), m_key(key), m_joined(false), m_done(false) {}
+
+  virtual void Process()
+  {
+    m_joined = m_cache.Join(m_key, m_response);
+    m_done = true;
+  }
+
+  CScraperCache &m_cache;
+  std::string m_key;
+  CScraperCache::Response m_response;
+  volatile bool m_joined;
+  volatile bool m_done;
+};
+
+// a site answering with the given code, headers and body
+class CTestScraperRequest : public IScraperRequest
+{
+public:
+  CTestScraperRequest() : code(200), fail(false), requests(0) {}
+
+  virtual void SetRequestHeader(const std::string &header, const std::string &value) { headers[header] = value; }
+  virtual void RemoveRequestHeader(const std::string &header)                        { headers.erase(header); }
+
+  virtual bool Perform(std::string &data)
+  {
+    requests++;
+    sent = headers;
+    data = code == 304 ? "" : body;
+    return !fail;
+  }
+
+  virtual long GetResponseCode()             { return code; }
+  virtual const CHttpHeader &GetHttpHeader() { return header; }
+
+  long code;
+  bool fail;
+  std::string body;
+  CHttpHeader header;
+  std::map<std::string, std::string> headers; ///< the headers set for the next request
+  std::map<std::string, std::string> sent;    ///< the headers sent with the last request
+  unsigned int requests;
+};
+
+TEST_F(TestScraperCache, GetKey)
+{
+  std::string key = CScraperCache::GetKey("http://example.com/search?q=a", false, "");
+  EXPECT_EQ(32U, key.size());
+  EXPECT_EQ(key, CScraperCache::GetKey("http://example.com/search?q=a", false, ""));
+  EXPECT_NE(key, CScraperCache::GetKey("http://example.com/search?q=b", false, ""));
+  EXPECT_NE(key, CScraperCache::GetKey("http://example.com/search?q=a", true, ""));
+  EXPECT_NE(CScraperCache::GetKey("http://example.com/search", true, "q=a"),
+            CScraperCache::GetKey("http://example.com/search", true, "q=b"));
+}
+
+TEST_F(TestScraperCache, SaveLoad)
+{
+  CScraperCache cache(folder);
+  CScraperCache::Response response, loaded;
+  std::string key = CScraperCache::GetKey("http://example.com/show/1.zip", false, "");
+  EXPECT_FALSE(cache.Load(key, loaded));
+
+  response.url = "http://example.com/show/1.zip";
+  response.data = std::string("PK\x03\x04\n\n\0binary", 15);
+  response.mimeType = "application/zip";
+  response.etag = "\"1234\"";
+  response.lastModified = "Sat, 02 Nov 2013 10:00:00 GMT";
+  response.time = 1383386400;
+  ASSERT_TRUE(cache.Save(key, response));
+
+  ASSERT_TRUE(cache.Load(key, loaded));
+  EXPECT_EQ(response.url, loaded.url);
+  EXPECT_EQ(response.data, loaded.data);
+  EXPECT_EQ(response.mimeType, loaded.mimeType);
+  EXPECT_EQ("", loaded.charset);
+  EXPECT_EQ(response.etag, loaded.etag);
+  EXPECT_EQ(response.lastModified, loaded.lastModified);
+  EXPECT_EQ(response.time, loaded.time);
+}
+
+TEST_F(TestScraperCache, Truncated)
+{
+  CScraperCache cache(folder);
+  CScraperCache::Response response, loaded;
+  std::string key = CScraperCache::GetKey("http://example.com/", false, "");
+  response.url = "http://example.com/";
+  response.data = "<html></html>";
+  ASSERT_TRUE(cache.Save(key, response));
+
+  XFILE::CFile file;
+  XFILE::auto_buffer buffer;
+  std::string path = URIUtils::AddFileToFolder(folder, key);
+  ASSERT_TRUE(file.LoadFile(path, buffer) > 0);
+  ASSERT_TRUE(file.OpenForWrite(path, true));
+  file.Write(buffer.get(), buffer.length() - 3);
+  file.Close();
+
+  EXPECT_FALSE(cache.Load(key, loaded));
+}
+
+TEST_F(TestScraperCache, Coalesce)
+{
+  CScraperCache cache(folder);
+  CScraperCache::Response response;
+  std::string key = CScraperCache::GetKey("http://example.com/", false, "");
+  ASSERT_FALSE(cache.Join(key, response));
+
+  CJoinThread first(cache, key), second(cache, key);
+  first.Create();
+  second.Create();
+  WaitForJoin(cache, key, 2);
+  EXPECT_FALSE(first.m_done);
+  EXPECT_FALSE(second.m_done);
+
+  response.data = "<html></html>";
+  cache.Leave(key, true, response);
+  first.StopThread(true);
+  second.StopThread(true);
+  EXPECT_TRUE(first.m_joined);
+  EXPECT_TRUE(second.m_joined);
+  EXPECT_EQ(response.data, first.m_response.data);
+  EXPECT_EQ(response.data, second.m_response.data);
+
+  // the request is done, the next one is made again
+  EXPECT_FALSE(cache.Join(key, response));
+  cache.Leave(key, false, response);
+}
+
+TEST_F(TestScraperCache, CoalesceFailed)
+{
+  CScraperCache cache(folder);
+  CScraperCache::Response response;
+  std::string key = CScraperCache::GetKey("http://example.com/", false, "");
+  ASSERT_FALSE(cache.Join(key, response));
+
+  CJoinThread thread(cache, key);
+  thread.Create();
+  WaitForJoin(cache, key, 1);
+  EXPECT_FALSE(thread.m_done);
+
+  // a waiting thread makes the request itself if the first one fails
+  cache.Leave(key, false, response);
+  thread.StopThread(true);
+  EXPECT_FALSE(thread.m_joined);
+  cache.Leave(key, false, response);
+}
+
+TEST_F(TestScraperCache, Fresh)
+{
+  CScraperCache cache(folder);
+  CScraperCache::Response response, loaded;
+  CTestScraperRequest site;
+  std::string url = "http://example.com/";
+  std::string key = CScraperCache::GetKey(url, false, "");
+  site.body = "<html>new</html>";
+  site.header.AddParam("content-type", "text/html; charset=ISO-8859-1");
+
+  response.url = url;
+  response.data = "<html>old</html>";
+  response.time = 1000;
+  ASSERT_TRUE(cache.Save(key, response));
+
+  // the cached response is used without asking the site while it's fresh
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 1000 + 3599, site, response));
+  EXPECT_EQ(0U, site.requests);
+  EXPECT_EQ("<html>old</html>", response.data);
+
+  // it's fetched again once it's expired, as there's nothing to revalidate it with
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 1000 + 3600, site, response));
+  EXPECT_EQ(1U, site.requests);
+  EXPECT_TRUE(site.sent.empty());
+  EXPECT_EQ(site.body, response.data);
+  EXPECT_EQ("text/html", response.mimeType);
+  EXPECT_EQ("ISO-8859-1", response.charset);
+  ASSERT_TRUE(cache.Load(key, loaded));
+  EXPECT_EQ(site.body, loaded.data);
+  EXPECT_EQ(1000 + 3600, loaded.time);
+
+  // nothing is cached if the cache is disabled
+  ASSERT_TRUE(cache.Fetch(key, url, 0, 1000 + 3601, site, response));
+  EXPECT_EQ(2U, site.requests);
+  ASSERT_TRUE(cache.Load(key, loaded));
+  EXPECT_EQ(1000 + 3600, loaded.time);
+}
+
+TEST_F(TestScraperCache, Revalidate)
+{
+  CScraperCache cache(folder);
+  CScraperCache::Response response, loaded;
+  CTestScraperRequest site;
+  std::string url = "http://example.com/show/1.xml";
+  std::string key = CScraperCache::GetKey(url, false, "");
+
+  response.url = url;
+  response.data = "<show/>";
+  response.etag = "\"1234\"";
+  response.lastModified = "Sat, 02 Nov 2013 10:00:00 GMT";
+  response.time = 1000;
+  ASSERT_TRUE(cache.Save(key, response));
+
+  // a response that didn't change is renewed
+  site.code = 304;
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 8200, site, response));
+  EXPECT_EQ(1U, site.requests);
+  EXPECT_EQ("\"1234\"", site.sent["If-None-Match"]);
+  EXPECT_EQ("Sat, 02 Nov 2013 10:00:00 GMT", site.sent["If-Modified-Since"]);
+  EXPECT_EQ("<show/>", response.data);
+  ASSERT_TRUE(cache.Load(key, loaded));
+  EXPECT_EQ("<show/>", loaded.data);
+  EXPECT_EQ(8200, loaded.time);
+  EXPECT_EQ("\"1234\"", loaded.etag);
+
+  // the conditional headers aren't sent with the following requests of the scraper
+  EXPECT_TRUE(site.headers.empty());
+  site.fail = true;
+  EXPECT_FALSE(cache.Fetch(key, url, 3600, 8200 + 3600, site, response));
+  EXPECT_EQ(2U, site.sent.size());
+  EXPECT_TRUE(site.headers.empty());
+
+  // a response that changed replaces the cached one
+  site.fail = false;
+  site.code = 200;
+  site.body = "<show>new</show>";
+  site.header.AddParam("etag", "\"5678\"");
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 8200 + 3600, site, response));
+  EXPECT_EQ("<show>new</show>", response.data);
+  ASSERT_TRUE(cache.Load(key, loaded));
+  EXPECT_EQ("<show>new</show>", loaded.data);
+  EXPECT_EQ("\"5678\"", loaded.etag);
+  EXPECT_EQ("", loaded.lastModified);
+}
+
+TEST_F(TestScraperCache, NoStore)
+{
+  CScraperCache cache(folder);
+  CScraperCache::Response response, loaded;
+  CTestScraperRequest site;
+  std::string url = "http://example.com/search?q=a";
+  std::string key = CScraperCache::GetKey(url, false, "");
+  site.body = "<results/>";
+  site.header.AddParam("cache-control", "private, no-store");
+
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 1000, site, response));
+  EXPECT_EQ("<results/>", response.data);
+  EXPECT_FALSE(cache.Load(key, loaded));
+}
+
+TEST_F(TestScraperCache, Freshness)
+{
+  CScraperCache cache(folder);
+  CScraperCache::Response response, loaded;
+  CTestScraperRequest site;
+  std::string url = "http://example.com/movie/1.json";
+  std::string key = CScraperCache::GetKey(url, false, "");
+  site.body = "{}";
+  site.header.AddParam("etag", "\"1\"");
+
+  // the site keeps the response fresh for less than the cache would
+  site.header.AddParam("cache-control", "public, max-age=60");
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 1000, site, response));
+  ASSERT_TRUE(cache.Load(key, loaded));
+  EXPECT_EQ(60, loaded.maxAge);
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 1059, site, response));
+  EXPECT_EQ(1U, site.requests);
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 1060, site, response));
+  EXPECT_EQ(2U, site.requests);
+  EXPECT_EQ("\"1\"", site.sent["If-None-Match"]);
+
+  // but not for longer
+  site.header.AddParam("cache-control", "max-age=86400", true);
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 2000, site, response));
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 2000 + 3600, site, response));
+  EXPECT_EQ(4U, site.requests);
+
+  // responses the site wants revalidated are, every time
+  site.header.AddParam("cache-control", "no-cache, max-age=600", true);
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 9200, site, response));
+  ASSERT_TRUE(cache.Load(key, loaded));
+  EXPECT_EQ(0, loaded.maxAge);
+  site.code = 304;
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 9200, site, response));
+  EXPECT_EQ(6U, site.requests);
+  EXPECT_EQ("\"1\"", site.sent["If-None-Match"]);
+
+  // a 304 may change the freshness of the response
+  site.header.AddParam("cache-control", "max-age=0", true);
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 9200, site, response));
+  ASSERT_TRUE(cache.Load(key, loaded));
+  EXPECT_EQ(0, loaded.maxAge);
+  EXPECT_EQ(7U, site.requests);
+}
+
+TEST_F(TestScraperCache, Expires)
+{
+  CScraperCache cache(folder);
+  CScraperCache::Response response, loaded;
+  CTestScraperRequest site;
+  std::string url = "http://example.com/movie/2.json";
+  std::string key = CScraperCache::GetKey(url, false, "");
+  site.body = "{}";
+
+  // the expiry is taken relative to the date of the site
+  site.header.AddParam("date", "Sat, 02 Nov 2013 10:00:00 GMT");
+  site.header.AddParam("expires", "Sat, 02 Nov 2013 10:02:00 GMT");
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 1000, site, response));
+  ASSERT_TRUE(cache.Load(key, loaded));
+  EXPECT_EQ(120, loaded.maxAge);
+
+  // and max-age takes precedence over it
+  site.header.AddParam("cache-control", "max-age=30");
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 2000, site, response));
+  ASSERT_TRUE(cache.Load(key, loaded));
+  EXPECT_EQ(30, loaded.maxAge);
+
+  // an invalid date means the response has already expired
+  site.header.Clear();
+  site.header.AddParam("expires", "0");
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 3000, site, response));
+  ASSERT_TRUE(cache.Load(key, loaded));
+  EXPECT_EQ(0, loaded.maxAge);
+
+  site.header.Clear();
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, 4000, site, response));
+  ASSERT_TRUE(cache.Load(key, loaded));
+  EXPECT_EQ(-1, loaded.maxAge);
+}
+
+TEST_F(TestScraperCache, UserRefresh)
+{
+  CScraperCache cache(folder);
+  CScraperCache::Response response;
+  CTestScraperRequest site;
+  std::string url = "http://example.com/show/2.xml";
+  std::string key = CScraperCache::GetKey(url, false, "");
+  time_t now = time(NULL);
+
+  response.url = url;
+  response.data = "<show/>";
+  response.etag = "\"1\"";
+  response.time = now - 10;
+  ASSERT_TRUE(cache.Save(key, response));
+
+  // the responses cached before the user asked for a refresh are revalidated, once
+  cache.Revalidate();
+  site.code = 304;
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, now, site, response));
+  EXPECT_EQ(1U, site.requests);
+  EXPECT_EQ("\"1\"", site.sent["If-None-Match"]);
+  EXPECT_EQ("<show/>", response.data);
+  ASSERT_TRUE(cache.Fetch(key, url, 3600, now, site, response));
+  EXPECT_EQ(1U, site.requests);
+}
@@ -0,0 +1,99 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include "utils/StringUtils.h"
+#include "utils/TrigramIndex.h"
+
+static const char *titles[] = {
+  "pilot",
+  "the one where it all began",
+  "the one with the thumb",
+  "the one with george stephanopoulos",
+  "the one with the east german laundry detergent",
+  "the one with the butt",
+  "the one with the blackout",
+  "the one where underdog gets away",
+  "the one with the monkey",
+  "the one where monica gets a new roommate",
+  "the one with the lesbian wedding",
+  "the last one",
+  "the one after the superbowl",
+  "the one with two parts",
+  "the one with all the poker",
+  "the one where nana dies twice",
+  "the one where the stripper cries",
+  "the one with the candy hearts",
+  "the one with the stoned guy",
+  "the one with the birth",
+};
+
+TEST(TestTrigramIndex, FindCandidates)
+{
+  CTrigramIndex index;
+  for (size_t i = 0; i < sizeof(titles) / sizeof(titles[0]); i++)
+    index.Add(titles[i]);
+
+  std::vector<int> candidates;
+  index.FindCandidates("the one with the monkey", 3, candidates);
+  ASSERT_EQ(3U, candidates.size());
+  EXPECT_EQ(8, candidates[0]);
+
+  index.FindCandidates("xyz", 3, candidates);
+  EXPECT_TRUE(candidates.empty());
+}
+
+TEST(TestTrigramIndex, FindBestMatch)
+{
+  CTrigramIndex index;
+  CStdStringArray strings;
+  for (size_t i = 0; i < sizeof(titles) / sizeof(titles[0]); i++)
+  {
+    index.Add(titles[i]);
+    strings.push_back(titles[i]);
+  }
+
+  // only close matches are sure to be among the candidates
+  const char *queries[] = { "the one with the munkey", "one with all the poker", "the 1 where nana dies twice", "pilot", "the one where monica gets a roomate" };
+  for (size_t i = 0; i < sizeof(queries) / sizeof(queries[0]); i++)
+  {
+    double score, expectedScore;
+    int expected = StringUtils::FindBestMatch(queries[i], strings, expectedScore);
+    EXPECT_EQ(expected, index.FindBestMatch(queries[i], score, 4));
+    EXPECT_DOUBLE_EQ(expectedScore, score);
+  }
+}
+
+TEST(TestTrigramIndex, NoMatch)
+{
+  CTrigramIndex index;
+  double score;
+  EXPECT_EQ(-1, index.FindBestMatch("pilot", score));
+  EXPECT_EQ(0, score);
+
+  for (size_t i = 0; i < sizeof(titles) / sizeof(titles[0]); i++)
+    index.Add(titles[i]);
+  EXPECT_EQ(-1, index.FindBestMatch("qqq", score, 4));
+  EXPECT_EQ(0, score);
+
+  index.Clear();
+  EXPECT_EQ(0U, index.Size());
+}
@@ -58,6 +58,8 @@
 #include "URL.h"
 #include "video/VideoDbUrl.h"
 #include "playlists/SmartPlayList.h"
+#include "playlists/SmartPlaylistCache.h"
+#include "utils/ChangeJournal.h"
 #include "utils/GroupUtils.h"
 #include "Application.h"
 
@@ -67,6 +69,73 @@ using namespace XFILE;
 using namespace VIDEO;
 using namespace ADDON;
 
+// number of ids put in a single IN clause by the batch loaders
+#define VIDEODB_BATCH_SIZE 500
+
+static std::string JoinIds(const vector<int> &ids, size_t start, size_t count)
+{
+  std::string result;
+  for (size_t i = start; i < start + count && i < ids.size(); i++)
+  {
+    if (!result.empty())
+      result += ",";
+    result += StringUtils::Format("%i", ids[i]);
+  }
+  return result;
+}
+
+// links counted in the navcount table for the genre, country and studio nodes
+static const struct NavCountLink
+{
+  const char *nav;
+  const char *link;
+  const char *media;
+  const char *item;
+  const char *idItem;
+} navCountLinks[] = {
+  { "genre",   "genrelinkmovie",       MediaTypeMovie,      "movie",      "idMovie" },
+  { "country", "countrylinkmovie",     MediaTypeMovie,      "movie",      "idMovie" },
+  { "studio",  "studiolinkmovie",      MediaTypeMovie,      "movie",      "idMovie" },
+  { "genre",   "genrelinkmusicvideo",  MediaTypeMusicVideo, "musicvideo", "idMVideo" },
+  { "studio",  "studiolinkmusicvideo", MediaTypeMusicVideo, "musicvideo", "idMVideo" }
+};
+static const char *navCountTypes[] = { "genre", "country", "studio" };
+
+// statements of the trigger adding (or removing) a link to the counters
+static std::string NavCountLinkUpdate(const NavCountLink &link, const char *row, char sign)
+{
+  std::string items = StringUtils::Format("FROM %s JOIN files ON files.idFile = %s.idFile WHERE %s.%s = %s.%s",
+                                          link.item, link.item, link.item, link.idItem, row, link.idItem);
+  return StringUtils::Format("UPDATE navcount SET iCount = iCount %c (SELECT COUNT(1) %s), iWatched = iWatched %c (SELECT COUNT(files.playCount) %s) "
+                             "WHERE idNav = %s.id%s AND nav_type = '%s' AND media_type = '%s'; ",
+                             sign, items.c_str(), sign, items.c_str(), row, link.nav, link.nav, link.media);
+}
+
+// statements of the trigger removing a deleted item from the counters of the links it still has
+static std::string NavCountItemDelete(const char *media)
+{
+  std::string sql;
+  for (size_t i = 0; i < sizeof(navCountLinks) / sizeof(navCountLinks[0]); i++)
+  {
+    const NavCountLink &link = navCountLinks[i];
+    if (strcmp(link.media, media) != 0)
+      continue;
+    sql += StringUtils::Format("UPDATE navcount SET iCount = iCount - (SELECT COUNT(1) FROM files WHERE idFile = old.idFile), "
+                               "iWatched = iWatched - (SELECT COUNT(playCount) FROM files WHERE idFile = old.idFile) "
+                               "WHERE nav_type = '%s' AND media_type = '%s' AND idNav IN (SELECT id%s FROM %s WHERE %s = old.%s); ",
+                               link.nav, link.media, link.nav, link.link, link.idItem, link.idItem);
+  }
+  return sql;
+}
+
+// the items of a link, correlated to the genre, country or studio table
+static std::string NavCountItems(const NavCountLink &link)
+{
+  return StringUtils::Format("FROM %s JOIN %s ON %s.%s = %s.%s JOIN files ON files.idFile = %s.idFile WHERE %s.id%s = %s.id%s",
+                             link.link, link.item, link.item, link.idItem, link.link, link.idItem, link.item,
+                             link.link, link.nav, link.nav, link.nav);
+}
+
 //********************************************************************************************************************************
 CVideoDatabase::CVideoDatabase(void)
 {
@@ -233,6 +302,15 @@ void CVideoDatabase::CreateTables()
 
   CLog::Log(LOGINFO, "create taglinks table");
   m_pDS->exec("CREATE TABLE taglinks (idTag integer, idMedia integer, media_type TEXT)");
+
+  CLog::Log(LOGINFO, "create smartplaylist table");
+  m_pDS->exec("CREATE TABLE smartplaylist (idPlaylist integer primary key, strHash text, media_type TEXT)");
+
+  CLog::Log(LOGINFO, "create smartplaylistlink table");
+  m_pDS->exec("CREATE TABLE smartplaylistlink (idPlaylist integer, idMedia integer)");
+
+  CLog::Log(LOGINFO, "create navcount table");
+  m_pDS->exec("CREATE TABLE navcount (idNav integer, nav_type TEXT, media_type TEXT, iCount integer, iWatched integer)");
 }
 
 void CVideoDatabase::CreateAnalytics()
@@ -323,19 +401,25 @@ void CVideoDatabase::CreateAnalytics()
   m_pDS->exec("CREATE UNIQUE INDEX ix_taglinks_2 ON taglinks (idMedia, media_type(20), idTag)");
   m_pDS->exec("CREATE INDEX ix_taglinks_3 ON taglinks (media_type(20))");
 
+  m_pDS->exec("CREATE INDEX ix_smartplaylistlink ON smartplaylistlink (idPlaylist, idMedia)");
+
+  m_pDS->exec("CREATE UNIQUE INDEX ix_navcount ON navcount (nav_type(20), media_type(20), idNav)");
+
   CLog::Log(LOGINFO, "%s - creating triggers", __FUNCTION__);
-  m_pDS->exec("CREATE TRIGGER delete_movie AFTER DELETE ON movie FOR EACH ROW BEGIN "
-              "DELETE FROM art WHERE media_id=old.idMovie AND media_type='movie'; "
-              "DELETE FROM taglinks WHERE idMedia=old.idMovie AND media_type='movie'; "
-              "END");
+  m_pDS->exec(("CREATE TRIGGER delete_movie AFTER DELETE ON movie FOR EACH ROW BEGIN "
+               "DELETE FROM art WHERE media_id=old.idMovie AND media_type='movie'; "
+               "DELETE FROM taglinks WHERE idMedia=old.idMovie AND media_type='movie'; " +
+               NavCountItemDelete(MediaTypeMovie) +
+               "END").c_str());
   m_pDS->exec("CREATE TRIGGER delete_tvshow AFTER DELETE ON tvshow FOR EACH ROW BEGIN "
               "DELETE FROM art WHERE media_id=old.idShow AND media_type='tvshow'; "
               "DELETE FROM taglinks WHERE idMedia=old.idShow AND media_type='tvshow'; "
               "END");
-  m_pDS->exec("CREATE TRIGGER delete_musicvideo AFTER DELETE ON musicvideo FOR EACH ROW BEGIN "
-              "DELETE FROM art WHERE media_id=old.idMVideo AND media_type='musicvideo'; "
-              "DELETE FROM taglinks WHERE idMedia=old.idMVideo AND media_type='musicvideo'; "
-              "END");
+  m_pDS->exec(("CREATE TRIGGER delete_musicvideo AFTER DELETE ON musicvideo FOR EACH ROW BEGIN "
+               "DELETE FROM art WHERE media_id=old.idMVideo AND media_type='musicvideo'; "
+               "DELETE FROM taglinks WHERE idMedia=old.idMVideo AND media_type='musicvideo'; " +
+               NavCountItemDelete(MediaTypeMusicVideo) +
+               "END").c_str());
   m_pDS->exec("CREATE TRIGGER delete_episode AFTER DELETE ON episode FOR EACH ROW BEGIN "
               "DELETE FROM art WHERE media_id=old.idEpisode AND media_type='episode'; "
               "END");
@@ -352,6 +436,42 @@ void CVideoDatabase::CreateAnalytics()
               "DELETE FROM tag WHERE idTag=old.idTag AND idTag NOT IN (SELECT DISTINCT idTag FROM taglinks); "
               "END");
 
+  // keep the counters of the genre, country and studio nodes
+  std::string watched, removed;
+  for (size_t i = 0; i < sizeof(navCountLinks) / sizeof(navCountLinks[0]); i++)
+  {
+    const NavCountLink &link = navCountLinks[i];
+    m_pDS->exec(StringUtils::Format("CREATE TRIGGER navcount_insert_%s AFTER INSERT ON %s FOR EACH ROW BEGIN %sEND",
+                                    link.link, link.link, NavCountLinkUpdate(link, "new", '+').c_str()).c_str());
+    m_pDS->exec(StringUtils::Format("CREATE TRIGGER navcount_delete_%s AFTER DELETE ON %s FOR EACH ROW BEGIN %sEND",
+                                    link.link, link.link, NavCountLinkUpdate(link, "old", '-').c_str()).c_str());
+    watched += StringUtils::Format("UPDATE navcount SET iWatched = iWatched + (CASE WHEN new.playCount IS NULL THEN 0 ELSE 1 END) - (CASE WHEN old.playCount IS NULL THEN 0 ELSE 1 END) "
+                                   "WHERE nav_type = '%s' AND media_type = '%s' AND idNav IN (SELECT %s.id%s FROM %s JOIN %s ON %s.%s = %s.%s WHERE %s.idFile = new.idFile); ",
+                                   link.nav, link.media, link.link, link.nav, link.link, link.item, link.item, link.idItem, link.link, link.idItem, link.item);
+    // the cleanup deletes files before their items, which then no longer count
+    removed += StringUtils::Format("UPDATE navcount SET iCount = iCount - 1, iWatched = iWatched - (CASE WHEN old.playCount IS NULL THEN 0 ELSE 1 END) "
+                                   "WHERE nav_type = '%s' AND media_type = '%s' AND idNav IN (SELECT %s.id%s FROM %s JOIN %s ON %s.%s = %s.%s WHERE %s.idFile = old.idFile); ",
+                                   link.nav, link.media, link.link, link.nav, link.link, link.item, link.item, link.idItem, link.link, link.idItem, link.item);
+  }
+  m_pDS->exec(("CREATE TRIGGER navcount_update_files AFTER UPDATE ON files FOR EACH ROW BEGIN " + watched + "END").c_str());
+  m_pDS->exec(("CREATE TRIGGER navcount_delete_files AFTER DELETE ON files FOR EACH ROW BEGIN " + removed + "END").c_str());
+
+  for (size_t i = 0; i < sizeof(navCountTypes) / sizeof(navCountTypes[0]); i++)
+  {
+    std::string counters;
+    for (size_t j = 0; j < sizeof(navCountLinks) / sizeof(navCountLinks[0]); j++)
+    {
+      if (strcmp(navCountLinks[j].nav, navCountTypes[i]) == 0)
+        counters += StringUtils::Format("INSERT INTO navcount (idNav, nav_type, media_type, iCount, iWatched) VALUES (new.id%s, '%s', '%s', 0, 0); ",
+                                        navCountTypes[i], navCountTypes[i], navCountLinks[j].media);
+    }
+    m_pDS->exec(StringUtils::Format("CREATE TRIGGER navcount_insert_%s AFTER INSERT ON %s FOR EACH ROW BEGIN %sEND",
+                                    navCountTypes[i], navCountTypes[i], counters.c_str()).c_str());
+    m_pDS->exec(StringUtils::Format("CREATE TRIGGER navcount_delete_%s AFTER DELETE ON %s FOR EACH ROW BEGIN "
+                                    "DELETE FROM navcount WHERE idNav = old.id%s AND nav_type = '%s'; END",
+                                    navCountTypes[i], navCountTypes[i], navCountTypes[i], navCountTypes[i]).c_str());
+  }
+
   CreateViews();
 }
 
@@ -825,6 +945,10 @@ bool CVideoDatabase::SetPathHash(const CStdString &path, const CStdString &hash)
     CStdString strSQL=PrepareSQL("update path set strHash='%s' where idPath=%ld", hash.c_str(), idPath);
     m_pDS->exec(strSQL.c_str());
 
+    // an empty hash forces the folder to be scanned again
+    if (hash.empty())
+      CChangeJournal::Get().MarkChanged(path);
+
     return true;
   }
   catch (...)
@@ -3329,6 +3453,46 @@ bool CVideoDatabase::GetStreamDetails(CFileItem& item)
   return GetStreamDetails(*item.GetVideoInfoTag());
 }
 
+bool CVideoDatabase::ReadStreamDetail(Dataset *pDS, CStreamDetails &details)
+{
+  CStreamDetail::StreamType e = (CStreamDetail::StreamType)pDS->fv(1).get_asInt();
+  switch (e)
+  {
+  case CStreamDetail::VIDEO:
+    {
+      CStreamDetailVideo *p = new CStreamDetailVideo();
+      p->m_strCodec = pDS->fv(2).get_asString();
+      p->m_fAspect = pDS->fv(3).get_asFloat();
+      p->m_iWidth = pDS->fv(4).get_asInt();
+      p->m_iHeight = pDS->fv(5).get_asInt();
+      p->m_iDuration = pDS->fv(10).get_asInt();
+      p->m_strStereoMode = pDS->fv(11).get_asString();
+      details.AddStream(p);
+      return true;
+    }
+  case CStreamDetail::AUDIO:
+    {
+      CStreamDetailAudio *p = new CStreamDetailAudio();
+      p->m_strCodec = pDS->fv(6).get_asString();
+      if (pDS->fv(7).get_isNull())
+        p->m_iChannels = -1;
+      else
+        p->m_iChannels = pDS->fv(7).get_asInt();
+      p->m_strLanguage = pDS->fv(8).get_asString();
+      details.AddStream(p);
+      return true;
+    }
+  case CStreamDetail::SUBTITLE:
+    {
+      CStreamDetailSubtitle *p = new CStreamDetailSubtitle();
+      p->m_strLanguage = pDS->fv(9).get_asString();
+      details.AddStream(p);
+      return true;
+    }
+  }
+  return false;
+}
+
 bool CVideoDatabase::GetStreamDetails(CVideoInfoTag& tag) const
 {
   if (tag.m_iFileId < 0)
@@ -3347,45 +3511,8 @@ bool CVideoDatabase::GetStreamDetails(CVideoInfoTag& tag) const
 
     while (!pDS->eof())
     {
-      CStreamDetail::StreamType e = (CStreamDetail::StreamType)pDS->fv(1).get_asInt();
-      switch (e)
-      {
-      case CStreamDetail::VIDEO:
-        {
-          CStreamDetailVideo *p = new CStreamDetailVideo();
-          p->m_strCodec = pDS->fv(2).get_asString();
-          p->m_fAspect = pDS->fv(3).get_asFloat();
-          p->m_iWidth = pDS->fv(4).get_asInt();
-          p->m_iHeight = pDS->fv(5).get_asInt();
-          p->m_iDuration = pDS->fv(10).get_asInt();
-          p->m_strStereoMode = pDS->fv(11).get_asString();
-          details.AddStream(p);
-          retVal = true;
-          break;
-        }
-      case CStreamDetail::AUDIO:
-        {
-          CStreamDetailAudio *p = new CStreamDetailAudio();
-          p->m_strCodec = pDS->fv(6).get_asString();
-          if (pDS->fv(7).get_isNull())
-            p->m_iChannels = -1;
-          else
-            p->m_iChannels = pDS->fv(7).get_asInt();
-          p->m_strLanguage = pDS->fv(8).get_asString();
-          details.AddStream(p);
-          retVal = true;
-          break;
-        }
-      case CStreamDetail::SUBTITLE:
-        {
-          CStreamDetailSubtitle *p = new CStreamDetailSubtitle();
-          p->m_strLanguage = pDS->fv(9).get_asString();
-          details.AddStream(p);
-          retVal = true;
-          break;
-        }
-      }
-
+      if (ReadStreamDetail(pDS.get(), details))
+        retVal = true;
       pDS->next();
     }
 
@@ -3402,6 +3529,62 @@ bool CVideoDatabase::GetStreamDetails(CVideoInfoTag& tag) const
 
   return retVal;
 }
+
+bool CVideoDatabase::GetStreamDetailsForItems(CFileItemList &items)
+{
+  // several items may share a file
+  map<int, vector<CVideoInfoTag*> > tags;
+  vector<int> fileIds;
+  for (int i = 0; i < items.Size(); i++)
+  {
+    if (!items[i]->HasVideoInfoTag() || items[i]->GetVideoInfoTag()->m_iFileId < 0)
+      continue;
+    CVideoInfoTag *tag = items[i]->GetVideoInfoTag();
+    tag->m_streamDetails.Reset();
+    vector<CVideoInfoTag*> &fileTags = tags[tag->m_iFileId];
+    if (fileTags.empty())
+      fileIds.push_back(tag->m_iFileId);
+    fileTags.push_back(tag);
+  }
+  if (fileIds.empty())
+    return true;
+
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    auto_ptr<Dataset> pDS(m_pDB->CreateDataset());
+
+    for (size_t start = 0; start < fileIds.size(); start += VIDEODB_BATCH_SIZE)
+    {
+      CStdString strSQL = PrepareSQL("SELECT * FROM streamdetails WHERE idFile IN (%s)", JoinIds(fileIds, start, VIDEODB_BATCH_SIZE).c_str());
+      pDS->query(strSQL);
+      while (!pDS->eof())
+      {
+        const vector<CVideoInfoTag*> &fileTags = tags[pDS->fv(0).get_asInt()];
+        for (vector<CVideoInfoTag*>::const_iterator tag = fileTags.begin(); tag != fileTags.end(); ++tag)
+          ReadStreamDetail(pDS.get(), (*tag)->m_streamDetails);
+        pDS->next();
+      }
+      pDS->close();
+    }
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed for %u files", __FUNCTION__, (unsigned int)fileIds.size());
+    return false;
+  }
+
+  for (map<int, vector<CVideoInfoTag*> >::iterator it = tags.begin(); it != tags.end(); ++it)
+  {
+    for (vector<CVideoInfoTag*>::iterator tag = it->second.begin(); tag != it->second.end(); ++tag)
+    {
+      (*tag)->m_streamDetails.DetermineBestStreams();
+      if ((*tag)->m_streamDetails.GetVideoDuration() > 0)
+        (*tag)->m_duration = (*tag)->m_streamDetails.GetVideoDuration();
+    }
+  }
+  return true;
+}
  
 bool CVideoDatabase::GetResumePoint(CVideoInfoTag& tag)
 {
@@ -3713,25 +3896,7 @@ void CVideoDatabase::GetCast(const CStdString &table, const CStdString &table_id
     m_pDS2->query(sql.c_str());
     while (!m_pDS2->eof())
     {
-      SActorInfo info;
-      info.strName = m_pDS2->fv(0).get_asString();
-      bool found = false;
-      for (vector<SActorInfo>::iterator i = cast.begin(); i != cast.end(); ++i)
-      {
-        if (i->strName == info.strName)
-        {
-          found = true;
-          break;
-        }
-      }
-      if (!found)
-      {
-        info.strRole = m_pDS2->fv(1).get_asString();
-        info.order = m_pDS2->fv(2).get_asInt();
-        info.thumbUrl.ParseString(m_pDS2->fv(3).get_asString());
-        info.thumb = m_pDS2->fv(4).get_asString();
-        cast.push_back(info);
-      }
+      AddActor(m_pDS2.get(), 0, cast);
       m_pDS2->next();
     }
     m_pDS2->close();
@@ -3742,6 +3907,120 @@ void CVideoDatabase::GetCast(const CStdString &table, const CStdString &table_id
   }
 }
 
+void CVideoDatabase::AddActor(Dataset *pDS, int column, vector<SActorInfo> &cast)
+{
+  SActorInfo info;
+  info.strName = pDS->fv(column).get_asString();
+  for (vector<SActorInfo>::const_iterator i = cast.begin(); i != cast.end(); ++i)
+  {
+    if (i->strName == info.strName)
+      return;
+  }
+  info.strRole = pDS->fv(column + 1).get_asString();
+  info.order = pDS->fv(column + 2).get_asInt();
+  info.thumbUrl.ParseString(pDS->fv(column + 3).get_asString());
+  info.thumb = pDS->fv(column + 4).get_asString();
+  cast.push_back(info);
+}
+
+bool CVideoDatabase::GetCastForIds(const CStdString &table, const CStdString &table_id, const vector<int> &ids, map<int, vector<SActorInfo> > &cast)
+{
+  try
+  {
+    if (!m_pDB.get()) return false;
+    if (!m_pDS2.get()) return false;
+
+    for (size_t start = 0; start < ids.size(); start += VIDEODB_BATCH_SIZE)
+    {
+      CStdString sql = PrepareSQL("SELECT actorlink%s.%s,"
+                                  "  actors.strActor,"
+                                  "  actorlink%s.strRole,"
+                                  "  actorlink%s.iOrder,"
+                                  "  actors.strThumb,"
+                                  "  art.url "
+                                  "FROM actorlink%s"
+                                  "  JOIN actors ON"
+                                  "    actorlink%s.idActor=actors.idActor"
+                                  "  LEFT JOIN art ON"
+                                  "    art.media_id=actors.idActor AND art.media_type='actor' AND art.type='thumb' "
+                                  "WHERE actorlink%s.%s IN (%s) "
+                                  "ORDER BY actorlink%s.%s, actorlink%s.iOrder",
+                                  table.c_str(), table_id.c_str(), table.c_str(), table.c_str(), table.c_str(), table.c_str(),
+                                  table.c_str(), table_id.c_str(), JoinIds(ids, start, VIDEODB_BATCH_SIZE).c_str(),
+                                  table.c_str(), table_id.c_str(), table.c_str());
+      m_pDS2->query(sql.c_str());
+      while (!m_pDS2->eof())
+      {
+        AddActor(m_pDS2.get(), 1, cast[m_pDS2->fv(0).get_asInt()]);
+        m_pDS2->next();
+      }
+      m_pDS2->close();
+    }
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s(%s,%s) failed for %u items", __FUNCTION__, table.c_str(), table_id.c_str(), (unsigned int)ids.size());
+  }
+  return false;
+}
+
+bool CVideoDatabase::GetCastForItems(CFileItemList &items)
+{
+  vector<int> movies, shows, episodes;
+  set<int> showIds;
+  for (int i = 0; i < items.Size(); i++)
+  {
+    if (!items[i]->HasVideoInfoTag() || items[i]->GetVideoInfoTag()->m_iDbId < 0)
+      continue;
+    const CVideoInfoTag *tag = items[i]->GetVideoInfoTag();
+    if (tag->m_type == MediaTypeMovie)
+      movies.push_back(tag->m_iDbId);
+    else if (tag->m_type == MediaTypeTvShow && showIds.insert(tag->m_iDbId).second)
+      shows.push_back(tag->m_iDbId);
+    else if (tag->m_type == MediaTypeEpisode)
+    {
+      episodes.push_back(tag->m_iDbId);
+      // episodes also get the cast of their show
+      if (tag->m_iIdShow >= 0 && showIds.insert(tag->m_iIdShow).second)
+        shows.push_back(tag->m_iIdShow);
+    }
+  }
+
+  map<int, vector<SActorInfo> > movieCast, showCast, episodeCast;
+  if (!movies.empty() && !GetCastForIds("movie", "idMovie", movies, movieCast))
+    return false;
+  if (!shows.empty() && !GetCastForIds("tvshow", "idShow", shows, showCast))
+    return false;
+  if (!episodes.empty() && !GetCastForIds("episode", "idEpisode", episodes, episodeCast))
+    return false;
+
+  for (int i = 0; i < items.Size(); i++)
+  {
+    if (!items[i]->HasVideoInfoTag() || items[i]->GetVideoInfoTag()->m_iDbId < 0)
+      continue;
+    CVideoInfoTag *tag = items[i]->GetVideoInfoTag();
+    if (tag->m_type == MediaTypeMovie)
+      tag->m_cast = movieCast[tag->m_iDbId];
+    else if (tag->m_type == MediaTypeTvShow)
+      tag->m_cast = showCast[tag->m_iDbId];
+    else if (tag->m_type == MediaTypeEpisode)
+    {
+      tag->m_cast = episodeCast[tag->m_iDbId];
+      const vector<SActorInfo> &cast = showCast[tag->m_iIdShow];
+      for (vector<SActorInfo>::const_iterator actor = cast.begin(); actor != cast.end(); ++actor)
+      {
+        bool found = false;
+        for (vector<SActorInfo>::const_iterator i = tag->m_cast.begin(); i != tag->m_cast.end() && !found; ++i)
+          found = i->strName == actor->strName;
+        if (!found)
+          tag->m_cast.push_back(*actor);
+      }
+    }
+  }
+  return true;
+}
+
 /// \brief GetVideoSettings() obtains any saved video settings for the current file.
 /// \retval Returns true if the settings exist, false otherwise.
 bool CVideoDatabase::GetVideoSettings(const CStdString &strFilenameAndPath, CVideoSettings &settings)
@@ -3927,6 +4206,33 @@ bool CVideoDatabase::GetArtForItem(int mediaId, const MediaType &mediaType, map<
   return false;
 }
 
+bool CVideoDatabase::GetArtForItems(const MediaType &mediaType, const vector<int> &mediaIds, map<int, map<string, string> > &art)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS2.get()) return false; // using dataset 2 as we're likely called in loops on dataset 1
+
+    for (size_t start = 0; start < mediaIds.size(); start += VIDEODB_BATCH_SIZE)
+    {
+      CStdString sql = PrepareSQL("SELECT media_id,type,url FROM art WHERE media_type='%s' AND media_id IN (%s)", mediaType.c_str(), JoinIds(mediaIds, start, VIDEODB_BATCH_SIZE).c_str());
+      m_pDS2->query(sql.c_str());
+      while (!m_pDS2->eof())
+      {
+        art[m_pDS2->fv(0).get_asInt()].insert(make_pair(m_pDS2->fv(1).get_asString(), m_pDS2->fv(2).get_asString()));
+        m_pDS2->next();
+      }
+      m_pDS2->close();
+    }
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s(%s) failed for %u items", __FUNCTION__, mediaType.c_str(), (unsigned int)mediaIds.size());
+  }
+  return false;
+}
+
 string CVideoDatabase::GetArtForItem(int mediaId, const MediaType &mediaType, const string &artType)
 {
   std::string query = PrepareSQL("SELECT url FROM art WHERE media_id=%i AND media_type='%s' AND type='%s'", mediaId, mediaType.c_str(), artType.c_str());
@@ -4088,6 +4394,8 @@ void CVideoDatabase::RemoveContentForPath(const CStdString& strPath, CGUIDialogP
     if (NULL == m_pDB.get()) return ;
     if (NULL == m_pDS.get()) return ;
 
+    CChangeJournal::Get().MarkChanged(strPath);
+
     if (progress)
     {
       progress->SetHeading(700);
@@ -4173,6 +4481,8 @@ void CVideoDatabase::SetScraperForPath(const CStdString& filePath, const Scraper
     if (idPath < 0)
       return;
 
+    CChangeJournal::Get().MarkChanged(filePath);
+
     // Update
     CStdString strSQL;
     if (settings.exclude)
@@ -4393,11 +4703,72 @@ void CVideoDatabase::UpdateTables(int iVersion)
   }
   if (iVersion < 77)
     m_pDS->exec("ALTER TABLE streamdetails ADD strStereoMode text");
+  if (iVersion < 80)
+  {
+    m_pDS->exec("CREATE TABLE smartplaylist (idPlaylist integer primary key, strHash text, media_type TEXT)");
+    m_pDS->exec("CREATE TABLE smartplaylistlink (idPlaylist integer, idMedia integer)");
+  }
+  if (iVersion < 81)
+  {
+    m_pDS->exec("CREATE TABLE navcount (idNav integer, nav_type TEXT, media_type TEXT, iCount integer, iWatched integer)");
+    RebuildNavCounts();
+  }
+  else if (iVersion < 82)
+  {
+    // counters of items whose files were cleaned up before them
+    RebuildNavCounts();
+  }
 }
 
 int CVideoDatabase::GetSchemaVersion() const
 {
-  return 79;
+  return 82;
+}
+
+void CVideoDatabase::RebuildNavCounts()
+{
+  m_pDS->exec("DELETE FROM navcount");
+  for (size_t i = 0; i < sizeof(navCountLinks) / sizeof(navCountLinks[0]); i++)
+  {
+    const NavCountLink &link = navCountLinks[i];
+    std::string items = NavCountItems(link);
+    m_pDS->exec(StringUtils::Format("INSERT INTO navcount (idNav, nav_type, media_type, iCount, iWatched) "
+                                    "SELECT %s.id%s, '%s', '%s', (SELECT COUNT(1) %s), (SELECT COUNT(files.playCount) %s) FROM %s",
+                                    link.nav, link.nav, link.nav, link.media, items.c_str(), items.c_str(), link.nav).c_str());
+  }
+}
+
+bool CVideoDatabase::CheckNavCounts()
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    int differences = 0;
+    for (size_t i = 0; i < sizeof(navCountLinks) / sizeof(navCountLinks[0]); i++)
+    {
+      const NavCountLink &link = navCountLinks[i];
+      std::string items = NavCountItems(link);
+      std::string sql = StringUtils::Format("SELECT COUNT(1) FROM %s LEFT JOIN navcount ON navcount.idNav = %s.id%s AND navcount.nav_type = '%s' AND navcount.media_type = '%s' "
+                                            "WHERE navcount.idNav IS NULL OR navcount.iCount <> (SELECT COUNT(1) %s) OR navcount.iWatched <> (SELECT COUNT(files.playCount) %s)",
+                                            link.nav, link.nav, link.nav, link.nav, link.media, items.c_str(), items.c_str());
+      differences += (int)strtol(GetSingleValue(sql, m_pDS).c_str(), NULL, 10);
+    }
+    if (differences == 0)
+      return true;
+
+    CLog::Log(LOGWARNING, "%s - %i navigation counters are off, rebuilding them", __FUNCTION__, differences);
+    BeginTransaction();
+    RebuildNavCounts();
+    CommitTransaction();
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+    RollbackTransaction();
+  }
+  return false;
 }
 
 bool CVideoDatabase::LookupByFolders(const CStdString &path, bool shows)
@@ -4743,7 +5114,24 @@ bool CVideoDatabase::GetNavCommon(const CStdString& strBaseDir, CFileItemList& i
     }
     else
     {
-      if (idContent == VIDEODB_CONTENT_MOVIES)
+      // without further filters the counts are taken from the navcount table
+      CVideoDbUrl url;
+      Filter urlFilter;
+      SortDescription sorting;
+      bool counted = (idContent == VIDEODB_CONTENT_MOVIES || idContent == VIDEODB_CONTENT_MUSICVIDEOS) &&
+                     filter.where.empty() && filter.join.empty() &&
+                     url.FromString(strBaseDir) && GetFilter(url, urlFilter, sorting) &&
+                     urlFilter.where.empty() && urlFilter.join.empty();
+
+      if (counted)
+      {
+        strSQL = "select %s " + PrepareSQL("from %s ", type.c_str());
+        extFilter.fields = PrepareSQL("%s.id%s, %s.str%s, navcount.iCount, navcount.iWatched", type.c_str(), type.c_str(), type.c_str(), type.c_str());
+        extFilter.AppendJoin(PrepareSQL("join navcount on navcount.idNav = %s.id%s and navcount.nav_type = '%s' and navcount.media_type = '%s'",
+                                        type.c_str(), type.c_str(), type.c_str(), idContent == VIDEODB_CONTENT_MOVIES ? MediaTypeMovie : MediaTypeMusicVideo));
+        extFilter.AppendWhere("navcount.iCount > 0");
+      }
+      else if (idContent == VIDEODB_CONTENT_MOVIES)
       {
         strSQL = "select %s " + PrepareSQL("from %s ", type.c_str());
         extFilter.fields = PrepareSQL("%s.id%s, %s.str%s, count(1), count(files.playCount)", type.c_str(), type.c_str(), type.c_str(), type.c_str());
@@ -9666,7 +10054,11 @@ bool CVideoDatabase::GetFilter(CDbUrl &videoUrl, Filter &filter, SortDescription
        (xsp.GetType() == "episodes" && itemType == "tvshows"))
     {
       std::set<CStdString> playlists;
-      filter.AppendWhere(xsp.GetWhereClause(*this, playlists));
+      CStdString where = xsp.GetWhereClause(*this, playlists);
+      // a shared database may be changed by others without us being told
+      if (xsp.GetType() == itemType && m_sqlite && g_advancedSettings.m_smartPlaylistCache)
+        where = CSmartPlaylistCache::Get().GetWhereClause(*this, std::string(m_pDB->getHostName()) + m_pDB->getDatabase(), MediaTypes::FromString(itemType), where);
+      filter.AppendWhere(where);
 
       if (xsp.GetLimit() > 0)
         sorting.limitEnd = xsp.GetLimit();
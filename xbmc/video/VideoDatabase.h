@@ -513,6 +513,20 @@ public:
   bool GetStreamDetails(CFileItem& item);
   bool GetStreamDetails(CVideoInfoTag& tag) const;
 
+  /*! \brief Fetch the stream details of a list of items in one go.
+   Items are matched by the file id of their video info tag, items without one are skipped.
+   \param items the items to fetch the stream details for.
+   \return true on success, false otherwise.
+   */
+  bool GetStreamDetailsForItems(CFileItemList &items);
+
+  /*! \brief Fetch the cast of a list of movies, tvshows and episodes in one go.
+   Episodes get the cast of their tvshow as well, like in GetEpisodeInfo().
+   \param items the items to fetch the cast for.
+   \return true on success, false otherwise.
+   */
+  bool GetCastForItems(CFileItemList &items);
+
   // scraper settings
   void SetScraperForPath(const CStdString& filePath, const ADDON::ScraperPtr& info, const VIDEO::SScanSettings& settings);
   ADDON::ScraperPtr GetScraperForPath(const CStdString& strPath);
@@ -632,6 +646,12 @@ public:
 
   void CleanDatabase(CGUIDialogProgressBarHandle* handle=NULL, const std::set<int>* paths=NULL, bool showProgress=true);
 
+  /*! \brief Check the counters of the genre, country and studio nodes against the library
+   The counters are kept up to date by triggers. They're rebuilt if any of them is off.
+   \return true if the counters were up to date, false otherwise.
+   */
+  bool CheckNavCounts();
+
   /*! \brief Add a file to the database, if necessary
    If the file is already in the database, we simply return its id.
    \param url - full path of the file to add.
@@ -714,6 +734,14 @@ public:
   void SetArtForItem(int mediaId, const MediaType &mediaType, const std::string &artType, const std::string &url);
   void SetArtForItem(int mediaId, const MediaType &mediaType, const std::map<std::string, std::string> &art);
   bool GetArtForItem(int mediaId, const MediaType &mediaType, std::map<std::string, std::string> &art);
+
+  /*! \brief Fetch the art of several items of the same media type in one go.
+   \param mediaType the media type of the items.
+   \param mediaIds the database ids of the items.
+   \param art [out] the art by database id, items without art have no entry.
+   \return true on success, false otherwise.
+   */
+  bool GetArtForItems(const MediaType &mediaType, const std::vector<int> &mediaIds, std::map<int, std::map<std::string, std::string> > &art);
   std::string GetArtForItem(int mediaId, const MediaType &mediaType, const std::string &artType);
   bool RemoveArtForItem(int mediaId, const MediaType &mediaType, const std::string &artType);
   bool RemoveArtForItem(int mediaId, const MediaType &mediaType, const std::set<std::string> &artTypes);
@@ -799,16 +827,25 @@ protected:
   bool GetPeopleNav(const CStdString& strBaseDir, CFileItemList& items, const CStdString& type, int idContent=-1, const Filter &filter = Filter(), bool countOnly = false);
   bool GetNavCommon(const CStdString& strBaseDir, CFileItemList& items, const CStdString& type, int idContent=-1, const Filter &filter = Filter(), bool countOnly = false);
   void GetCast(const CStdString &table, const CStdString &table_id, int type_id, std::vector<SActorInfo> &cast);
+  bool GetCastForIds(const CStdString &table, const CStdString &table_id, const std::vector<int> &ids, std::map<int, std::vector<SActorInfo> > &cast);
+  static void AddActor(dbiplus::Dataset *pDS, int column, std::vector<SActorInfo> &cast);
+  static bool ReadStreamDetail(dbiplus::Dataset *pDS, CStreamDetails &details);
 
   void GetDetailsFromDB(std::auto_ptr<dbiplus::Dataset> &pDS, int min, int max, const SDbTableOffsets *offsets, CVideoInfoTag &details, int idxOffset = 2);
   void GetDetailsFromDB(const dbiplus::sql_record* const record, int min, int max, const SDbTableOffsets *offsets, CVideoInfoTag &details, int idxOffset = 2);
   CStdString GetValueString(const CVideoInfoTag &details, int min, int max, const SDbTableOffsets *offsets) const;
 
+  virtual int GetSchemaVersion() const;
+
 private:
   virtual void CreateTables();
   virtual void CreateAnalytics();
   virtual void UpdateTables(int version);
 
+  /*! \brief Fill the navcount table from the link tables
+   */
+  void RebuildNavCounts();
+
   /*! \brief (Re)Create the generic database views for movies, tvshows,
      episodes and music videos
    */
@@ -828,9 +865,9 @@ private:
   bool LookupByFolders(const CStdString &path, bool shows = false);
 
   virtual int GetMinSchemaVersion() const { return 60; };
-  virtual int GetSchemaVersion() const;
   virtual int GetExportVersion() const { return 1; };
   const char *GetBaseDBName() const { return "MyVideos"; };
+  bool ReportsChanges() const { return true; };
 
   void ConstructPath(CStdString& strDest, const CStdString& strPath, const CStdString& strFileName);
   void SplitPath(const CStdString& strFileNameAndPath, CStdString& strPath, CStdString& strFileName);
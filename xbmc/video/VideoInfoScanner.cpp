@@ -26,7 +26,9 @@
 #include "Util.h"
 #include "NfoFile.h"
 #include "utils/RegExp.h"
+#include "utils/RegExpCache.h"
 #include "utils/md5.h"
+#include "utils/ChangeJournal.h"
 #include "filesystem/StackDirectory.h"
 #include "VideoInfoDownloader.h"
 #include "GUIInfoManager.h"
@@ -42,6 +44,7 @@
 #include "guilib/LocalizeStrings.h"
 #include "guilib/GUIWindowManager.h"
 #include "utils/TimeUtils.h"
+#include "utils/TrigramIndex.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
@@ -68,6 +71,7 @@ namespace VIDEO
     m_itemCount = 0;
     m_bClean = false;
     m_scanAll = false;
+    m_changedDirs = 0;
   }
 
   CVideoInfoScanner::~CVideoInfoScanner()
@@ -106,6 +110,17 @@ namespace VIDEO
       // result in unexpected behaviour.
       m_bCanInterrupt = false;
 
+      // local sources are watched, so that unchanged folders can be skipped on later scans
+      if (g_advancedSettings.m_changeJournal)
+      {
+        for (set<CStdString>::const_iterator it = m_pathsToScan.begin(); it != m_pathsToScan.end(); ++it)
+          CChangeJournal::Get().Watch(*it);
+      }
+
+      // list the folders of the next paths while the current one is scanned
+      if (g_advancedSettings.m_iVideoScannerPrefetchJobs > 0)
+        m_prefetcher.Start(m_pathsToScan, m_scanAll, g_advancedSettings.m_iVideoScannerPrefetchJobs, m_journalCursors);
+
       bool bCancelled = false;
       while (!bCancelled && m_pathsToScan.size())
       {
@@ -130,6 +145,8 @@ namespace VIDEO
           bCancelled = true;
       }
 
+      m_prefetcher.Stop();
+
       if (!bCancelled)
       {
         if (m_bClean)
@@ -151,6 +168,7 @@ namespace VIDEO
     {
       CLog::Log(LOGERROR, "VideoInfoScanner: Exception while scanning.");
     }
+    m_prefetcher.Stop();
     
     m_bRunning = false;
     ANNOUNCEMENT::CAnnouncementManager::Get().Announce(ANNOUNCEMENT::VideoLibrary, "xbmc", "OnScanFinished");
@@ -255,6 +273,18 @@ namespace VIDEO
     if (content == CONTENT_NONE || ignoreFolder)
       return true;
 
+    // a folder found unchanged on its last scan is skipped with its subfolders if nothing changed below it since
+    unsigned int cursor = CChangeJournal::Get().GetCursor();
+    map<CStdString, unsigned int>::const_iterator scanned = m_journalCursors.find(strDirectory);
+    if (scanned != m_journalCursors.end() && !CChangeJournal::Get().HasChanged(strDirectory, scanned->second))
+    {
+      CLog::Log(LOGDEBUG, "VideoInfoScanner: Skipping dir '%s' due to no change (journal)", CURL::GetRedacted(strDirectory).c_str());
+      if (m_handle)
+        OnDirectoryScanned(strDirectory);
+      return true;
+    }
+    unsigned int changedDirs = m_changedDirs;
+
     CStdString hash, dbHash;
     if (content == CONTENT_MOVIES ||content == CONTENT_MUSICVIDEOS)
     {
@@ -264,7 +294,9 @@ namespace VIDEO
         m_handle->SetTitle(StringUtils::Format(g_localizeStrings.Get(str), info->Name().c_str()));
       }
 
-      CStdString fastHash = GetFastHash(strDirectory);
+      CStdString fastHash;
+      if (!m_prefetcher.GetFastHash(strDirectory, fastHash))
+        fastHash = GetFastHash(strDirectory);
       if (m_database.GetPathHash(strDirectory, dbHash) && !fastHash.empty() && fastHash == dbHash)
       { // fast hashes match - no need to process anything
         CLog::Log(LOGDEBUG, "VideoInfoScanner: Skipping dir '%s' due to no change (fasthash)", CURL::GetRedacted(strDirectory).c_str());
@@ -273,8 +305,11 @@ namespace VIDEO
       }
       if (!bSkip)
       { // need to fetch the folder
-        CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
-        items.Stack();
+        if (!m_prefetcher.GetDirectory(strDirectory, items, true))
+        {
+          CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
+          items.Stack();
+        }
         // compute hash
         GetPathHash(items, hash);
         if (hash != dbHash && !hash.empty())
@@ -309,7 +344,8 @@ namespace VIDEO
 
       if (foundDirectly && !settings.parent_name_root)
       {
-        CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
+        if (!m_prefetcher.GetDirectory(strDirectory, items, false))
+          CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
         items.SetPath(strDirectory);
         GetPathHash(items, hash);
         bSkip = true;
@@ -331,6 +367,9 @@ namespace VIDEO
       }
     }
 
+    if (!bSkip || (hash.empty() && !dbHash.empty()))
+      m_changedDirs++;
+
     if (!bSkip)
     {
       if (RetrieveVideoInfo(items, settings.parent_name_root, content))
@@ -373,6 +412,11 @@ namespace VIDEO
         }
       }
     }
+
+    if (!m_bStop && m_changedDirs == changedDirs)
+      m_journalCursors[strDirectory] = cursor;
+    else
+      m_journalCursors.erase(strDirectory);
     return !m_bStop;
   }
 
@@ -677,12 +721,24 @@ namespace VIDEO
 
     if (item->m_bIsFolder)
     {
-      CUtil::GetRecursiveListing(item->GetPath(), items, g_advancedSettings.m_videoExtensions, true);
+      // a show found unchanged on its last scan needs no listing if nothing changed below it since
+      unsigned int cursor = CChangeJournal::Get().GetCursor();
+      map<CStdString, unsigned int>::const_iterator scanned = m_journalCursors.find(item->GetPath());
+      if (scanned != m_journalCursors.end() && !CChangeJournal::Get().HasChanged(item->GetPath(), scanned->second))
+      {
+        if (m_handle)
+          OnDirectoryScanned(item->GetPath());
+        return;
+      }
+
+      if (!m_prefetcher.GetRecursiveListing(item->GetPath(), items))
+        CUtil::GetRecursiveListing(item->GetPath(), items, g_advancedSettings.m_videoExtensions, true);
       CStdString hash, dbHash;
       int numFilesInFolder = GetPathHash(items, hash);
 
       if (m_database.GetPathHash(item->GetPath(), dbHash) && dbHash == hash)
       {
+        m_journalCursors[item->GetPath()] = cursor;
         m_currentItem += numFilesInFolder;
 
         // update our dialog with our progress
@@ -695,6 +751,7 @@ namespace VIDEO
         }
         return;
       }
+      m_journalCursors.erase(item->GetPath());
       m_pathsToClean.insert(m_database.GetPathId(item->GetPath()));
       m_database.GetPathsForTvShow(m_database.GetTvShowId(item->GetPath()), m_pathsToClean);
       item->SetProperty("hash", hash);
@@ -875,7 +932,14 @@ namespace VIDEO
 
   bool CVideoInfoScanner::EnumerateEpisodeItem(const CFileItem *item, EPISODELIST& episodeList)
   {
-    SETTINGS_TVSHOWLIST expression = g_advancedSettings.m_tvshowEnumRegExps;
+    const SETTINGS_TVSHOWLIST &expression = g_advancedSettings.m_tvshowEnumRegExps;
+
+    // the multipart expression goes last, after the episode expressions
+    std::vector<std::string> patterns;
+    for (unsigned int i=0;i<expression.size();++i)
+      patterns.push_back(expression[i].regexp);
+    patterns.push_back(g_advancedSettings.m_tvshowMultiPartEnumRegExp);
+    CCachedRegExpSet regExps(patterns, true);
 
     CStdString strLabel=item->GetPath();
     // URLDecode in case an episode is on a http/https/dav/davs:// source and URL-encoded like foo%201x01%20bar.avi
@@ -883,9 +947,9 @@ namespace VIDEO
 
     for (unsigned int i=0;i<expression.size();++i)
     {
-      CRegExp reg(true, CRegExp::autoUtf8);
-      if (!reg.RegComp(expression[i].regexp))
+      if (!regExps->Get(i))
         continue;
+      CRegExp &reg = *regExps->Get(i);
 
       int regexppos, regexp2pos;
       //CLog::Log(LOGDEBUG,"running expression %s on %s",expression[i].regexp.c_str(),strLabel.c_str());
@@ -952,10 +1016,11 @@ namespace VIDEO
       // add what we found by now
       episodeList.push_back(episode);
 
-      CRegExp reg2(true, CRegExp::autoUtf8);
       // check the remainder of the string for any further episodes.
-      if (!byDate && reg2.RegComp(g_advancedSettings.m_tvshowMultiPartEnumRegExp))
+      if (!byDate && regExps->Get(expression.size()))
       {
+        CRegExp &reg2 = *regExps->Get(expression.size());
+
         int offset = 0;
 
         // we want "long circuit" OR below so that both offsets are evaluated
@@ -1330,6 +1395,7 @@ namespace VIDEO
     }
 
     EPISODELIST episodes;
+    CTrigramIndex episodeTitles;
     bool hasEpisodeGuide = false;
 
     int iMax = files.size();
@@ -1460,32 +1526,48 @@ namespace VIDEO
         {
           double minscore = 0; // Default minimum score is 0 to find whatever is the best match.
 
+          double matchscore;
+          int index;
+          std::string loweredTitle(file->strTitle);
+          StringUtils::ToLower(loweredTitle);
+
           EPISODELIST *candidates;
           if (matches.empty()) // No matches found using earlier criteria. Use fuzzy match on titles across all episodes.
           {
             minscore = 0.8; // 80% should ensure a good match.
             candidates = &episodes;
+
+            // the whole guide is searched for every unmatched file, so its titles are indexed once
+            if (episodeTitles.Size() != episodes.size())
+            {
+              episodeTitles.Clear();
+              for (guide = episodes.begin(); guide != episodes.end(); ++guide)
+              {
+                StringUtils::ToLower(guide->cScraperUrl.strTitle);
+                episodeTitles.Add(guide->cScraperUrl.strTitle);
+              }
+            }
+            index = episodeTitles.FindBestMatch(loweredTitle, matchscore);
           }
           else // Multiple matches found. Use fuzzy match on the title with already matched episodes to pick the best.
+          {
             candidates = &matches;
 
-          CStdStringArray titles;
-          for (guide = candidates->begin(); guide != candidates->end(); ++guide)
-          {
-            StringUtils::ToLower(guide->cScraperUrl.strTitle);
-            titles.push_back(guide->cScraperUrl.strTitle);
+            CStdStringArray titles;
+            for (guide = candidates->begin(); guide != candidates->end(); ++guide)
+            {
+              StringUtils::ToLower(guide->cScraperUrl.strTitle);
+              titles.push_back(guide->cScraperUrl.strTitle);
+            }
+            index = StringUtils::FindBestMatch(loweredTitle, titles, matchscore);
           }
 
-          double matchscore;
-          std::string loweredTitle(file->strTitle);
-          StringUtils::ToLower(loweredTitle);
-          int index = StringUtils::FindBestMatch(loweredTitle, titles, matchscore);
-          if (matchscore >= minscore)
+          if (index >= 0 && matchscore >= minscore)
           {
             guide = candidates->begin() + index;
             bFound = true;
             CLog::Log(LOGDEBUG,"%s fuzzy title match for show: '%s', title: '%s', match: '%s', score: %f >= %f",
-                      __FUNCTION__, showInfo.m_strTitle.c_str(), file->strTitle.c_str(), titles[index].c_str(), matchscore, minscore);
+                      __FUNCTION__, showInfo.m_strTitle.c_str(), file->strTitle.c_str(), guide->cScraperUrl.strTitle.c_str(), matchscore, minscore);
           }
         }
       }
@@ -1698,7 +1780,7 @@ namespace VIDEO
     return items.GetFolderCount() == 0;
   }
 
-  CStdString CVideoInfoScanner::GetFastHash(const CStdString &directory) const
+  CStdString CVideoInfoScanner::GetFastHash(const CStdString &directory)
   {
     struct __stat64 buffer;
     if (XFILE::CFile::Stat(directory, &buffer) == 0)
@@ -22,6 +22,7 @@
 #include "VideoDatabase.h"
 #include "addons/Scraper.h"
 #include "NfoFile.h"
+#include "VideoScanPrefetcher.h"
 
 class CRegExp;
 class CFileItem;
@@ -120,6 +121,22 @@ namespace VIDEO
     static std::string GetImage(CFileItem *pItem, bool useLocal, bool bApplyToDir, const std::string &type = "");
     static std::string GetFanart(CFileItem *pItem, bool useLocal);
 
+    /*! \brief Retrieve a "fast" hash of the given directory (if available)
+     Performs a stat() on the directory, and uses modified time to create a "fast"
+     hash of the folder. If no modified time is available, the create time is used,
+     and if neither are available, an empty hash is returned.
+     \param directory folder to hash
+     \return the hash of the folder of the form "fast<datetime>"
+     */
+    static CStdString GetFastHash(const CStdString &directory);
+
+    /*! \brief Hash a folder listing by the names, sizes and dates of its items
+     \param items the listing to hash
+     \param hash the hash of the listing, empty for an empty listing
+     \return the number of video files in the listing
+     */
+    static int GetPathHash(const CFileItemList &items, CStdString &hash);
+
   protected:
     virtual void Process();
     bool DoScan(const CStdString& strDirectory);
@@ -179,17 +196,6 @@ namespace VIDEO
      */
     void FetchActorThumbs(std::vector<SActorInfo>& actors, const CStdString& strPath);
 
-    static int GetPathHash(const CFileItemList &items, CStdString &hash);
-
-    /*! \brief Retrieve a "fast" hash of the given directory (if available)
-     Performs a stat() on the directory, and uses modified time to create a "fast"
-     hash of the folder. If no modified time is available, the create time is used,
-     and if neither are available, an empty hash is returned.
-     \param directory folder to hash
-     \return the hash of the folder of the form "fast<datetime>"
-     */
-    CStdString GetFastHash(const CStdString &directory) const;
-
     /*! \brief Decide whether a folder listing could use the "fast" hash
      Fast hashing can be done whenever the folder contains no scannable subfolders, as the
      fast hash technique uses modified time to determine when folder content changes, which
@@ -238,6 +244,10 @@ namespace VIDEO
     std::set<CStdString> m_pathsToCount;
     std::set<int> m_pathsToClean;
     CNfoFile m_nfoReader;
+    CVideoScanPrefetcher m_prefetcher;
+
+    std::map<CStdString, unsigned int> m_journalCursors;  ///< position of the change journal each folder was last found unchanged at
+    unsigned int m_changedDirs;                           ///< folders scanned that weren't found unchanged
   };
 }
 
@@ -26,6 +26,7 @@
 #include "utils/TimeUtils.h"
 #include "utils/StringUtils.h"
 #include "threads/SingleLock.h"
+#include "settings/AdvancedSettings.h"
 
 #if defined(HAS_GLX) && defined(HAS_XRANDR)
   #include <sstream>
@@ -49,7 +50,6 @@
     #pragma comment (lib,"Dxerr9.lib")
   #endif
   #include "windowing/WindowingFactory.h"
-  #include "settings/AdvancedSettings.h"
 #endif
 
 using namespace std;
@@ -107,6 +107,134 @@ using namespace std;
 
 #endif
 
+#define PLL_ACQUIRE_VBLANKS 32      //vblanks to average the period over before the loop locks
+#define PLL_PHASE_GAIN      0.0625  //part of the phase error corrected at each vblank
+#define PLL_PERIOD_GAIN     0.001   //part of the phase error applied to the period at each vblank
+#define PLL_MAX_DEVIATION   0.05    //largest allowed deviation of the period from the nominal one
+#define PLL_MAX_OUTLIERS    4       //vblanks in a row too far off to be jitter before the loop starts over
+
+const unsigned int CVblankPLL::PhaseBucketLimits[VBLANK_PHASE_BUCKETS - 1] = { 100, 250, 500, 1000, 2000, 4000 };
+
+CVblankPLL::CVblankPLL()
+{
+  Reset(1, 1.0);
+}
+
+void CVblankPLL::Reset(int64_t frequency, double period)
+{
+  m_frequency = frequency;
+  m_nominal = period;
+  m_period = period;
+  m_time = 0;
+  m_acquireTime = 0;
+  m_acquireVblanks = -1;
+  m_locked = false;
+  m_outliers = 0;
+
+  m_unlocks = 0;
+  memset(m_histogram, 0, sizeof(m_histogram));
+  m_errorSquares = 0.0;
+  m_maxError = 0.0;
+}
+
+void CVblankPLL::SetNominalPeriod(double period)
+{
+  if (period == m_nominal)
+    return;
+
+  //the refreshrate changed, start over
+  m_nominal = period;
+  m_period = period;
+  m_acquireVblanks = -1;
+  m_locked = false;
+}
+
+void CVblankPLL::Acquire(int64_t time)
+{
+  m_time = time;
+  m_acquireTime = time;
+  m_acquireVblanks = 0;
+  m_locked = false;
+  m_outliers = 0;
+}
+
+//returns the estimated time of the vblank observed at time,
+//passed is set to the number of vblanks the loop moved on, 0 for a duplicate timestamp
+int64_t CVblankPLL::Update(int64_t time, int vblanks, int *passed /* = NULL */)
+{
+  if (passed)
+    *passed = vblanks;
+
+  if (vblanks <= 0)
+    return time;
+
+  if (m_acquireVblanks < 0)
+  {
+    Acquire(time);
+    return time;
+  }
+
+  //measure the period over a number of vblanks before following them
+  if (!m_locked)
+  {
+    m_time = time;
+    m_acquireVblanks += vblanks;
+    if (m_acquireVblanks >= PLL_ACQUIRE_VBLANKS)
+    {
+      double period = (double)(time - m_acquireTime) / m_acquireVblanks;
+      if (fabs(period - m_nominal) <= m_nominal * PLL_MAX_DEVIATION)
+      {
+        m_period = period;
+        m_locked = true;
+      }
+      else
+      {
+        Acquire(time);
+      }
+    }
+    return time;
+  }
+
+  double predicted = m_period * vblanks;
+  double error     = (double)(time - m_time) - predicted;
+
+  //too far off to be jitter, a missed or duplicate timestamp is skipped,
+  //if it keeps happening the vblanks stalled or the refreshrate changed
+  if (fabs(error) > m_period / 4.0)
+  {
+    if (++m_outliers >= PLL_MAX_OUTLIERS)
+    {
+      m_unlocks++;
+      Acquire(time);
+      return time;
+    }
+    //stay on the vblank closest to the timestamp, which skips a missed vblank or a duplicate timestamp
+    double periods = max(floor((double)(time - m_time) / m_period + 0.5), 0.0);
+    m_time += (int64_t)(m_period * periods);
+    if (passed)
+      *passed = (int)periods;
+    return m_time;
+  }
+  m_outliers = 0;
+
+  double seconds = fabs(error) / (double)m_frequency;
+  m_errorSquares += seconds * seconds;
+  m_maxError = max(m_maxError, seconds);
+
+  unsigned int micro = (unsigned int)(seconds * 1000000.0);
+  int bucket = 0;
+  while (bucket < VBLANK_PHASE_BUCKETS - 1 && micro >= PhaseBucketLimits[bucket])
+    bucket++;
+  m_histogram[bucket]++;
+
+  m_period += PLL_PERIOD_GAIN * error / vblanks;
+  m_period = max(m_period, m_nominal * (1.0 - PLL_MAX_DEVIATION));
+  m_period = min(m_period, m_nominal * (1.0 + PLL_MAX_DEVIATION));
+
+  m_time += (int64_t)(predicted + PLL_PHASE_GAIN * error);
+  return m_time;
+}
+
 CVideoReferenceClock::CVideoReferenceClock() : CThread("VideoReferenceClock")
 {
   m_SystemFrequency = CurrentHostFrequency();
@@ -126,6 +254,10 @@ CVideoReferenceClock::CVideoReferenceClock() : CThread("VideoReferenceClock")
   m_MissedVblanks = 0;
   m_RefreshChanged = 0;
   m_VblankTime = 0;
+  m_UseSoftware = false;
+  m_SoftwareRate = 0.0;
+  m_Adjustments = 0;
+  m_StartTime = 0;
 
 #if defined(HAS_GLX) && defined(HAS_XRANDR)
   m_glXWaitVideoSyncSGI = NULL;
@@ -170,18 +302,27 @@ void CVideoReferenceClock::Process()
   while(!m_bStop)
   {
     //set up the vblank clock
+    m_UseSoftware = SetupSoftware();
+    if (m_UseSoftware)
+      SetupSuccess = true;
 #if defined(HAS_GLX) && defined(HAS_XRANDR)
-    SetupSuccess = SetupGLX();
+    else
+      SetupSuccess = SetupGLX();
 #elif defined(TARGET_WINDOWS) && defined(HAS_DX)
-    SetupSuccess = SetupD3D();
+    else
+      SetupSuccess = SetupD3D();
 #elif defined(TARGET_DARWIN)
-    SetupSuccess = SetupCocoa();
+    else
+      SetupSuccess = SetupCocoa();
 #elif defined(HAS_GLX)
-    CLog::Log(LOGDEBUG, "CVideoReferenceClock: compiled without RandR support");
+    else
+      CLog::Log(LOGDEBUG, "CVideoReferenceClock: compiled without RandR support");
 #elif defined(TARGET_WINDOWS)
-    CLog::Log(LOGDEBUG, "CVideoReferenceClock: only available on directx build");
+    else
+      CLog::Log(LOGDEBUG, "CVideoReferenceClock: only available on directx build");
 #else
-    CLog::Log(LOGDEBUG, "CVideoReferenceClock: no implementation available");
+    else
+      CLog::Log(LOGDEBUG, "CVideoReferenceClock: no implementation available");
 #endif
 
     CSingleLock SingleLock(m_CritSection);
@@ -193,6 +334,9 @@ void CVideoReferenceClock::Process()
     m_TotalMissedVblanks = 0;
     m_fineadjust = 1.0;
     m_RefreshChanged = 0;
+    m_Adjustments = 0;
+    m_StartTime = Now;
+    m_Pll.Reset(m_SystemFrequency, (double)m_SystemFrequency / (m_RefreshRate > 0 ? m_RefreshRate : 60));
     m_Started.Set();
 
     if (SetupSuccess)
@@ -202,12 +346,17 @@ void CVideoReferenceClock::Process()
       SingleLock.Leave();
 
       //run the clock
+      if (m_UseSoftware)
+        RunSoftware();
 #if defined(HAS_GLX) && defined(HAS_XRANDR)
-      RunGLX();
+      else
+        RunGLX();
 #elif defined(TARGET_WINDOWS) && defined(HAS_DX)
-      RunD3D();
+      else
+        RunD3D();
 #elif defined(TARGET_DARWIN)
-      RunCocoa();
+      else
+        RunCocoa();
 #endif
 
     }
@@ -252,6 +401,60 @@ void CVideoReferenceClock::Process()
 #endif
 }
 
+bool CVideoReferenceClock::SetupSoftware()
+{
+  m_SoftwareRate = g_advancedSettings.m_videoSoftwareVblank;
+  if (m_SoftwareRate <= 0.0)
+    return false;
+
+  m_RefreshRate = MathUtils::round_int(m_SoftwareRate);
+  CLog::Log(LOGDEBUG, "CVideoReferenceClock: using a software vblank of %f hertz", m_SoftwareRate);
+  return true;
+}
+
+//generates vblanks with a timer, for running without a display or for testing the clock
+void CVideoReferenceClock::RunSoftware()
+{
+  double  Period = (double)m_SystemFrequency / m_SoftwareRate;
+  int64_t Start  = CurrentHostCounter();
+  int64_t VblankCount = 0;
+  int64_t PrevVblankCount = 0;
+  int64_t Now;
+
+  CSingleLock SingleLock(m_CritSection);
+  SingleLock.Leave();
+
+  while(!m_bStop)
+  {
+#if defined(HAS_GLX) && defined(HAS_XRANDR)
+    if (m_xrrEvent)
+      return;
+#endif
+
+    //sleep until the next vblank is due, rounding up so we don't wake up too early
+    int64_t NextVblank = Start + (int64_t)(Period * (PrevVblankCount + 1));
+    Now = CurrentHostCounter();
+    if (NextVblank > Now)
+    {
+      Sleep((unsigned int)(((NextVblank - Now) * 1000 + m_SystemFrequency - 1) / m_SystemFrequency));
+      Now = CurrentHostCounter();
+    }
+
+    VblankCount = (int64_t)((double)(Now - Start) / Period);
+    if (VblankCount <= PrevVblankCount)
+      continue;
+
+    //update the vblank timestamp, update the clock and send a signal that we got a vblank
+    SingleLock.Enter();
+    m_VblankTime = Now;
+    UpdateClock((int)(VblankCount - PrevVblankCount), true);
+    SingleLock.Leave();
+    SendVblankSignal();
+
+    PrevVblankCount = VblankCount;
+  }
+}
+
 bool CVideoReferenceClock::WaitStarted(int MSecs)
 {
   //not waiting here can cause issues with alsa
@@ -977,6 +1180,13 @@ void CVideoReferenceClock::UpdateClock(int NrVBlanks, bool CheckMissed)
 {
   if (CheckMissed) //set to true from the vblank run function, set to false from Wait and GetTime
   {
+    //let the loop follow the vblanks and continue from its estimate of when this one happened
+    int passed;
+    m_Pll.SetNominalPeriod((double)m_SystemFrequency / m_RefreshRate);
+    m_VblankTime = m_Pll.Update(m_VblankTime, NrVBlanks, &passed);
+    if (passed == 0) //the same vblank reported again, the clock already moved on for it
+      return;
+
     if (NrVBlanks < m_MissedVblanks) //if this is true the vblank detection in the run function is wrong
       CLog::Log(LOGDEBUG, "CVideoReferenceClock: detected %i vblanks, missed %i, refreshrate might have changed",
                 NrVBlanks, m_MissedVblanks);
@@ -988,7 +1198,7 @@ void CVideoReferenceClock::UpdateClock(int NrVBlanks, bool CheckMissed)
   {
     m_MissedVblanks += NrVBlanks;      //tell the vblank clock how many vblanks it missed
     m_TotalMissedVblanks += NrVBlanks; //for the codec information screen
-    m_VblankTime += m_SystemFrequency * (int64_t)NrVBlanks / m_RefreshRate; //set the vblank time forward
+    m_VblankTime += (int64_t)(m_Pll.GetPeriod() * NrVBlanks); //set the vblank time forward
   }
 
   if (NrVBlanks > 0) //update the clock with the adjusted frequency if we have any vblanks
@@ -1070,6 +1280,7 @@ void CVideoReferenceClock::SetSpeed(double Speed)
     if (Speed != m_ClockSpeed)
     {
       m_ClockSpeed = Speed;
+      m_Adjustments++;
       CLog::Log(LOGDEBUG, "CVideoReferenceClock: Clock speed %f%%", GetSpeed() * 100.0);
     }
   }
@@ -1246,7 +1457,7 @@ void CVideoReferenceClock::SendVblankSignal()
 //increase that by 30% to allow for errors
 int64_t CVideoReferenceClock::TimeOfNextVblank()
 {
-  return m_VblankTime + (m_SystemFrequency / m_RefreshRate * MAXVBLANKDELAY / 10LL);
+  return m_VblankTime + (int64_t)(m_Pll.GetPeriod() * MAXVBLANKDELAY / 10.0);
 }
 
 //for the codec information screen
@@ -1262,6 +1473,37 @@ bool CVideoReferenceClock::GetClockInfo(int& MissedVblanks, double& ClockSpeed,
   return false;
 }
 
+bool CVideoReferenceClock::GetStatistics(Statistics& stats)
+{
+  CSingleLock SingleLock(m_CritSection);
+
+  if (!m_UseVblank)
+    return false;
+
+  unsigned int observations = 0;
+  for (int i = 0; i < VBLANK_PHASE_BUCKETS; i++)
+  {
+    stats.histogram[i] = m_Pll.m_histogram[i];
+    observations += m_Pll.m_histogram[i];
+  }
+
+  stats.software            = m_UseSoftware;
+  stats.refreshRate         = (int)m_RefreshRate;
+  stats.measuredRefreshRate = m_Pll.IsLocked() ? (double)m_SystemFrequency / m_Pll.GetPeriod() : 0.0;
+  stats.locked              = m_Pll.IsLocked();
+  stats.missedVblanks       = m_TotalMissedVblanks;
+  stats.unlocks             = m_Pll.m_unlocks;
+  stats.phaseError          = observations > 0 ? sqrt(m_Pll.m_errorSquares / observations) * 1000.0 : 0.0;
+  stats.maxPhaseError       = m_Pll.m_maxError * 1000.0;
+  stats.speed               = m_ClockSpeed * m_fineadjust * 100.0;
+  stats.adjustments         = m_Adjustments;
+
+  double Minutes = (double)(CurrentHostCounter() - m_StartTime) / (double)m_SystemFrequency / 60.0;
+  stats.adjustRate = Minutes > 0.0 ? m_Adjustments / Minutes : 0.0;
+
+  return true;
+}
+
 void CVideoReferenceClock::SetFineAdjust(double fineadjust)
 {
   CSingleLock SingleLock(m_CritSection);
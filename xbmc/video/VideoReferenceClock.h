@@ -56,12 +56,72 @@ class CD3DCallback : public ID3DResource
 
 #endif
 
+#define VBLANK_PHASE_BUCKETS 7
+
+/*!
+ \brief Phase locked loop following the vblanks of the display.
+
+ The times at which the clock thread wakes up after a vblank depend on the
+ scheduler, so they jitter. The loop estimates the real period and phase of
+ the vblanks from them, which gives a steady base for interpolating the clock
+ and predicting the next vblank. It also keeps a histogram of the phase error,
+ the distance between the observed and the predicted vblanks.
+ */
+class CVblankPLL
+{
+  public:
+    CVblankPLL();
+
+    void    Reset(int64_t frequency, double period);
+    void    SetNominalPeriod(double period);
+    int64_t Update(int64_t time, int vblanks, int *passed = NULL);
+    double  GetPeriod() const { return m_period; }
+    bool    IsLocked() const  { return m_locked; }
+
+    static const unsigned int PhaseBucketLimits[VBLANK_PHASE_BUCKETS - 1];
+
+  private:
+    friend class CVideoReferenceClock;
+
+    void Acquire(int64_t time);
+
+    int64_t m_frequency;       //frequency of the systemclock
+    double  m_nominal;         //period derived from the refreshrate
+    double  m_period;          //estimated vblank period in host counter ticks
+    int64_t m_time;            //estimated time of the last vblank
+    int64_t m_acquireTime;     //first vblank seen while acquiring
+    int     m_acquireVblanks;  //vblanks seen while acquiring, -1 before the first one
+    bool    m_locked;
+    int     m_outliers;        //vblanks in a row too far off to be jitter
+
+    unsigned int m_unlocks;                            //number of times the loop lost track of the vblanks
+    unsigned int m_histogram[VBLANK_PHASE_BUCKETS];    //phase errors by PhaseBucketLimits (microseconds)
+    double       m_errorSquares;                       //sum of the squared phase errors in seconds
+    double       m_maxError;                           //largest phase error in seconds
+};
+
 class CVideoReferenceClock : public CThread
 #if defined(HAS_GLX) && defined(HAS_XRANDR)
                             ,public IDispResource
 #endif
 {
   public:
+    struct Statistics
+    {
+      bool         software;                          //vblanks come from a timer instead of the display
+      int          refreshRate;
+      double       measuredRefreshRate;
+      bool         locked;
+      unsigned int missedVblanks;
+      unsigned int unlocks;
+      double       phaseError;                        //rms phase error in milliseconds
+      double       maxPhaseError;                     //in milliseconds
+      unsigned int histogram[VBLANK_PHASE_BUCKETS];
+      double       speed;                             //clock speed in percent, including fine adjustments
+      unsigned int adjustments;                       //number of speed changes requested by dvdplayer
+      double       adjustRate;                        //speed changes per minute
+    };
+
     CVideoReferenceClock();
     virtual ~CVideoReferenceClock();
 
@@ -73,6 +133,7 @@ class CVideoReferenceClock : public CThread
     int64_t Wait(int64_t Target);
     bool    WaitStarted(int MSecs);
     bool    GetClockInfo(int& MissedVblanks, double& ClockSpeed, int& RefreshRate);
+    bool    GetStatistics(Statistics& stats);
     void    SetFineAdjust(double fineadjust);
     void    RefreshChanged() { m_RefreshChanged = 1; }
 
@@ -93,6 +154,9 @@ class CVideoReferenceClock : public CThread
     double  UpdateInterval();
     int64_t TimeOfNextVblank();
 
+    bool    SetupSoftware();
+    void    RunSoftware();
+
     int64_t m_CurrTime;          //the current time of the clock when using vblank as clock source
     int64_t m_LastIntTime;       //last interpolated clock value, to make sure the clock doesn't go backwards
     double  m_CurrTimeFract;     //fractional part that is lost due to rounding when updating the clock
@@ -110,6 +174,12 @@ class CVideoReferenceClock : public CThread
     int     m_TotalMissedVblanks;//total number of clock updates missed, used by codec information screen
     int64_t m_VblankTime;        //last time the clock was updated when using vblank as clock
 
+    CVblankPLL   m_Pll;               //follows the vblanks, for predicting them and for statistics
+    bool         m_UseSoftware;       //set to true when a timer is used instead of the vblank of the display
+    double       m_SoftwareRate;      //refreshrate of the timer
+    unsigned int m_Adjustments;       //number of speed changes since the clock started
+    int64_t      m_StartTime;         //when the clock started, for the adjustment rate
+
     CEvent  m_Started;            //set when the vblank clock is started
     CEvent  m_VblankEvent;        //set when a vblank happens
 
@@ -0,0 +1,349 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+
+#include "VideoScanPrefetcher.h"
+#include "FileItem.h"
+#include "Util.h"
+#include "filesystem/Directory.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "utils/ChangeJournal.h"
+#include "utils/JobManager.h"
+#include "utils/log.h"
+#include "video/VideoDatabase.h"
+#include "video/VideoInfoScanner.h"
+
+// listings held for the scanner at most, the jobs stop when it's reached
+#define PREFETCH_MAX_READY 200
+
+using namespace std;
+using namespace XFILE;
+using namespace ADDON;
+
+namespace VIDEO
+{
+  CVideoScanPrefetchJob::CVideoScanPrefetchJob(CVideoScanPrefetcher *prefetcher, unsigned int generation, const CStdString &path)
+    : m_prefetcher(prefetcher), m_generation(generation), m_path(path)
+  {
+    CSingleLock lock(m_prefetcher->m_jobsSection);
+    m_prefetcher->m_jobCount++;
+  }
+
+  CVideoScanPrefetchJob::~CVideoScanPrefetchJob()
+  {
+    CSingleLock lock(m_prefetcher->m_jobsSection);
+    if (--m_prefetcher->m_jobCount == 0)
+      m_prefetcher->m_jobsDone.Set();
+  }
+
+  bool CVideoScanPrefetchJob::DoWork()
+  {
+    CVideoDatabase db;
+    if (!db.Open())
+      return false;
+
+    m_prefetcher->Prefetch(db, m_generation, m_path);
+    db.Close();
+    return true;
+  }
+
+  CVideoScanPrefetcher::CVideoScanPrefetcher()
+  {
+    m_jobs = NULL;
+    m_scanAll = false;
+    m_generation = 0;
+    m_ready = 0;
+    m_prefetched = 0;
+    m_requested = 0;
+    m_jobCount = 0;
+  }
+
+  CVideoScanPrefetcher::~CVideoScanPrefetcher()
+  {
+    Stop();
+  }
+
+  void CVideoScanPrefetcher::Start(const set<CStdString> &paths, bool scanAll, unsigned int jobs, const map<CStdString, unsigned int> &journalCursors)
+  {
+    Stop();
+
+    CSingleLock lock(m_critSection);
+    m_scanAll = scanAll;
+    m_journalCursors = journalCursors;
+    m_prefetched = 0;
+    m_requested = 0;
+    m_jobs = new CJobQueue(false, jobs, CJob::PRIORITY_LOW);
+    for (set<CStdString>::const_iterator it = paths.begin(); it != paths.end(); ++it)
+      m_jobs->AddJob(new CVideoScanPrefetchJob(this, m_generation, *it));
+  }
+
+  void CVideoScanPrefetcher::Stop()
+  {
+    CJobQueue *jobs;
+    {
+      CSingleLock lock(m_critSection);
+      jobs = m_jobs;
+      if (jobs == NULL)
+        return;
+
+      CLog::Log(LOGDEBUG, "VideoInfoScanner: %u of %u folder lookups were prefetched", m_prefetched, m_requested);
+      m_jobs = NULL;
+      m_generation++;
+      Clear();
+    }
+
+    // cancels the jobs not started yet, running ones stop at their next folder
+    delete jobs;
+
+    // the running jobs use this prefetcher and their database until they're deleted
+    CSingleLock lock(m_jobsSection);
+    while (m_jobCount > 0)
+    {
+      lock.Leave();
+      m_jobsDone.Wait();
+      lock.Enter();
+    }
+  }
+
+  bool CVideoScanPrefetcher::GetFastHash(const CStdString &directory, CStdString &hash)
+  {
+    return Get(directory, FastHash, &hash, NULL);
+  }
+
+  bool CVideoScanPrefetcher::GetDirectory(const CStdString &directory, CFileItemList &items, bool stacked)
+  {
+    return Get(directory, stacked ? StackedListing : Listing, NULL, &items);
+  }
+
+  bool CVideoScanPrefetcher::GetRecursiveListing(const CStdString &directory, CFileItemList &items)
+  {
+    return Get(directory, RecursiveListing, NULL, &items);
+  }
+
+  bool CVideoScanPrefetcher::Prefetch(CVideoDatabase &db, unsigned int generation, const CStdString &directory)
+  {
+    // the same decisions CVideoInfoScanner::DoScan takes for the folder
+    SScanSettings settings;
+    bool foundDirectly = false;
+    ScraperPtr info = db.GetScraperForPath(directory, settings, foundDirectly);
+    CONTENT_TYPE content = info ? info->Content() : CONTENT_NONE;
+
+    CStdStringArray regexps = content == CONTENT_TVSHOWS ? g_advancedSettings.m_tvshowExcludeFromScanRegExps
+                                                         : g_advancedSettings.m_moviesExcludeFromScanRegExps;
+    if (CUtil::ExcludeFileOrFolder(directory, regexps))
+      return true;
+
+    if (content == CONTENT_NONE || (!m_scanAll && settings.noupdate))
+      return true;
+
+    // the scanner skips the folder and its subfolders without looking at them
+    if (IsUnchanged(directory))
+      return true;
+
+    if (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS)
+    {
+      BeginResult result = Begin(generation, directory, FastHash);
+      if (result != Claimed)
+        return result == Taken;
+
+      CStdString fastHash = CVideoInfoScanner::GetFastHash(directory);
+      Finish(generation, directory, FastHash, fastHash, NULL);
+
+      CStdString dbHash;
+      if (db.GetPathHash(directory, dbHash) && !fastHash.empty() && fastHash == dbHash)
+        return true;
+
+      result = Begin(generation, directory, StackedListing);
+      if (result != Claimed)
+        return result == Taken;
+
+      CFileItemList *items = new CFileItemList;
+      CDirectory::GetDirectory(directory, *items, g_advancedSettings.m_videoExtensions);
+      items->Stack();
+
+      vector<CStdString> folders;
+      for (int i = 0; i < items->Size(); ++i)
+      {
+        CFileItemPtr pItem = items->Get(i);
+        if (pItem->m_bIsFolder && !pItem->IsParentFolder() && !pItem->IsPlayList())
+          folders.push_back(pItem->GetPath());
+      }
+      Finish(generation, directory, StackedListing, "", items);
+
+      if (settings.recurse > 0)
+      {
+        for (vector<CStdString>::const_iterator it = folders.begin(); it != folders.end(); ++it)
+        {
+          if (!Prefetch(db, generation, *it))
+            return false;
+        }
+      }
+    }
+    else if (content == CONTENT_TVSHOWS)
+    {
+      // a folder set to tvshows is listed, the shows in it are listed recursively
+      Kind kind = foundDirectly && !settings.parent_name_root ? Listing : RecursiveListing;
+      BeginResult result = Begin(generation, directory, kind);
+      if (result != Claimed)
+        return result == Taken;
+
+      CFileItemList *items = new CFileItemList;
+      vector<CStdString> shows;
+      if (kind == Listing)
+      {
+        CDirectory::GetDirectory(directory, *items, g_advancedSettings.m_videoExtensions);
+
+        // the scanner only goes into the shows if the listing changed
+        CStdString hash, dbHash;
+        CVideoInfoScanner::GetPathHash(*items, hash);
+        if (!db.GetPathHash(directory, dbHash) || dbHash != hash)
+        {
+          for (int i = 0; i < items->Size(); ++i)
+          {
+            CFileItemPtr pItem = items->Get(i);
+            if (pItem->m_bIsFolder && !pItem->IsParentFolder() && !pItem->IsPlayList())
+              shows.push_back(pItem->GetPath());
+          }
+        }
+      }
+      else
+        CUtil::GetRecursiveListing(directory, *items, g_advancedSettings.m_videoExtensions, true);
+      Finish(generation, directory, kind, "", items);
+
+      for (vector<CStdString>::const_iterator it = shows.begin(); it != shows.end(); ++it)
+      {
+        if (!Prefetch(db, generation, *it))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  bool CVideoScanPrefetcher::IsUnchanged(const CStdString &directory)
+  {
+    unsigned int cursor;
+    {
+      CSingleLock lock(m_critSection);
+      map<CStdString, unsigned int>::const_iterator it = m_journalCursors.find(directory);
+      if (it == m_journalCursors.end())
+        return false;
+      cursor = it->second;
+    }
+    return !CChangeJournal::Get().HasChanged(directory, cursor);
+  }
+
+  CVideoScanPrefetcher::BeginResult CVideoScanPrefetcher::Begin(unsigned int generation, const CStdString &directory, Kind kind)
+  {
+    CSingleLock lock(m_critSection);
+    if (generation != m_generation || m_ready >= PREFETCH_MAX_READY)
+      return Abort;
+
+    Key key(directory, kind);
+    map<Key, Entry>::const_iterator it = m_entries.find(key);
+    if (it != m_entries.end())
+      return it->second.state == Passed ? Abort : Taken;
+
+    Entry entry;
+    entry.state = Pending;
+    entry.items = NULL;
+    m_entries.insert(make_pair(key, entry));
+    return Claimed;
+  }
+
+  void CVideoScanPrefetcher::Finish(unsigned int generation, const CStdString &directory, Kind kind, const CStdString &hash, CFileItemList *items)
+  {
+    {
+      CSingleLock lock(m_critSection);
+      map<Key, Entry>::iterator it = m_entries.find(Key(directory, kind));
+      if (generation == m_generation && it != m_entries.end())
+      {
+        it->second.state = Ready;
+        it->second.hash = hash;
+        it->second.items = items;
+        if (items)
+          m_ready++;
+        items = NULL;
+      }
+    }
+    delete items;
+    m_finished.Set();
+  }
+
+  bool CVideoScanPrefetcher::Get(const CStdString &directory, Kind kind, CStdString *hash, CFileItemList *items)
+  {
+    CSingleLock lock(m_critSection);
+    if (m_jobs == NULL)
+      return false;
+
+    m_requested++;
+    Key key(directory, kind);
+    while (true)
+    {
+      map<Key, Entry>::iterator it = m_entries.find(key);
+      if (it == m_entries.end())
+      {
+        // the scanner is ahead of the jobs, the one walking this folder stops here
+        Entry entry;
+        entry.state = Passed;
+        entry.items = NULL;
+        m_entries.insert(make_pair(key, entry));
+        return false;
+      }
+
+      Entry &entry = it->second;
+      if (entry.state == Passed)
+        return false;
+
+      if (entry.state == Ready)
+      {
+        if (hash)
+          *hash = entry.hash;
+        if (entry.items)
+        {
+          if (items)
+            items->Assign(*entry.items);
+          delete entry.items;
+          entry.items = NULL;
+          m_ready--;
+        }
+        entry.state = Passed;
+        m_prefetched++;
+        return true;
+      }
+
+      // a job is busy with it, its listing is as good as the scanner's
+      lock.Leave();
+      m_finished.WaitMSec(100);
+      lock.Enter();
+      if (m_jobs == NULL)
+        return false;
+    }
+  }
+
+  void CVideoScanPrefetcher::Clear()
+  {
+    for (map<Key, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+      delete it->second.items;
+    m_entries.clear();
+    m_ready = 0;
+  }
+}
@@ -0,0 +1,159 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <set>
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/Job.h"
+#include "utils/StdString.h"
+
+class CFileItemList;
+class CJobQueue;
+class CVideoDatabase;
+class TestVideoScanPrefetcher;
+
+namespace VIDEO
+{
+  class CVideoScanPrefetcher;
+
+  /*!
+   \brief Job walking one of the paths to scan for the CVideoScanPrefetcher.
+   \sa CVideoScanPrefetcher
+   */
+  class CVideoScanPrefetchJob : public CJob
+  {
+  public:
+    CVideoScanPrefetchJob(CVideoScanPrefetcher *prefetcher, unsigned int generation, const CStdString &path);
+    virtual ~CVideoScanPrefetchJob();
+
+    virtual bool DoWork();
+
+  private:
+    CVideoScanPrefetcher *m_prefetcher;
+    unsigned int m_generation;
+    CStdString m_path;
+  };
+
+  /*!
+   \brief Lists the folders of the paths to scan ahead of the video scanner.
+
+   A scan of network shares where little has changed spends most of its time listing
+   and stat()ing folders. The prefetcher walks the paths to scan on a few jobs at once,
+   one job per path, doing the listings the scanner is going to ask for. The scanner
+   still visits the folders in its own order and does all lookups, scraping and
+   database writes on its own thread, taking the listings from the prefetcher where
+   they are available and doing them itself where not. The results of a scan are
+   thus the same with and without prefetching.
+
+   The scanner waits for a listing a job is busy with. Folders it asks for before a
+   job got to them are left to the scanner, and the job walking them stops, as the
+   scanner is ahead of it.
+
+   Stop waits for the jobs to be gone, the running ones stop at their next folder.
+   */
+  class CVideoScanPrefetcher
+  {
+  public:
+    CVideoScanPrefetcher();
+    ~CVideoScanPrefetcher();
+
+    /*! \brief Start prefetching the paths to scan.
+     \param paths the paths to scan, they are walked in the given order.
+     \param scanAll whether folders excluded from updates are scanned.
+     \param jobs the number of paths walked at once.
+     \param journalCursors the position of the change journal each folder was last found unchanged at.
+            The folders the journal reports unchanged since are skipped, as the scanner skips them.
+     */
+    void Start(const std::set<CStdString> &paths, bool scanAll, unsigned int jobs, const std::map<CStdString, unsigned int> &journalCursors);
+    void Stop();
+
+    /*! \brief Get the fast hash of a folder, see CVideoInfoScanner::GetFastHash.
+     \return true if the hash was prefetched, false if the caller needs to get it.
+     */
+    bool GetFastHash(const CStdString &directory, CStdString &hash);
+
+    /*! \brief Get the listing of the video files of a folder.
+     \param stacked whether the listing is to be stacked.
+     \return true if the listing was prefetched, false if the caller needs to get it.
+     */
+    bool GetDirectory(const CStdString &directory, CFileItemList &items, bool stacked);
+
+    /*! \brief Get the recursive listing of the video files of a tvshow folder.
+     \return true if the listing was prefetched, false if the caller needs to get it.
+     */
+    bool GetRecursiveListing(const CStdString &directory, CFileItemList &items);
+
+  private:
+    friend class CVideoScanPrefetchJob;
+    friend class ::TestVideoScanPrefetcher;
+
+    enum Kind { FastHash, Listing, StackedListing, RecursiveListing };
+    enum State
+    {
+      Pending,      ///< a job is getting it
+      Ready,        ///< a job got it
+      Passed        ///< the scanner got there first
+    };
+    enum BeginResult { Claimed, Taken, Abort };
+
+    struct Entry
+    {
+      State state;
+      CStdString hash;
+      CFileItemList *items;
+    };
+    typedef std::pair<CStdString, int> Key;
+
+    /*! \brief Walk a folder as CVideoInfoScanner::DoScan does.
+     \return false if the walk should stop.
+     */
+    bool Prefetch(CVideoDatabase &db, unsigned int generation, const CStdString &directory);
+
+    /*! \brief Check whether the change journal reports a folder unchanged since the scanner last found it so.
+     */
+    bool IsUnchanged(const CStdString &directory);
+
+    /*! \brief Claim a listing for a job.
+     \return Claimed if the job is to get it, Taken if another job has, Abort if the scanner has passed it or the prefetcher is stopped or full.
+     */
+    BeginResult Begin(unsigned int generation, const CStdString &directory, Kind kind);
+    void Finish(unsigned int generation, const CStdString &directory, Kind kind, const CStdString &hash, CFileItemList *items);
+    bool Get(const CStdString &directory, Kind kind, CStdString *hash, CFileItemList *items);
+    void Clear();
+
+    CJobQueue *m_jobs;
+    bool m_scanAll;
+    std::map<CStdString, unsigned int> m_journalCursors;
+    unsigned int m_generation;
+    unsigned int m_ready;         ///< listings held for the scanner
+    unsigned int m_prefetched;
+    unsigned int m_requested;
+    std::map<Key, Entry> m_entries;
+    CCriticalSection m_critSection;
+    CEvent m_finished;
+
+    unsigned int m_jobCount;      ///< jobs queued or running
+    CCriticalSection m_jobsSection;
+    CEvent m_jobsDone;
+  };
+}
@@ -177,6 +177,7 @@ void CVideoThumbLoader::OnLoaderStart()
 {
   m_videoDatabase->Open();
   m_showArt.clear();
+  PrefetchLibraryInfo(m_vecItems);
   CThumbLoader::OnLoaderStart();
 }
 
@@ -184,9 +185,89 @@ void CVideoThumbLoader::OnLoaderFinish()
 {
   m_videoDatabase->Close();
   m_showArt.clear();
+  m_libraryArt.clear();
+  m_prefetchedStreamDetails.clear();
   CThumbLoader::OnLoaderFinish();
 }
 
+void CVideoThumbLoader::PrefetchLibraryInfo(const vector<CFileItemPtr> &items, bool streamDetails /* = true */)
+{
+  m_libraryArt.clear();
+  m_prefetchedStreamDetails.clear();
+
+  map<string, vector<int> > artIds;
+  vector<int> showIds;
+  CFileItemList streamDetailItems;
+  for (vector<CFileItemPtr>::const_iterator it = items.begin(); it != items.end(); ++it)
+  {
+    const CFileItemPtr &item = *it;
+    if (!item->HasVideoInfoTag() || item->m_bIsShareOrDrive || item->IsParentFolder())
+      continue;
+
+    const CVideoInfoTag *tag = item->GetVideoInfoTag();
+    if (tag->m_iDbId > -1 && !tag->m_type.empty() && !item->HasArt("thumb"))
+    {
+      artIds[tag->m_type].push_back(tag->m_iDbId);
+      if (tag->m_iIdShow >= 0 && m_showArt.find(tag->m_iIdShow) == m_showArt.end())
+      {
+        m_showArt[tag->m_iIdShow]; // filled below
+        showIds.push_back(tag->m_iIdShow);
+      }
+    }
+    if (streamDetails && tag->m_iFileId >= 0 && !tag->HasStreamDetails())
+      streamDetailItems.Add(item);
+  }
+
+  if (artIds.empty() && streamDetailItems.IsEmpty())
+    return;
+
+  m_videoDatabase->Open();
+  for (map<string, vector<int> >::const_iterator it = artIds.begin(); it != artIds.end(); ++it)
+  {
+    // on failure the art is looked up per item
+    ArtCache &art = m_libraryArt[it->first];
+    if (!m_videoDatabase->GetArtForItems(it->first, it->second, art))
+    {
+      m_libraryArt.erase(it->first);
+      continue;
+    }
+    // items without art get an empty entry, so only items that weren't prefetched are looked up
+    for (vector<int>::const_iterator id = it->second.begin(); id != it->second.end(); ++id)
+      art[*id];
+  }
+  if (!showIds.empty())
+  {
+    ArtCache showArt;
+    m_videoDatabase->GetArtForItems(MediaTypeTvShow, showIds, showArt);
+    for (vector<int>::const_iterator it = showIds.begin(); it != showIds.end(); ++it)
+      m_showArt[*it] = showArt[*it];
+  }
+  if (!streamDetailItems.IsEmpty() && m_videoDatabase->GetStreamDetailsForItems(streamDetailItems))
+  {
+    for (int i = 0; i < streamDetailItems.Size(); i++)
+    {
+      m_prefetchedStreamDetails.insert(streamDetailItems[i]->GetVideoInfoTag()->m_iFileId);
+      if (streamDetailItems[i]->GetVideoInfoTag()->HasStreamDetails())
+        streamDetailItems[i]->SetInvalid();
+    }
+  }
+  m_videoDatabase->Close();
+}
+
+bool CVideoThumbLoader::GetLibraryArt(int dbId, const std::string &mediaType, map<string, string> &artwork)
+{
+  map<string, ArtCache>::const_iterator prefetched = m_libraryArt.find(mediaType);
+  if (prefetched == m_libraryArt.end())
+    return m_videoDatabase->GetArtForItem(dbId, mediaType, artwork);
+
+  // e.g. the item already had a thumb when the art was prefetched
+  ArtCache::const_iterator art = prefetched->second.find(dbId);
+  if (art == prefetched->second.end())
+    return m_videoDatabase->GetArtForItem(dbId, mediaType, artwork);
+  artwork = art->second;
+  return !artwork.empty();
+}
+
 static void SetupRarOptions(CFileItem& item, const CStdString& path)
 {
   CStdString path2(path);
@@ -258,8 +339,11 @@ bool CVideoThumbLoader::LoadItemCached(CFileItem* pItem)
 
   if (!pItem->HasVideoInfoTag() || !pItem->GetVideoInfoTag()->HasStreamDetails()) // no stream details
   {
-    if ((pItem->HasVideoInfoTag() && pItem->GetVideoInfoTag()->m_iFileId >= 0) // file (or maybe folder) is in the database
-    || (!pItem->m_bIsFolder && pItem->IsVideo())) // Some other video file for which we haven't yet got any database details
+    // prefetched items without stream details don't have any in the database
+    bool prefetched = pItem->HasVideoInfoTag() && m_prefetchedStreamDetails.find(pItem->GetVideoInfoTag()->m_iFileId) != m_prefetchedStreamDetails.end();
+    if (!prefetched &&
+       ((pItem->HasVideoInfoTag() && pItem->GetVideoInfoTag()->m_iFileId >= 0) // file (or maybe folder) is in the database
+    || (!pItem->m_bIsFolder && pItem->IsVideo()))) // Some other video file for which we haven't yet got any database details
     {
       if (m_videoDatabase->GetStreamDetails(*pItem))
         pItem->SetInvalid();
@@ -421,7 +505,7 @@ bool CVideoThumbLoader::FillLibraryArt(CFileItem &item)
   {
     map<string, string> artwork;
     m_videoDatabase->Open();
-    if (m_videoDatabase->GetArtForItem(tag.m_iDbId, tag.m_type, artwork))
+    if (GetLibraryArt(tag.m_iDbId, tag.m_type, artwork))
       SetArt(item, artwork);
     else if (tag.m_type == MediaTypeArtist)
     { // we retrieve music video art from the music database (no backward compat)
@@ -20,6 +20,7 @@
  */
 
 #include <map>
+#include <set>
 #include "ThumbLoader.h"
 #include "utils/JobManager.h"
 #include "FileItem.h"
@@ -124,10 +125,22 @@ public:
    */
   static void SetArt(CFileItem &item, const std::map<std::string, std::string> &artwork);
 
+  /*! \brief Fetch the library art and stream details of a set of items in batches
+   Saves the queries per item when the items are loaded afterwards. The fetched
+   information is kept until the loader finishes.
+   \param items the items that are about to be loaded.
+   \param streamDetails whether to fetch the stream details as well as the art.
+   */
+  void PrefetchLibraryInfo(const std::vector<CFileItemPtr> &items, bool streamDetails = true);
+
 protected:
   CVideoDatabase *m_videoDatabase;
   typedef std::map<int, std::map<std::string, std::string> > ArtCache;
   ArtCache m_showArt;
+  std::map<std::string, ArtCache> m_libraryArt; ///< prefetched art by media type, empty for items without art
+  std::set<int> m_prefetchedStreamDetails;      ///< files whose stream details have been prefetched
+
+  bool GetLibraryArt(int dbId, const std::string &mediaType, std::map<std::string, std::string> &artwork);
 
   /*! \brief Tries to detect missing data/info from a file and adds those
    \param item The CFileItem to process
@@ -596,16 +596,17 @@ void CGUIWindowFullScreen::FrameMove()
 #else
       CStdString strCores = g_cpuInfo.GetCoresUsageString();
 #endif
-      int    missedvblanks;
-      int    refreshrate;
-      double clockspeed;
+      CVideoReferenceClock::Statistics clockStats;
       CStdString strClock;
 
-      if (g_VideoReferenceClock.GetClockInfo(missedvblanks, clockspeed, refreshrate))
-        strClock = StringUtils::Format("S( refresh:%i missed:%i speed:%+.3f%% %s )"
-                                       , refreshrate
-                                       , missedvblanks
-                                       , clockspeed - 100.0
+      if (g_VideoReferenceClock.GetStatistics(clockStats))
+        strClock = StringUtils::Format("S( refresh:%i%s missed:%i speed:%+.3f%% phase:%.2fms adj:%.1f/min %s )"
+                                       , clockStats.refreshRate
+                                       , clockStats.software ? " (sw)" : ""
+                                       , clockStats.missedVblanks
+                                       , clockStats.speed - 100.0
+                                       , clockStats.phaseError
+                                       , clockStats.adjustRate
                                        , g_renderManager.GetVSyncState().c_str());
 
       strGeneralFPS = StringUtils::Format("%s\nW( fps:%02.2f %s ) %s"
@@ -75,6 +75,7 @@
 #include "utils/EdenVideoArtUpdater.h"
 #include "GUIInfoManager.h"
 #include "utils/GroupUtils.h"
+#include "utils/ScraperCache.h"
 #include "filesystem/File.h"
 
 using namespace std;
@@ -490,6 +491,10 @@ bool CGUIWindowVideoBase::ShowIMDB(CFileItem *item, const ScraperPtr &info2)
   // 3. Run a loop so that if we Refresh we re-run this block
   do
   {
+    // the details the user asked to refresh aren't taken from the scraper cache unchecked
+    if (needsRefresh)
+      CScraperCache::Get().Revalidate();
+
     if (!ignoreNfo)
     {
       CNfoFile::NFOResult nfoResult = scanner.CheckForNFOFile(item,settings.parent_name_root,info,scrUrl);